@@ -0,0 +1,418 @@
+/**
+ * wasm-mini-bench - Google Benchmark suite for the wasm-mini pipelines
+ *
+ * Times each WasmEdge phase the CLI goes through: ParserCreate,
+ * ParseFromFile vs ParseFromBytes, Validate, VMCreate, Instantiate and
+ * Execute. Inputs are generated modules that scale in function count and
+ * code size, plus examples/test.wasm. Run with
+ *
+ *   wasm-mini-bench --benchmark_format=json --benchmark_out=bench.json
+ *
+ * and diff the JSON across commits or WasmEdge versions; the WasmEdge
+ * version is recorded in the JSON context.
+ */
+
+#include <benchmark/benchmark.h>
+#include <wasmedge/wasmedge.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+#ifndef WASM_MINI_EXAMPLES_DIR
+#define WASM_MINI_EXAMPLES_DIR "examples"
+#endif
+
+namespace {
+
+// ============================================================================
+// RAII Wrappers for WasmEdge C Contexts (as in src/main.cpp)
+// ============================================================================
+
+struct ParserDeleter {
+    void operator()(WasmEdge_ParserContext* ctx) const {
+        if (ctx) WasmEdge_ParserDelete(ctx);
+    }
+};
+using ParserPtr = std::unique_ptr<WasmEdge_ParserContext, ParserDeleter>;
+
+struct ValidatorDeleter {
+    void operator()(WasmEdge_ValidatorContext* ctx) const {
+        if (ctx) WasmEdge_ValidatorDelete(ctx);
+    }
+};
+using ValidatorPtr = std::unique_ptr<WasmEdge_ValidatorContext, ValidatorDeleter>;
+
+struct ASTModuleDeleter {
+    void operator()(WasmEdge_ASTModuleContext* ctx) const {
+        if (ctx) WasmEdge_ASTModuleDelete(ctx);
+    }
+};
+using ASTModulePtr = std::unique_ptr<WasmEdge_ASTModuleContext, ASTModuleDeleter>;
+
+struct VMDeleter {
+    void operator()(WasmEdge_VMContext* ctx) const {
+        if (ctx) WasmEdge_VMDelete(ctx);
+    }
+};
+using VMPtr = std::unique_ptr<WasmEdge_VMContext, VMDeleter>;
+
+// ============================================================================
+// Benchmark Modules - Generated and bundled inputs
+// ============================================================================
+
+/**
+ * A benchmark input: module bytes plus the same bytes on disk
+ */
+struct BenchModule {
+    std::string name;
+    std::vector<uint8_t> bytes;
+    std::string path;    // File holding the bytes (for *FromFile)
+    std::string entry;   // Export to call in the execute benchmark
+    std::vector<WasmEdge_Value> params;
+    uint32_t returns = 0;
+    int64_t functions = 0;
+};
+
+/**
+ * Append an unsigned LEB128 value
+ *
+ * @param out   Output buffer
+ * @param value Value to encode
+ */
+void appendVarU32(std::vector<uint8_t>& out, uint32_t value) {
+    do {
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        out.push_back(value ? static_cast<uint8_t>(byte | 0x80) : byte);
+    } while (value);
+}
+
+/**
+ * Append a section with its id and size prefix
+ *
+ * @param out     Module buffer
+ * @param id      Section id
+ * @param payload Section contents
+ */
+void appendSection(std::vector<uint8_t>& out, uint8_t id, const std::vector<uint8_t>& payload) {
+    out.push_back(id);
+    appendVarU32(out, static_cast<uint32_t>(payload.size()));
+    out.insert(out.end(), payload.begin(), payload.end());
+}
+
+/**
+ * Generate a module of `functions` functions of type () -> i32, each
+ * with `bodyOps` (i32.const 1, i32.add) pairs. Function i calls function
+ * i + 1 first, so executing the exported "run" (function 0) runs every body
+ * once and execution cost scales with both dimensions.
+ *
+ * @param functions Function count (at least 1)
+ * @param bodyOps   Add operations per function body
+ * @return Module bytes
+ */
+std::vector<uint8_t> generateModule(uint32_t functions, uint32_t bodyOps) {
+    std::vector<uint8_t> module = {0x00, 0x61, 0x73, 0x6D, 0x01, 0x00, 0x00, 0x00};
+
+    appendSection(module, 1, {0x01, 0x60, 0x00, 0x01, 0x7F});  // type 0: () -> i32
+
+    std::vector<uint8_t> funcs;
+    appendVarU32(funcs, functions);
+    funcs.insert(funcs.end(), functions, 0x00);
+    appendSection(module, 3, funcs);
+
+    appendSection(module, 7, {0x01, 0x03, 'r', 'u', 'n', 0x00, 0x00});  // export "run" = func 0
+
+    std::vector<uint8_t> code;
+    appendVarU32(code, functions);
+    std::vector<uint8_t> body;
+    for (uint32_t i = 0; i < functions; i++) {
+        body.assign(1, 0x00);  // No locals
+        if (i + 1 < functions) {
+            body.push_back(0x10);  // call i + 1
+            appendVarU32(body, i + 1);
+        } else {
+            body.insert(body.end(), {0x41, 0x00});  // i32.const 0
+        }
+        for (uint32_t op = 0; op < bodyOps; op++) {
+            body.insert(body.end(), {0x41, 0x01, 0x6A});  // i32.const 1; i32.add
+        }
+        body.push_back(0x0B);  // end
+        appendVarU32(code, static_cast<uint32_t>(body.size()));
+        code.insert(code.end(), body.begin(), body.end());
+    }
+    appendSection(module, 10, code);
+    return module;
+}
+
+/**
+ * Directory for the generated module files (removed at exit)
+ *
+ * @return Scratch directory path
+ */
+const fs::path& scratchDir() {
+    static const fs::path dir = [] {
+        fs::path path = fs::temp_directory_path()
+                      / ("wasm-mini-bench-" + std::to_string(std::random_device{}()));
+        fs::create_directories(path);
+        return path;
+    }();
+    return dir;
+}
+
+/**
+ * All benchmark inputs: the generated grid (function count x body size)
+ * and examples/test.wasm when it can be read
+ *
+ * @return Benchmark modules
+ */
+const std::vector<BenchModule>& benchModules() {
+    static const std::vector<BenchModule> modules = [] {
+        std::vector<BenchModule> list;
+        for (uint32_t functions : {1u, 64u, 1024u}) {
+            for (uint32_t bodyOps : {16u, 1024u}) {
+                BenchModule module;
+                module.name =
+                    "gen_f" + std::to_string(functions) + "_ops" + std::to_string(bodyOps);
+                module.bytes = generateModule(functions, bodyOps);
+                module.entry = "run";
+                module.returns = 1;
+                module.functions = functions;
+                list.push_back(std::move(module));
+            }
+        }
+
+        std::ifstream example(WASM_MINI_EXAMPLES_DIR "/test.wasm", std::ios::binary);
+        if (example) {
+            BenchModule module;
+            module.name = "example_test";
+            module.bytes.assign(std::istreambuf_iterator<char>(example),
+                                std::istreambuf_iterator<char>());
+            module.entry = "add";
+            module.params = {WasmEdge_ValueGenI32(1), WasmEdge_ValueGenI32(2)};
+            module.returns = 1;
+            module.functions = 3;
+            list.push_back(std::move(module));
+        }
+
+        for (BenchModule& module : list) {
+            module.path = (scratchDir() / (module.name + ".wasm")).string();
+            std::ofstream out(module.path, std::ios::binary | std::ios::trunc);
+            out.write(reinterpret_cast<const char*>(module.bytes.data()),
+                      static_cast<std::streamsize>(module.bytes.size()));
+        }
+        return list;
+    }();
+    return modules;
+}
+
+/**
+ * Non-owning WasmEdge_Bytes view of a module
+ *
+ * @param module Benchmark module
+ * @return Bytes view
+ */
+WasmEdge_Bytes moduleBytes(const BenchModule& module) {
+    return WasmEdge_BytesWrap(module.bytes.data(), static_cast<uint32_t>(module.bytes.size()));
+}
+
+/**
+ * Stop a benchmark with the WasmEdge error message when a call fails
+ *
+ * @param state  Benchmark state
+ * @param result WasmEdge result
+ * @param step   Step name for the message
+ * @return true if the result is a success
+ */
+bool checkResult(benchmark::State& state, WasmEdge_Result result, const char* step) {
+    if (WasmEdge_ResultOK(result)) {
+        return true;
+    }
+    state.SkipWithError((std::string(step) + ": " + WasmEdge_ResultGetMessage(result)).c_str());
+    return false;
+}
+
+/**
+ * Record the module dimensions and byte throughput on a benchmark
+ *
+ * @param state  Benchmark state
+ * @param module Benchmark module
+ */
+void setModuleCounters(benchmark::State& state, const BenchModule& module) {
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations())
+                            * static_cast<int64_t>(module.bytes.size()));
+    state.counters["module_bytes"] = static_cast<double>(module.bytes.size());
+    state.counters["functions"] = static_cast<double>(module.functions);
+}
+
+// ============================================================================
+// Phase Benchmarks
+// ============================================================================
+
+/**
+ * ParserCreate + ParserDelete, the per-process cost batch mode amortizes
+ */
+void benchParserCreate(benchmark::State& state) {
+    for (auto _ : state) {
+        ParserPtr parser(WasmEdge_ParserCreate(nullptr));
+        benchmark::DoNotOptimize(parser.get());
+    }
+}
+
+/**
+ * VMCreate + VMDelete, the per-module cost the VM pool avoids
+ */
+void benchVMCreate(benchmark::State& state) {
+    for (auto _ : state) {
+        VMPtr vm(WasmEdge_VMCreate(nullptr, nullptr));
+        benchmark::DoNotOptimize(vm.get());
+    }
+}
+
+/**
+ * Parse through WasmEdge_ParserParseFromFile (the --no-mmap path)
+ */
+void benchParseFromFile(benchmark::State& state, const BenchModule& module) {
+    ParserPtr parser(WasmEdge_ParserCreate(nullptr));
+    for (auto _ : state) {
+        WasmEdge_ASTModuleContext* raw = nullptr;
+        WasmEdge_Result result =
+            WasmEdge_ParserParseFromFile(parser.get(), &raw, module.path.c_str());
+        ASTModulePtr ast(raw);
+        if (!checkResult(state, result, "parse")) break;
+    }
+    setModuleCounters(state, module);
+}
+
+/**
+ * Parse through WasmEdge_ParserParseFromBytes (the default mmap path)
+ */
+void benchParseFromBytes(benchmark::State& state, const BenchModule& module) {
+    ParserPtr parser(WasmEdge_ParserCreate(nullptr));
+    for (auto _ : state) {
+        WasmEdge_ASTModuleContext* raw = nullptr;
+        WasmEdge_Result result =
+            WasmEdge_ParserParseFromBytes(parser.get(), &raw, moduleBytes(module));
+        ASTModulePtr ast(raw);
+        if (!checkResult(state, result, "parse")) break;
+    }
+    setModuleCounters(state, module);
+}
+
+/**
+ * ValidatorValidate on a freshly parsed AST (parse not timed)
+ */
+void benchValidate(benchmark::State& state, const BenchModule& module) {
+    ParserPtr parser(WasmEdge_ParserCreate(nullptr));
+    ValidatorPtr validator(WasmEdge_ValidatorCreate(nullptr));
+    for (auto _ : state) {
+        // Validation marks the AST, so every iteration validates a fresh parse
+        state.PauseTiming();
+        WasmEdge_ASTModuleContext* raw = nullptr;
+        WasmEdge_Result result =
+            WasmEdge_ParserParseFromBytes(parser.get(), &raw, moduleBytes(module));
+        ASTModulePtr ast(raw);
+        state.ResumeTiming();
+        if (!checkResult(state, result, "parse")) break;
+        if (!checkResult(state, WasmEdge_ValidatorValidate(validator.get(), ast.get()),
+                         "validate")) {
+            break;
+        }
+    }
+    setModuleCounters(state, module);
+}
+
+/**
+ * VM Load -> Validate -> Instantiate from bytes (cleanup not timed)
+ */
+void benchInstantiate(benchmark::State& state, const BenchModule& module) {
+    VMPtr vm(WasmEdge_VMCreate(nullptr, nullptr));
+    for (auto _ : state) {
+        // Load -> Validate -> Instantiate on a reused VM, as batch mode does
+        if (!checkResult(state, WasmEdge_VMLoadWasmFromBytes(vm.get(), moduleBytes(module)),
+                         "load")) {
+            break;
+        }
+        if (!checkResult(state, WasmEdge_VMValidate(vm.get()), "validate")) break;
+        if (!checkResult(state, WasmEdge_VMInstantiate(vm.get()), "instantiate")) break;
+        state.PauseTiming();
+        WasmEdge_VMCleanup(vm.get());
+        state.ResumeTiming();
+    }
+    setModuleCounters(state, module);
+}
+
+/**
+ * VMExecute of the module's entry export on an instantiated VM
+ */
+void benchExecute(benchmark::State& state, const BenchModule& module) {
+    VMPtr vm(WasmEdge_VMCreate(nullptr, nullptr));
+    if (!checkResult(state, WasmEdge_VMLoadWasmFromBytes(vm.get(), moduleBytes(module)), "load")
+        || !checkResult(state, WasmEdge_VMValidate(vm.get()), "validate")
+        || !checkResult(state, WasmEdge_VMInstantiate(vm.get()), "instantiate")) {
+        return;
+    }
+    WasmEdge_String entry =
+        WasmEdge_StringWrap(module.entry.data(), static_cast<uint32_t>(module.entry.size()));
+    std::vector<WasmEdge_Value> returns(module.returns);
+    for (auto _ : state) {
+        WasmEdge_Result result = WasmEdge_VMExecute(vm.get(), entry, module.params.data(),
+                                                    static_cast<uint32_t>(module.params.size()),
+                                                    returns.data(),
+                                                    static_cast<uint32_t>(returns.size()));
+        if (!checkResult(state, result, "execute")) break;
+        benchmark::DoNotOptimize(returns.data());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    state.counters["functions"] = static_cast<double>(module.functions);
+}
+
+/**
+ * Register the per-module benchmarks for every input
+ */
+void registerBenchmarks() {
+    benchmark::RegisterBenchmark("ParserCreate", benchParserCreate);
+    benchmark::RegisterBenchmark("VMCreate", benchVMCreate);
+    using ModuleBench = void (*)(benchmark::State&, const BenchModule&);
+    const std::pair<const char*, ModuleBench> phases[] = {
+        {"ParseFromFile", benchParseFromFile},
+        {"ParseFromBytes", benchParseFromBytes},
+        {"Validate", benchValidate},
+        {"Instantiate", benchInstantiate},
+        {"Execute", benchExecute},
+    };
+    for (const auto& [phase, bench] : phases) {
+        for (const BenchModule& module : benchModules()) {
+            ModuleBench run = bench;
+            benchmark::RegisterBenchmark(
+                (std::string(phase) + "/" + module.name).c_str(),
+                [run, &module](benchmark::State& state) { run(state, module); });
+        }
+    }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::AddCustomContext("wasmedge_version", WasmEdge_VersionGet());
+    registerBenchmarks();
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    std::error_code ec;
+    fs::remove_all(scratchDir(), ec);
+    return 0;
+}
@@ -7,16 +7,95 @@
  * Phase 4: instantiate sub-command implementation using WasmEdge C API
  * Phase 5: Production-quality error handling, exit codes, and resource discipline
  * Phase 6: File validation, RAII wrappers, and verbose mode
+ * Phase 7: Batch mode with contexts reused across many modules
+ * Phase 8: Parallel batch runs on a work-stealing thread pool (--jobs)
+ * Phase 9: Memory-mapped module loading through the *FromBytes APIs
+ * Phase 10: compile sub-command with a content-addressed AOT artifact cache
+ * Phase 11: run sub-command with a repeated-call latency benchmark mode
+ * Phase 12: Per-phase timing and memory instrumentation (--profile)
+ * Phase 13: Structured JSON/NDJSON result output (--format)
+ * Phase 14: serve mode answering requests over a Unix socket with warm contexts
+ * Phase 15: Pre-parse binary scanner rejecting malformed modules before WasmEdge
+ * Phase 16: inspect sub-command with a memory-mappable section/function index
+ * Phase 17: One shared configure context for proposals, memory limits and statistics
+ * Phase 18: run execution statistics with cost tables and a per-call gas limit
+ * Phase 19: Streaming module input from stdin ('-') and pipes/FIFOs
+ * Phase 20: generate sub-command emitting synthetic valid/invalid modules at scale
+ * Phase 21: Pool of instantiate VMs reset and reused across modules
+ * Phase 22: Content-addressed verdict cache skipping unchanged modules (--verdict-cache)
+ * Phase 23: check-all sub-command sharing one parsed AST across validate and instantiate
+ * Phase 24: WASI and host-module registration, prebuilt once per worker (--wasi)
+ * Phase 25: Reader threads prefetching modules ahead of the workers (--prefetch)
+ * Phase 26: Memory-bounded scheduling for mixed-size corpora (--max-memory)
+ * Phase 27: watch sub-command revalidating only changed modules
+ * Phase 28: Multi-module linking into one shared store (--link)
+ * Phase 29: Parallel per-instance run throughput harness (--instances)
+ * Phase 30: Post-instantiation snapshots for fast cold start (--snapshot, --from-snapshot)
+ * Phase 31: Sampling profiler for guest functions in run (--sample-profile)
+ * Phase 32: compare sub-command diffing results across WasmEdge builds
+ * Phase 33: Compact binary result log (--format bin) and report sub-command
+ * Phase 34: Lazy, on-demand function validation for giant modules (--lazy)
  */
 
 #include <iostream>
+#include <cstdint>
+#include <charconv>
+#include <fstream>
+#include <sstream>
 #include <string>
 #include <string_view>
 #include <memory>
+#include <vector>
+#include <array>
+#include <algorithm>
 #include <filesystem>
+#include <functional>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <utility>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <chrono>
+#include <numeric>
+#include <ctime>
+#include <new>
+#include <csignal>
+#include <cerrno>
+#include <optional>
+#include <random>
+#include <cctype>
+#include <iterator>
+#include <tuple>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#endif
 
 #include <wasmedge/wasmedge.h>
 
+// Count heap allocations for --profile through a replacement global operator
+// new (set by the WASM_MINI_COUNT_ALLOCATIONS CMake option)
+#ifndef WASM_MINI_COUNT_ALLOCATIONS
+#define WASM_MINI_COUNT_ALLOCATIONS 1
+#endif
+
 namespace fs = std::filesystem;
 
 // ============================================================================
@@ -30,6 +109,65 @@ constexpr int EXIT_RUNTIME_ERROR = 2; // WasmEdge runtime error (parse, validate
 // Global State
 // ============================================================================
 bool g_verbose = false;  // Verbose mode flag
+size_t g_jobs = 1;       // Batch worker threads (--jobs, 0 = one per hardware thread)
+bool g_jobsSet = false;  // --jobs was given (serve defaults to one worker per hardware thread)
+bool g_useMmap = true;   // Load modules through mmap + *FromBytes (--no-mmap disables)
+bool g_useAotCache = true;                 // Use cached AOT artifacts (--no-aot-cache disables)
+bool g_useVerdictCache = false;            // Reuse cached pass/fail verdicts (--verdict-cache)
+bool g_scan = true;                        // Pre-parse binary scan (--no-scan disables)
+bool g_writeIndex = false;                 // inspect: write <module>.wmidx beside it (--index)
+std::vector<std::pair<uint32_t, uint32_t>> g_lookupFunctions;  // inspect: --lookup ranges
+uint64_t g_maxModuleSize = 0;              // Module byte limit (--max-module-size, 0 = none)
+uint64_t g_maxSectionSize = 0;             // Section byte limit (--max-section-size, 0 = none)
+size_t g_prefetchReaders = 0;              // Batch read-ahead threads (--prefetch, 0 = off)
+uint64_t g_prefetchBudget = 256ull << 20;  // Unprocessed read-ahead bytes (--prefetch-budget)
+uint64_t g_maxMemory = 0;                  // In-flight module memory cap (--max-memory, 0 = none)
+std::string g_cacheDir;                    // Cache root (--cache-dir, empty = default location)
+std::string g_compileOutput;               // Explicit compile output path (--output)
+std::string g_snapshotOut;                 // instantiate: save the instance state (--snapshot)
+std::string g_fromSnapshot;                // Restore instances from this snapshot (--from-snapshot)
+// AOT optimization level (--opt-level)
+WasmEdge_CompilerOptimizationLevel g_optLevel = WasmEdge_CompilerOptimizationLevel_O2;
+uint64_t g_enabledProposals = 0;           // Proposal bits added to the defaults (--enable)
+uint64_t g_disabledProposals = 0;          // Proposal bits removed from the defaults (--disable)
+uint32_t g_maxMemoryPages = 0;             // Pages per memory (--memory-page-limit, 0 = default)
+bool g_countInstructions = false;          // Count instructions (--enable-instruction-count)
+bool g_measureCost = false;                // Sum instruction cost (--enable-gas-measuring)
+bool g_measureTime = false;                // Time execution (--enable-time-measuring)
+std::string g_costTablePath;               // Instruction cost table file (--cost-table)
+std::vector<uint64_t> g_costTable;         // Loaded cost table, indexed by WasmEdge opcode value
+uint64_t g_gasLimit = 0;                   // Per-call cost limit (--gas-limit, 0 = unlimited)
+bool g_wasi = false;                       // Register wasi_snapshot_preview1 (--wasi)
+std::vector<std::string> g_wasiDirs;       // WASI preopens, GUEST:HOST or one shared path (--dir)
+std::vector<std::string> g_wasiEnvs;       // WASI environment, NAME=VALUE (--env)
+std::vector<std::string> g_wasiArgs;       // WASI argv after argv[0], the module path (--wasi-arg)
+std::vector<std::string> g_plugins;        // Plug-in files or directories to load (--plugin)
+std::vector<std::string> g_links;          // Libraries, NAME=PATH in dependency order (--link)
+size_t g_repeat = 0;     // Timed calls per run (--repeat, 0 = single untimed call)
+size_t g_warmup = 0;     // Untimed warm-up calls before timing (--warmup)
+size_t g_instances = 0;  // run: instances for the throughput harness (--instances, 0 = off)
+size_t g_runThreads = 1; // run: most threads driving the instances (--threads, 0 = one per CPU)
+std::string g_sampleProfile;  // run: folded-stack output of the sampler (--sample-profile)
+size_t g_sampleRate = 997;    // run: guest function samples per second (--sample-rate)
+double g_threshold = 5.0;     // compare: slowdown in percent that fails the gate (--threshold)
+size_t g_reportTop = 10;      // report: slowest modules listed (--top)
+bool g_lazy = false;          // validate: bodies last, in parallel chunks (--lazy)
+std::vector<std::pair<uint32_t, uint32_t>> g_lazyFunctions;  // --lazy-functions (empty = all)
+std::string g_lazyFunctionList;  // --lazy-functions text, folded into verdict keys
+size_t g_bodyThreads = 1;        // validate --lazy: body threads (-j on a single module)
+bool g_profile = false;  // Emit per-phase timing/memory records (--profile)
+std::string g_profileOut;  // Profile record destination (--profile-out, empty = stderr)
+
+/**
+ * Result output format selected with --format
+ */
+enum class OutputFormat {
+    Text,    // Human-readable multi-line records (default)
+    Json,    // One JSON document: {"records":[...],"summary":{...}}
+    Ndjson,  // One compact JSON object per line
+    Bin      // Columnar result log (see ResultLogBlock), read by 'report'
+};
+OutputFormat g_format = OutputFormat::Text;  // --format
 
 // ============================================================================
 // RAII Wrappers for WasmEdge C Contexts
@@ -79,6 +217,332 @@ struct VMDeleter {
 };
 using VMPtr = std::unique_ptr<WasmEdge_VMContext, VMDeleter>;
 
+/**
+ * RAII wrapper for WasmEdge_ConfigureContext
+ * Automatically calls WasmEdge_ConfigureDelete on destruction
+ */
+struct ConfigureDeleter {
+    void operator()(WasmEdge_ConfigureContext* ctx) const {
+        if (ctx) WasmEdge_ConfigureDelete(ctx);
+    }
+};
+using ConfigurePtr = std::unique_ptr<WasmEdge_ConfigureContext, ConfigureDeleter>;
+
+/**
+ * RAII wrapper for WasmEdge_CompilerContext
+ * Automatically calls WasmEdge_CompilerDelete on destruction
+ */
+struct CompilerDeleter {
+    void operator()(WasmEdge_CompilerContext* ctx) const {
+        if (ctx) WasmEdge_CompilerDelete(ctx);
+    }
+};
+using CompilerPtr = std::unique_ptr<WasmEdge_CompilerContext, CompilerDeleter>;
+
+/**
+ * RAII wrapper for WasmEdge_StoreContext
+ * Automatically calls WasmEdge_StoreDelete on destruction
+ */
+struct StoreDeleter {
+    void operator()(WasmEdge_StoreContext* ctx) const {
+        if (ctx) WasmEdge_StoreDelete(ctx);
+    }
+};
+using StorePtr = std::unique_ptr<WasmEdge_StoreContext, StoreDeleter>;
+
+/**
+ * RAII wrapper for WasmEdge_ExecutorContext
+ * Automatically calls WasmEdge_ExecutorDelete on destruction
+ */
+struct ExecutorDeleter {
+    void operator()(WasmEdge_ExecutorContext* ctx) const {
+        if (ctx) WasmEdge_ExecutorDelete(ctx);
+    }
+};
+using ExecutorPtr = std::unique_ptr<WasmEdge_ExecutorContext, ExecutorDeleter>;
+
+/**
+ * RAII wrapper for WasmEdge_ModuleInstanceContext
+ * Automatically calls WasmEdge_ModuleInstanceDelete on destruction
+ */
+struct ModuleInstanceDeleter {
+    void operator()(WasmEdge_ModuleInstanceContext* ctx) const {
+        if (ctx) WasmEdge_ModuleInstanceDelete(ctx);
+    }
+};
+using ModuleInstancePtr = std::unique_ptr<WasmEdge_ModuleInstanceContext, ModuleInstanceDeleter>;
+
+// ============================================================================
+// Configuration - One WasmEdge_ConfigureContext shared by every context
+// ============================================================================
+
+/**
+ * Proposal names accepted by --enable/--disable
+ */
+struct ProposalName {
+    std::string_view name;
+    WasmEdge_Proposal proposal;
+};
+constexpr ProposalName PROPOSALS[] = {
+    {"import-export-mut-globals", WasmEdge_Proposal_ImportExportMutGlobals},
+    {"non-trap-float-to-int", WasmEdge_Proposal_NonTrapFloatToIntConversions},
+    {"sign-extension", WasmEdge_Proposal_SignExtensionOperators},
+    {"multi-value", WasmEdge_Proposal_MultiValue},
+    {"bulk-memory", WasmEdge_Proposal_BulkMemoryOperations},
+    {"reference-types", WasmEdge_Proposal_ReferenceTypes},
+    {"simd", WasmEdge_Proposal_SIMD},
+    {"tail-call", WasmEdge_Proposal_TailCall},
+    {"extended-const", WasmEdge_Proposal_ExtendedConst},
+    {"function-references", WasmEdge_Proposal_FunctionReferences},
+    {"gc", WasmEdge_Proposal_GC},
+    {"multi-memory", WasmEdge_Proposal_MultiMemories},
+    {"threads", WasmEdge_Proposal_Threads},
+    {"relaxed-simd", WasmEdge_Proposal_RelaxSIMD},
+    {"memory64", WasmEdge_Proposal_Memory64},
+    {"exception-handling", WasmEdge_Proposal_ExceptionHandling},
+};
+
+/**
+ * Parse a comma-separated proposal list ("simd,threads" or "all")
+ *
+ * @param text List text
+ * @param mask Receives one bit per named proposal (bit = WasmEdge_Proposal value)
+ * @return false if the list is empty or names an unknown proposal
+ */
+bool parseProposalList(std::string_view text, uint64_t& mask) {
+    mask = 0;
+    while (!text.empty()) {
+        size_t comma = text.find(',');
+        std::string_view name = text.substr(0, comma);
+        text = comma == std::string_view::npos ? std::string_view() : text.substr(comma + 1);
+        bool known = false;
+        for (const ProposalName& entry : PROPOSALS) {
+            if (name == "all" || name == entry.name) {
+                mask |= uint64_t{1} << entry.proposal;
+                known = true;
+            }
+        }
+        if (!known) {
+            return false;
+        }
+    }
+    return mask != 0;
+}
+
+/**
+ * Get the configure context built from the command-line options.
+ * Created on first use (after option parsing) and shared read-only by
+ * every parser, validator, VM and compiler context, so all commands and
+ * workers see one configuration: proposals (--enable/--disable), memory
+ * page limit, AOT optimization level, statistics options and WASI host
+ * registration (--wasi).
+ *
+ * @return Configure context, or nullptr if creation failed
+ */
+const WasmEdge_ConfigureContext* toolConfig() {
+    static const ConfigurePtr config = [] {
+        ConfigurePtr configCtx(WasmEdge_ConfigureCreate());
+        if (!configCtx) {
+            return configCtx;
+        }
+        for (const ProposalName& entry : PROPOSALS) {
+            uint64_t bit = uint64_t{1} << entry.proposal;
+            if (g_enabledProposals & bit) {
+                WasmEdge_ConfigureAddProposal(configCtx.get(), entry.proposal);
+            } else if (g_disabledProposals & bit) {
+                WasmEdge_ConfigureRemoveProposal(configCtx.get(), entry.proposal);
+            }
+        }
+        if (g_maxMemoryPages > 0) {
+            WasmEdge_ConfigureSetMaxMemoryPage(configCtx.get(), g_maxMemoryPages);
+        }
+        WasmEdge_ConfigureCompilerSetOptimizationLevel(configCtx.get(), g_optLevel);
+        WasmEdge_ConfigureCompilerSetOutputFormat(configCtx.get(),
+                                                  WasmEdge_CompilerOutputFormat_Native);
+        WasmEdge_ConfigureStatisticsSetInstructionCounting(configCtx.get(), g_countInstructions);
+        WasmEdge_ConfigureStatisticsSetCostMeasuring(configCtx.get(), g_measureCost);
+        WasmEdge_ConfigureStatisticsSetTimeMeasuring(configCtx.get(), g_measureTime);
+        // No WASI host registration: --wasi modules import the session's own
+        // WASI module (Session::wasiModule), which WasmEdge_VMCleanup keeps
+        return configCtx;
+    }();
+    return config.get();
+}
+
+/**
+ * Describe the configuration that can change how a module parses,
+ * validates, instantiates or compiles: the enabled proposal set and the
+ * memory page limit. Built once: the configuration is fixed after
+ * argument parsing, and every cache lookup folds it into its key.
+ *
+ * @return Fingerprint text folded into cache keys
+ */
+const std::string& proposalFingerprint() {
+    static const std::string fingerprint = [] {
+        std::string text = "proposals=";
+        const WasmEdge_ConfigureContext* config = toolConfig();
+        for (const ProposalName& entry : PROPOSALS) {
+            if (config && WasmEdge_ConfigureHasProposal(config, entry.proposal)) {
+                text += entry.name;
+                text += ",";
+            }
+        }
+        text += "|pages=";
+        text += std::to_string(config ? WasmEdge_ConfigureGetMaxMemoryPage(config) : 0);
+        return text;
+    }();
+    return fingerprint;
+}
+
+/**
+ * Load the plug-ins named by --plugin. Must run before the first VM is
+ * created: a VM registers the host modules of the plug-ins loaded so far
+ * when it is constructed.
+ */
+void loadPlugins() {
+    for (const std::string& path : g_plugins) {
+        WasmEdge_PluginLoadFromPath(path.c_str());
+    }
+}
+
+/**
+ * Reset a WASI host module for the next --wasi instantiation: its
+ * arguments, environment and preopened directories are re-initialized, so
+ * every instantiation starts with a fresh file descriptor table and exit
+ * code without building a new module
+ *
+ * @param wasi     WASI module instance (see Session::wasiModule)
+ * @param filename Module path, passed to the guest as argv[0]
+ */
+void initWasi(WasmEdge_ModuleInstanceContext* wasi, const std::string& filename) {
+    auto cStrings = [](const std::vector<std::string>& list) {
+        std::vector<const char*> pointers;
+        pointers.reserve(list.size());
+        for (const std::string& item : list) {
+            pointers.push_back(item.c_str());
+        }
+        return pointers;
+    };
+    static const std::vector<const char*> envs = cStrings(g_wasiEnvs);
+    static const std::vector<const char*> dirs = cStrings(g_wasiDirs);
+    thread_local std::vector<const char*> args = [] {
+        std::vector<const char*> pointers(1, nullptr);
+        for (const std::string& arg : g_wasiArgs) {
+            pointers.push_back(arg.c_str());
+        }
+        return pointers;
+    }();
+    args[0] = filename.c_str();
+    WasmEdge_ModuleInstanceInitWASI(wasi, args.data(), static_cast<uint32_t>(args.size()),
+                                    envs.data(), static_cast<uint32_t>(envs.size()),
+                                    dirs.data(), static_cast<uint32_t>(dirs.size()));
+}
+
+/**
+ * Exit code a WASI guest passed to proc_exit
+ *
+ * @param wasi WASI module instance, or nullptr when --wasi is off
+ * @return Exit code (0 if the guest returned normally or --wasi is off)
+ */
+uint32_t wasiExitCode(const WasmEdge_ModuleInstanceContext* wasi) {
+    return wasi ? WasmEdge_ModuleInstanceWASIGetExitCode(wasi) : 0;
+}
+
+/**
+ * Create a VM context with the tool's configuration
+ *
+ * @return VM context, or an empty pointer if creation failed
+ */
+VMPtr createVM() {
+    return VMPtr(WasmEdge_VMCreate(toolConfig(), nullptr));
+}
+
+/**
+ * Pool of reusable VM contexts, sized by --jobs.
+ * A returned VM is reset with WasmEdge_VMCleanup, which drops the loaded and
+ * instantiated module, its store state and every module registered into it,
+ * then rebuilds the VM's built-in and plug-in host modules. The next module
+ * skips VM construction only; the --link libraries and the WASI module are
+ * owned by the session and registered again by loadAndInstantiate.
+ * Shared by all workers of a run; only take() and release() lock.
+ */
+class VMPool {
+public:
+    /**
+     * A VM borrowed for one module. When the lease is destroyed, the VM goes
+     * back to its pool. A lease without a pool deletes its VM.
+     */
+    class Lease {
+    public:
+        Lease() = default;
+        Lease(VMPool* pool, VMPtr vm) : pool_(pool), vm_(std::move(vm)) {}
+        ~Lease() { reset(); }
+
+        Lease(Lease&& other) noexcept
+            : pool_(std::exchange(other.pool_, nullptr)), vm_(std::move(other.vm_)) {}
+        Lease& operator=(Lease&& other) noexcept {
+            if (this != &other) {
+                reset();
+                pool_ = std::exchange(other.pool_, nullptr);
+                vm_ = std::move(other.vm_);
+            }
+            return *this;
+        }
+
+        WasmEdge_VMContext* get() const { return vm_.get(); }
+        explicit operator bool() const { return static_cast<bool>(vm_); }
+
+        /**
+         * Return the VM now (to its pool, or delete it)
+         */
+        void reset() {
+            if (pool_ && vm_) {
+                pool_->release(std::move(vm_));
+            }
+            vm_.reset();
+        }
+
+    private:
+        VMPool* pool_ = nullptr;
+        VMPtr vm_;
+    };
+
+    explicit VMPool(size_t capacity) : capacity_(capacity) { idle_.reserve(capacity); }
+
+    /**
+     * Take an idle VM
+     *
+     * @return A cleaned-up VM, or an empty pointer if none is idle
+     */
+    VMPtr take() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (idle_.empty()) {
+            return VMPtr();
+        }
+        VMPtr vm = std::move(idle_.back());
+        idle_.pop_back();
+        return vm;
+    }
+
+    /**
+     * Clean up a VM and keep it for reuse (deleted if the pool is full)
+     *
+     * @param vm VM to return
+     */
+    void release(VMPtr vm) {
+        WasmEdge_VMCleanup(vm.get());  // Outside the lock: cleanup frees the module's store
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (idle_.size() < capacity_) {
+            idle_.push_back(std::move(vm));
+        }
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<VMPtr> idle_;
+    size_t capacity_;
+};
+
 // ============================================================================
 // Program Metadata
 // ============================================================================
@@ -93,7 +557,13 @@ constexpr std::string_view VERSION = "0.1.0";
  * Print program usage information
  */
 void printUsage() {
-    std::cout << "Usage: " << PROGRAM_NAME << " [options] <command> <file.wasm>\n"
+    std::cout << "Usage: " << PROGRAM_NAME << " [options] <command> <input>...\n"
+              << "       " << PROGRAM_NAME << " [options] run <file.wasm> <export> [args...]\n"
+              << "       " << PROGRAM_NAME << " [options] serve <socket>\n"
+              << "       " << PROGRAM_NAME << " [options] generate <out.wasm|->\n"
+              << "       " << PROGRAM_NAME << " [options] watch [<command>] <input>...\n"
+              << "       " << PROGRAM_NAME << " [options] compare <baseline> <candidate>\n"
+              << "       " << PROGRAM_NAME << " [options] report <log.wmrl>...\n"
               << "\n"
               << "A mini CLI tool mirroring WasmEdge CLI sub-commands.\n"
               << "\n"
@@ -101,16 +571,103 @@ void printUsage() {
               << "  parse        Parse a WebAssembly module\n"
               << "  validate     Validate a WebAssembly module\n"
               << "  instantiate  Instantiate a WebAssembly module\n"
+              << "  compile      AOT-compile a module into the artifact cache\n"
+              << "  check-all    Parse, validate and instantiate with a single parse\n"
+              << "  inspect      Report sections, functions, imports and exports\n"
+              << "  run          Call an exported function\n"
+              << "  serve        Answer requests on a Unix socket with warm contexts\n"
+              << "  generate     Write a synthetic module for scaling tests\n"
+              << "  watch        Re-run a command (default validate) on modules as they change\n"
+              << "  compare      Gate on phase time regressions between two --profile/bench\n"
+              << "               results\n"
+              << "  report       Summarize --format bin result logs\n"
+              << "\n"
+              << "Inputs:\n"
+              << "  <file.wasm>  A single module\n"
+              << "  <dir>        Every .wasm file under the directory (batch mode)\n"
+              << "  @<list.txt>  Paths listed one per line in a file (batch mode)\n"
+              << "  Passing more than one input also enables batch mode.\n"
               << "\n"
               << "Options:\n"
               << "  -h, --help     Show this help message\n"
               << "  -v, --version  Show version information\n"
               << "  --verbose      Enable verbose output\n"
+              << "  -j, --jobs N   Batch/serve worker threads (0 = one per CPU; default 1,\n"
+              << "                 serve: one per CPU)\n"
+              << "  --no-mmap      Load modules with the WasmEdge *FromFile APIs\n"
+              << "  --opt-level L  AOT optimization level: O0, O1, O2, O3, Os, Oz (default O2)\n"
+              << "  --enable P     Enable proposals: comma-separated (e.g. simd,threads) or all\n"
+              << "  --disable P    Disable proposals enabled by default (e.g. simd,bulk-memory)\n"
+              << "  --memory-page-limit N  Cap each memory at N 64 KiB pages\n"
+              << "  --enable-instruction-count  Statistics: count executed instructions\n"
+              << "  --enable-gas-measuring      Statistics: accumulate instruction cost\n"
+              << "  --enable-time-measuring     Statistics: measure execution time\n"
+              << "  --enable-all-statistics     All three statistics options\n"
+              << "  --cost-table P Instruction cost table for gas measuring\n"
+              << "                 (\"<opcode> <cost>\" lines)\n"
+              << "  --gas-limit N  Stop any call whose cost exceeds N (enables gas measuring)\n"
+              << "  --wasi         Register the wasi_snapshot_preview1 host module\n"
+              << "  --dir D        WASI: preopen directory, GUEST:HOST or one path\n"
+              << "                 (implies --wasi)\n"
+              << "  --env N=V      WASI: environment variable (implies --wasi)\n"
+              << "  --wasi-arg A   WASI: argument after argv[0], the module path (implies --wasi)\n"
+              << "  --plugin P     Load WasmEdge plug-ins from a file or directory\n"
+              << "  --link N=P     Register library module P under name N for imports\n"
+              << "                 (repeatable, dependency order)\n"
+              << "  --functions N, --body-ops N, --locals N, --imports N, --exports N\n"
+              << "                 generate: module shape (defaults 16, 64, 0, 0, 1)\n"
+              << "  --data-segments N, --data-size B  generate: N data segments of B bytes\n"
+              << "  --invalid K    generate: magic, truncated, section-order, type-mismatch,\n"
+              << "                 bad-local\n"
+              << "  -o, --output P Write the compiled artifact to P instead of the cache\n"
+              << "  --snapshot P   instantiate: save exported memories, globals and table sizes\n"
+              << "                 to P\n"
+              << "  --from-snapshot P  instantiate/run: restore state from P instead of running\n"
+              << "                 data segments and the start function\n"
+              << "  --cache-dir D  Cache root (default $WASM_MINI_CACHE_DIR or\n"
+              << "                 ~/.cache/wasm-mini)\n"
+              << "  --no-aot-cache Ignore cached AOT artifacts when instantiating\n"
+              << "  --verdict-cache Reuse cached parse/validate/instantiate verdicts\n"
+              << "  --no-scan      Skip the pre-parse binary scanner\n"
+              << "  --index        inspect: write a <module>.wmidx index next to each module\n"
+              << "  --lookup L     inspect: report the type and body of these functions,\n"
+              << "                 e.g. 0,7,100-199\n"
+              << "  --lazy         validate: check all but function bodies first, then the bodies\n"
+              << "                 in parallel chunks (-j threads on a single module)\n"
+              << "  --lazy-functions L  validate: check only these bodies, e.g. 0,7,100-199\n"
+              << "                 (implies --lazy)\n"
+              << "  --max-module-size N  Scanner: reject modules larger than N bytes (K/M/G)\n"
+              << "  --max-section-size N Scanner: reject sections larger than N bytes (K/M/G)\n"
+              << "  --prefetch N   Batch: N reader threads load modules ahead of the workers\n"
+              << "  --prefetch-budget B  Batch: bytes read ahead and not yet processed\n"
+              << "                 (default 256M)\n"
+              << "  --max-memory B Batch: cap estimated in-flight module memory; largest modules\n"
+              << "                 first\n"
+              << "  --repeat N     run: time N calls and report latency percentiles\n"
+              << "  --warmup M     run: make M untimed calls before timing\n"
+              << "  --instances K  run: K instances from one parse, calls driven from 1..T\n"
+              << "                 threads\n"
+              << "  --threads T    run: most threads for --instances (0 = one per CPU, default 1)\n"
+              << "  --sample-profile P  run: sample the running guest function, folded stacks\n"
+              << "                 to P\n"
+              << "  --sample-rate HZ     run: samples per second for --sample-profile\n"
+              << "                 (default 997)\n"
+              << "  --threshold PCT      compare: slowdown that fails the gate (default 5%)\n"
+              << "  --top N        report: slowest modules listed (default 10)\n"
+              << "  --profile      Emit per-phase wall/CPU/RSS/allocation records (NDJSON)\n"
+              << "  --profile-out P Write --profile records to P instead of stderr\n"
+              << "  --format F     Result format: text, json, ndjson, bin (default text)\n"
               << "\n"
               << "Examples:\n"
               << "  " << PROGRAM_NAME << " parse example.wasm\n"
               << "  " << PROGRAM_NAME << " validate example.wasm\n"
-              << "  " << PROGRAM_NAME << " --verbose instantiate example.wasm\n";
+              << "  " << PROGRAM_NAME << " --verbose instantiate example.wasm\n"
+              << "  " << PROGRAM_NAME << " validate modules/ @more-modules.txt\n"
+              << "  " << PROGRAM_NAME << " --format ndjson -j 8 validate modules/\n"
+              << "  " << PROGRAM_NAME << " --opt-level O3 compile example.wasm\n"
+              << "  " << PROGRAM_NAME << " --index inspect example.wasm\n"
+              << "  " << PROGRAM_NAME << " run --repeat 100000 --warmup 1000 example.wasm add 1 2\n"
+              << "  " << PROGRAM_NAME << " --dir .:. --env HOME=/ run app.wasm _start\n";
 }
 
 /**
@@ -182,14 +739,85 @@ void printSuccess(std::string_view command, std::string_view filename,
 }
 
 /**
- * Print verbose information (only when --verbose is enabled)
+ * Lines of verbose output captured on this thread instead of written
+ * (see VerboseCapture); null writes them straight out
+ */
+thread_local std::string* t_verboseCapture = nullptr;
+
+/**
+ * Write finished verbose lines in one locked write, so lines from
+ * different threads never interleave mid-line
+ * 
+ * @param lines One or more complete lines
+ */
+void writeVerbose(std::string_view lines) {
+    static std::mutex verboseMutex;
+    // Keep stdout parseable when results are emitted as JSON
+    std::ostream& out = g_format == OutputFormat::Text ? std::cout : std::cerr;
+    std::lock_guard<std::mutex> lock(verboseMutex);
+    out.write(lines.data(), static_cast<std::streamsize>(lines.size()));
+}
+
+/**
+ * Capture this thread's verbose lines into a buffer for as long as the
+ * scope lives. Batch workers capture into the module's result slot so the
+ * printer emits them in input order next to the module's record.
+ */
+class VerboseCapture {
+public:
+    explicit VerboseCapture(std::string& buffer) : previous_(t_verboseCapture) {
+        t_verboseCapture = &buffer;
+    }
+    ~VerboseCapture() { t_verboseCapture = previous_; }
+
+    VerboseCapture(const VerboseCapture&) = delete;
+    VerboseCapture& operator=(const VerboseCapture&) = delete;
+
+private:
+    std::string* previous_;
+};
+
+/**
+ * Print verbose information (only when --verbose is enabled).
+ * The message is given as parts streamed one after another, so callers
+ * never build a temporary string that is thrown away without --verbose.
+ * The line is finished before it is written (see writeVerbose), or kept
+ * for the printer when the thread captures its output (see VerboseCapture).
  * 
- * @param message Information to display
+ * @param parts Pieces of the message (anything printable with <<)
  */
-void printVerbose(std::string_view message) {
+template <typename... Parts>
+void printVerbose(const Parts&... parts) {
     if (g_verbose) {
-        std::cout << "[VERBOSE] " << message << "\n";
+        std::ostringstream line;
+        line << "[VERBOSE] ";
+        (line << ... << parts) << "\n";
+        if (t_verboseCapture) {
+            t_verboseCapture->append(line.str());
+        } else {
+            writeVerbose(line.str());
+        }
+    }
+}
+
+/**
+ * Format a duration in ns with a readable unit
+ *
+ * @param ns Nanoseconds
+ * @return Text such as "812.4 us"
+ */
+std::string formatDurationNs(double ns) {
+    char text[32];
+    if (ns >= 1e9) {
+        std::snprintf(text, sizeof(text), "%.2f s", ns / 1e9);
+    } else if (ns >= 1e6) {
+        std::snprintf(text, sizeof(text), "%.1f ms", ns / 1e6);
+    } else if (ns >= 1e3) {
+        std::snprintf(text, sizeof(text), "%.1f us", ns / 1e3);
+    } else {
+        std::snprintf(text, sizeof(text), "%.0f ns", ns);
     }
+    return text;
 }
 
 /**
@@ -199,8 +827,50 @@ void printVerbose(std::string_view message) {
  * @return true if file exists, false otherwise
  */
 bool fileExists(const std::string& filepath) {
+#if defined(__unix__) || defined(__APPLE__)
+    // One stat(2) call; fs::exists/is_regular_file build a path object each
+    struct stat info {};
+    return ::stat(filepath.c_str(), &info) == 0 && S_ISREG(info.st_mode);
+#else
+    std::error_code ec;
+    return fs::is_regular_file(filepath, ec);
+#endif
+}
+
+/**
+ * Temporary path for a file that is written in full and then renamed into
+ * place (see publishTemporary). The thread id and process id keep
+ * concurrent writers of the same file, in this process or another, from
+ * truncating each other's temporary.
+ * 
+ * @param path Final path
+ * @return Temporary path next to it
+ */
+std::string temporaryPathFor(const std::string& path) {
+    std::ostringstream suffix;
+    suffix << ".tmp." << std::this_thread::get_id();
+#if defined(__unix__) || defined(__APPLE__)
+    suffix << "." << ::getpid();
+#endif
+    return path + suffix.str();
+}
+
+/**
+ * Rename a finished temporary file over its final path, removing the
+ * temporary if the rename fails
+ * 
+ * @param tmpPath Temporary path (from temporaryPathFor)
+ * @param path    Final path
+ * @return true on success
+ */
+bool publishTemporary(const std::string& tmpPath, const std::string& path) {
     std::error_code ec;
-    return fs::exists(filepath, ec) && fs::is_regular_file(filepath, ec);
+    fs::rename(tmpPath, path, ec);
+    if (ec) {
+        fs::remove(tmpPath, ec);
+        return false;
+    }
+    return true;
 }
 
 /**
@@ -209,19 +879,45 @@ bool fileExists(const std::string& filepath) {
  * @param filepath Path to check
  * @return true if file ends with .wasm, false otherwise
  */
-bool hasWasmExtension(const std::string& filepath) {
-    return filepath.size() >= 5 && 
-           filepath.substr(filepath.size() - 5) == ".wasm";
+bool hasWasmExtension(std::string_view filepath) {
+    constexpr std::string_view EXTENSION = ".wasm";
+    return filepath.size() >= EXTENSION.size()
+        && filepath.substr(filepath.size() - EXTENSION.size()) == EXTENSION;
+}
+
+/**
+ * Check if an input is read as a stream rather than mapped: '-' (stdin),
+ * or a FIFO, character device or socket path
+ * 
+ * @param filepath Path to check
+ * @return true if the module must be read to EOF
+ */
+bool isStreamInput(const std::string& filepath) {
+    if (filepath == "-") {
+        return true;
+    }
+#if defined(__unix__) || defined(__APPLE__)
+    struct stat info {};
+    return ::stat(filepath.c_str(), &info) == 0
+           && (S_ISFIFO(info.st_mode) || S_ISCHR(info.st_mode) || S_ISSOCK(info.st_mode));
+#else
+    return false;
+#endif
 }
 
 /**
  * Validate file before processing
- * Checks existence and warns about extension.
+ * Checks existence and warns about extension. Stream inputs are accepted
+ * as they are.
  * 
  * @param filepath Path to validate
  * @return true if file is valid for processing, false otherwise
  */
 bool validateFile(const std::string& filepath) {
+    if (isStreamInput(filepath)) {
+        return true;
+    }
+
     // Check file existence
     if (!fileExists(filepath)) {
         std::cerr << "Error: File not found: " << filepath << "\n";
@@ -236,161 +932,10436 @@ bool validateFile(const std::string& filepath) {
     return true;
 }
 
-// ============================================================================
-// Sub-command Implementations
-// ============================================================================
-
 /**
- * Parse sub-command implementation using WasmEdge C API
+ * Parse a non-negative decimal integer option value
  * 
- * Demonstrates: Parser context lifecycle, AST module creation
- * Uses RAII wrappers for automatic resource cleanup.
+ * @param text  Option value text
+ * @param value Receives the parsed value
+ * @return true if text is a complete non-negative integer, false otherwise
+ */
+bool parseCount(std::string_view text, size_t& value) {
+    const char* end = text.data() + text.size();
+    auto [ptr, ec] = std::from_chars(text.data(), end, value);
+    return ec == std::errc() && ptr == end;
+}
+
+/**
+ * Parse a byte size option value with an optional K, M or G suffix
+ * (powers of 1024)
  * 
- * @param filename Path to the .wasm file to parse
- * @return Exit code (EXIT_OK or EXIT_RUNTIME_ERROR)
+ * @param text  Option value text, e.g. "512", "64K", "16M"
+ * @param value Receives the size in bytes
+ * @return true if text is a valid size that fits in 64 bits
  */
-int cmdParse(const std::string& filename) {
-    printVerbose(std::string("WasmEdge version: ") + WasmEdge_VersionGet());
-    printVerbose(std::string("Processing file: ") + filename);
-    
-    // Step 1: Create the parser context (RAII managed)
-    printVerbose("Creating parser context...");
-    ParserPtr parserCtx(WasmEdge_ParserCreate(nullptr));
-    if (!parserCtx) {
-        printContextError("PARSE", filename, "parser context");
-        return EXIT_RUNTIME_ERROR;
+bool parseByteSize(std::string_view text, uint64_t& value) {
+    int shift = 0;
+    if (!text.empty()) {
+        switch (text.back()) {
+            case 'K': case 'k': shift = 10; break;
+            case 'M': case 'm': shift = 20; break;
+            case 'G': case 'g': shift = 30; break;
+            default: break;
+        }
+        if (shift > 0) text.remove_suffix(1);
     }
+    const char* end = text.data() + text.size();
+    auto [ptr, ec] = std::from_chars(text.data(), end, value);
+    if (ec != std::errc() || ptr != end || text.empty() || value > (UINT64_MAX >> shift)) {
+        return false;
+    }
+    value <<= shift;
+    return true;
+}
 
-    // Step 2: Parse the WebAssembly file
-    printVerbose("Parsing WebAssembly module...");
-    WasmEdge_ASTModuleContext* rawAstModule = nullptr;
-    WasmEdge_Result result = WasmEdge_ParserParseFromFile(parserCtx.get(), &rawAstModule, filename.c_str());
-    ASTModulePtr astModuleCtx(rawAstModule);  // Take ownership immediately
-
-    if (!WasmEdge_ResultOK(result)) {
-        printWasmEdgeError("PARSE", filename, "FAILED", result);
-        return EXIT_RUNTIME_ERROR;
+/**
+ * Parse a percentage option value, with or without a trailing '%'
+ *
+ * @param text    Option value text, e.g. "5", "2.5%"
+ * @param percent Receives the percentage
+ * @return true if text is a finite non-negative number
+ */
+bool parsePercent(std::string_view text, double& percent) {
+    if (!text.empty() && text.back() == '%') text.remove_suffix(1);
+    std::string number(text);
+    char* end = nullptr;
+    double value = std::strtod(number.c_str(), &end);
+    if (number.empty() || end != number.c_str() + number.size() || !std::isfinite(value)
+        || value < 0.0) {
+        return false;
     }
+    percent = value;
+    return true;
+}
 
-    // Success
-    printVerbose("Parse completed successfully.");
-    printSuccess("PARSE", filename, "SUCCESS");
-    return EXIT_OK;
-    // RAII: parserCtx and astModuleCtx automatically cleaned up
+/**
+ * Parse a function index list option value: indices and inclusive ranges
+ * separated by commas
+ *
+ * @param text   Option value text, e.g. "0,7,100-199"
+ * @param ranges Receives the inclusive index ranges
+ * @return true if every item is an index or an ascending range
+ */
+bool parseFunctionList(std::string_view text, std::vector<std::pair<uint32_t, uint32_t>>& ranges) {
+    ranges.clear();
+    while (!text.empty()) {
+        size_t comma = text.find(',');
+        std::string_view item = text.substr(0, comma);
+        text = comma == std::string_view::npos ? std::string_view() : text.substr(comma + 1);
+        size_t dash = item.find('-');
+        size_t low = 0;
+        size_t high = 0;
+        if (!parseCount(item.substr(0, dash), low)
+            || !parseCount(dash == std::string_view::npos ? item : item.substr(dash + 1), high)
+            || low > high || high > UINT32_MAX) {
+            return false;
+        }
+        ranges.emplace_back(static_cast<uint32_t>(low), static_cast<uint32_t>(high));
+    }
+    return !ranges.empty();
 }
 
+// ============================================================================
+// Module Loading - Memory-mapped module bytes
+// ============================================================================
+
 /**
- * Validate sub-command implementation using WasmEdge C API
- * 
- * Pipeline: Parse -> Validate
- * Demonstrates: Multi-context lifecycle, semantic validation
- * Uses RAII wrappers for automatic resource cleanup.
+ * Read-only view of a module file mapped into memory.
  * 
- * @param filename Path to the .wasm file to validate
- * @return Exit code (EXIT_OK or EXIT_RUNTIME_ERROR)
+ * On POSIX systems the file is mmapped (pre-faulted with MAP_POPULATE where
+ * available and advised for sequential access) so the parser reads the page
+ * cache directly instead of going through an intermediate buffered copy.
+ * Elsewhere it falls back to reading the file into an owned buffer.
+ * The mapping is released on destruction or by release().
  */
-int cmdValidate(const std::string& filename) {
-    printVerbose(std::string("WasmEdge version: ") + WasmEdge_VersionGet());
-    printVerbose(std::string("Processing file: ") + filename);
-    
-    // Step 1: Create the parser context (RAII managed)
-    printVerbose("Creating parser context...");
-    ParserPtr parserCtx(WasmEdge_ParserCreate(nullptr));
-    if (!parserCtx) {
-        printContextError("VALIDATE", filename, "parser context");
-        return EXIT_RUNTIME_ERROR;
+class MappedModule {
+public:
+    MappedModule() = default;
+    ~MappedModule() { release(); }
+
+    MappedModule(const MappedModule&) = delete;
+    MappedModule& operator=(const MappedModule&) = delete;
+
+    MappedModule(MappedModule&& other) noexcept { *this = std::move(other); }
+    MappedModule& operator=(MappedModule&& other) noexcept {
+        if (this != &other) {
+            release();
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+            mapped_ = std::exchange(other.mapped_, false);
+            buffer_ = std::move(other.buffer_);
+        }
+        return *this;
     }
 
-    // Step 2: Parse the WebAssembly file
-    printVerbose("Parsing WebAssembly module...");
-    WasmEdge_ASTModuleContext* rawAstModule = nullptr;
-    WasmEdge_Result result = WasmEdge_ParserParseFromFile(parserCtx.get(), &rawAstModule, filename.c_str());
-    ASTModulePtr astModuleCtx(rawAstModule);  // Take ownership immediately
+    /**
+     * Map a module file
+     * 
+     * @param path Path to the .wasm file
+     * @return true on success, false if the file could not be read or is
+     *         larger than the 4 GiB WasmEdge_Bytes limit
+     */
+    bool open(const std::string& path) {
+        release();
+#if defined(__unix__) || defined(__APPLE__)
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat info {};
+        if (::fstat(fd, &info) != 0 || static_cast<uint64_t>(info.st_size) > UINT32_MAX) {
+            ::close(fd);
+            return false;
+        }
+        size_ = static_cast<size_t>(info.st_size);
+        if (size_ == 0) {
+            // mmap rejects empty ranges; an empty view lets the parser report the error
+            ::close(fd);
+            return true;
+        }
+        int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+        flags |= MAP_POPULATE;
+#endif
+        void* addr = ::mmap(nullptr, size_, PROT_READ, flags, fd, 0);
+        ::close(fd);  // The mapping keeps its own reference to the file
+        if (addr == MAP_FAILED) {
+            size_ = 0;
+            return false;
+        }
+        // Advice values are not flags, so each hint needs its own call
+        ::madvise(addr, size_, MADV_SEQUENTIAL);
+        ::madvise(addr, size_, MADV_WILLNEED);
+        data_ = static_cast<const uint8_t*>(addr);
+        mapped_ = true;
+        return true;
+#else
+        return read(path);
+#endif
+    }
 
-    if (!WasmEdge_ResultOK(result)) {
-        printWasmEdgeError("VALIDATE", filename, "FAILED (Parse Error)", result);
-        return EXIT_RUNTIME_ERROR;
+    /**
+     * Read a module file into an owned buffer instead of mapping it
+     * (--no-mmap, and systems without mmap)
+     *
+     * @param path Path to the .wasm file
+     * @return true on success, false if the file could not be read or is
+     *         larger than the 4 GiB WasmEdge_Bytes limit
+     */
+    bool read(const std::string& path) {
+        release();
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file) {
+            return false;
+        }
+        std::streamoff length = file.tellg();
+        if (length < 0 || static_cast<uint64_t>(length) > UINT32_MAX) {
+            return false;
+        }
+        buffer_.resize(static_cast<size_t>(length));
+        file.seekg(0);
+        if (!file.read(reinterpret_cast<char*>(buffer_.data()), length)) {
+            buffer_.clear();
+            return false;
+        }
+        data_ = buffer_.data();
+        size_ = buffer_.size();
+        return true;
     }
 
-    // Step 3: Create the validator context (RAII managed)
-    printVerbose("Creating validator context...");
-    ValidatorPtr validatorCtx(WasmEdge_ValidatorCreate(nullptr));
-    if (!validatorCtx) {
-        printContextError("VALIDATE", filename, "validator context");
-        return EXIT_RUNTIME_ERROR;
+    /**
+     * View bytes already held in memory (for example a module received over
+     * a socket). The bytes are not copied and must outlive the view.
+     *
+     * @param bytes Module bytes
+     * @return true on success, false if larger than the 4 GiB WasmEdge_Bytes limit
+     */
+    bool borrow(std::string_view bytes) {
+        release();
+        if (bytes.size() > UINT32_MAX) {
+            return false;
+        }
+        data_ = reinterpret_cast<const uint8_t*>(bytes.data());
+        size_ = bytes.size();
+        return true;
     }
 
-    // Step 4: Validate the AST module
-    printVerbose("Validating WebAssembly module...");
-    result = WasmEdge_ValidatorValidate(validatorCtx.get(), astModuleCtx.get());
+    /**
+     * Unmap the module (safe to call more than once)
+     */
+    void release() {
+#if defined(__unix__) || defined(__APPLE__)
+        if (mapped_) {
+            ::munmap(const_cast<uint8_t*>(data_), size_);
+        }
+#endif
+        buffer_.clear();
+        buffer_.shrink_to_fit();
+        data_ = nullptr;
+        size_ = 0;
+        mapped_ = false;
+    }
 
-    if (!WasmEdge_ResultOK(result)) {
-        printWasmEdgeError("VALIDATE", filename, "INVALID", result);
-        return EXIT_RUNTIME_ERROR;
+    const uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+
+    /**
+     * Borrow the mapped bytes for the WasmEdge *FromBytes APIs
+     *
+     * @return Non-owning WasmEdge_Bytes view (valid until release())
+     */
+    WasmEdge_Bytes bytes() const {
+        return WasmEdge_BytesWrap(data_, static_cast<uint32_t>(size_));
     }
 
-    // Success
-    printVerbose("Validation completed successfully.");
-    printSuccess("VALIDATE", filename, "VALID");
-    return EXIT_OK;
-    // RAII: All contexts automatically cleaned up
-}
+private:
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    bool mapped_ = false;
+    std::vector<uint8_t> buffer_;  // Fallback storage when mmap is unavailable
+};
 
 /**
- * Instantiate sub-command implementation using WasmEdge C API
- * 
- * Pipeline: VM Create -> Load -> Validate -> Instantiate
- * Demonstrates: VM lifecycle, streamlined module loading
- * Uses RAII wrappers for automatic resource cleanup.
- * Does not execute any functions - only creates a ready VM instance.
- * 
- * @param filename Path to the .wasm file to instantiate
- * @return Exit code (EXIT_OK or EXIT_RUNTIME_ERROR)
+ * Growable buffer for modules read from stdin, a pipe or a FIFO, whose size
+ * is unknown until EOF. read(2) fills the spare capacity directly (no
+ * staging copy, no temp file) and the capacity doubles when full. reset()
+ * keeps the allocation, so a session reading many streams allocates only
+ * when a module is larger than any before it.
  */
-int cmdInstantiate(const std::string& filename) {
-    printVerbose(std::string("WasmEdge version: ") + WasmEdge_VersionGet());
-    printVerbose(std::string("Processing file: ") + filename);
-    
-    // Step 1: Create the VM context (RAII managed)
-    printVerbose("Creating VM context...");
-    VMPtr vmCtx(WasmEdge_VMCreate(nullptr, nullptr));
-    if (!vmCtx) {
-        printContextError("INSTANTIATE", filename, "VM context");
-        return EXIT_RUNTIME_ERROR;
-    }
-
-    // Step 2: Load the WebAssembly module from file
-    printVerbose("Loading WebAssembly module...");
-    WasmEdge_Result result = WasmEdge_VMLoadWasmFromFile(vmCtx.get(), filename.c_str());
+class StreamArena {
+public:
+    StreamArena() = default;
+    StreamArena(const StreamArena&) = delete;
+    StreamArena& operator=(const StreamArena&) = delete;
 
-    if (!WasmEdge_ResultOK(result)) {
-        printWasmEdgeError("INSTANTIATE", filename, "FAILED (Load Error)", result);
-        return EXIT_RUNTIME_ERROR;
+    /**
+     * Read a stream to EOF, replacing the previous contents
+     *
+     * @param path  '-' for stdin, else a FIFO or device path
+     * @param error Receives a static description when reading fails
+     * @return true on success, false on a read error or when the stream is
+     *         larger than --max-module-size or the 4 GiB WasmEdge_Bytes limit
+     */
+    bool fill(const std::string& path, std::string_view& error) {
+        size_ = 0;
+        uint64_t limit = g_maxModuleSize > 0 ? std::min<uint64_t>(g_maxModuleSize, UINT32_MAX)
+                                             : UINT32_MAX;
+        std::string_view tooLarge = g_maxModuleSize > 0 ? "Module exceeds --max-module-size"
+                                                        : "Module exceeds 4 GiB";
+#if defined(__unix__) || defined(__APPLE__)
+        bool useStdin = path == "-";
+        int fd = useStdin ? STDIN_FILENO : ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            error = "Cannot read file";
+            return false;
+        }
+        bool ok = true;
+        for (;;) {
+            if (size_ == capacity_ && !grow()) {
+                error = "Out of memory reading stream";
+                ok = false;
+                break;
+            }
+            ssize_t count = ::read(fd, data_.get() + size_, capacity_ - size_);
+            if (count < 0 && errno == EINTR) {
+                continue;
+            }
+            if (count < 0) {
+                error = "Cannot read stream";
+                ok = false;
+                break;
+            }
+            if (count == 0) {
+                break;
+            }
+            size_ += static_cast<size_t>(count);
+            if (size_ > limit) {
+                error = tooLarge;
+                ok = false;
+                break;
+            }
+        }
+        if (!useStdin) {
+            ::close(fd);
+        }
+        return ok;
+#else
+        std::ifstream file;
+        if (path != "-") {
+            file.open(path, std::ios::binary);
+        }
+        std::istream& in = path == "-" ? std::cin : file;
+        if (!in) {
+            error = "Cannot read file";
+            return false;
+        }
+        while (in) {
+            if (size_ == capacity_ && !grow()) {
+                error = "Out of memory reading stream";
+                return false;
+            }
+            in.read(reinterpret_cast<char*>(data_.get() + size_),
+                    static_cast<std::streamsize>(capacity_ - size_));
+            size_ += static_cast<size_t>(in.gcount());
+            if (size_ > limit) {
+                error = tooLarge;
+                return false;
+            }
+        }
+        return true;
+#endif
     }
 
-    // Step 3: Validate the loaded module
-    printVerbose("Validating loaded module...");
-    result = WasmEdge_VMValidate(vmCtx.get());
+    /**
+     * View the bytes read by the last fill()
+     *
+     * @return Non-owning view, valid until the next fill()
+     */
+    std::string_view view() const {
+        return std::string_view(reinterpret_cast<const char*>(data_.get()), size_);
+    }
 
-    if (!WasmEdge_ResultOK(result)) {
-        printWasmEdgeError("INSTANTIATE", filename, "FAILED (Validation Error)", result);
-        return EXIT_RUNTIME_ERROR;
+private:
+    /**
+     * Double the capacity (64 KiB minimum), keeping the bytes read so far
+     *
+     * @return false if the allocation failed
+     */
+    bool grow() {
+        size_t capacity = std::max<size_t>(capacity_ * 2, 64 * 1024);
+        std::unique_ptr<uint8_t[]> data(new (std::nothrow) uint8_t[capacity]);
+        if (!data) {
+            return false;
+        }
+        if (size_ > 0) {
+            std::memcpy(data.get(), data_.get(), size_);
+        }
+        data_ = std::move(data);
+        capacity_ = capacity;
+        return true;
     }
 
-    // Step 4: Instantiate the module
-    printVerbose("Instantiating module...");
-    result = WasmEdge_VMInstantiate(vmCtx.get());
+    std::unique_ptr<uint8_t[]> data_;
+    size_t size_ = 0;
+    size_t capacity_ = 0;
+};
 
-    if (!WasmEdge_ResultOK(result)) {
-        printWasmEdgeError("INSTANTIATE", filename, "FAILED (Instantiation Error)", result);
-        return EXIT_RUNTIME_ERROR;
-    }
+// ============================================================================
+// Binary Scanner - Pre-parse structural checks without a parser context
+// ============================================================================
+
+/**
+ * Outcome of scanning a module binary
+ */
+struct ScanResult {
+    bool ok = true;
+    uint64_t offset = 0;       // Byte offset of the first problem
+    std::string_view reason;   // Static description of the problem
+};
+
+/**
+ * Location of one section found by the scanner
+ */
+struct SectionSpan {
+    uint8_t id = 0;
+    uint64_t headerOffset = 0;  // Offset of the section id byte
+    uint64_t offset = 0;        // Offset of the section payload
+    uint64_t size = 0;          // Payload size in bytes
+};
+
+/**
+ * Number of zero bits below the lowest set bit
+ * 
+ * @param value Non-zero value
+ * @return Trailing zero count (0-63)
+ */
+inline unsigned countTrailingZeros(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned>(__builtin_ctzll(value));
+#else
+    unsigned count = 0;
+    while ((value & 1) == 0) {
+        value >>= 1;
+        count++;
+    }
+    return count;
+#endif
+}
+
+/**
+ * Index of the highest set bit, floor(log2(value))
+ * 
+ * @param value Non-zero value
+ * @return Bit index (0-63)
+ */
+inline unsigned floorLog2(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - static_cast<unsigned>(__builtin_clzll(value));
+#else
+    unsigned log = 0;
+    while (value >>= 1) {
+        log++;
+    }
+    return log;
+#endif
+}
+
+/**
+ * Decode an unsigned LEB128 u32.
+ * When eight bytes are readable the terminating byte is found with one
+ * SWAR test over a 64-bit word and the 7-bit groups are gathered with
+ * shifts and masks, instead of a data-dependent loop per byte.
+ * 
+ * @param p      First byte of the encoding
+ * @param end    End of the readable bytes
+ * @param value  Receives the decoded value
+ * @param length Receives the encoded length in bytes
+ * @return false if the encoding is truncated, longer than 5 bytes or
+ *         exceeds 32 bits
+ */
+bool readVarU32(const uint8_t* p, const uint8_t* end, uint32_t& value, size_t& length) {
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__BYTE_ORDER__) \
+    && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    if (end - p >= 8) {
+        uint64_t word;
+        std::memcpy(&word, p, sizeof(word));
+        uint64_t stops = ~word & 0x8080808080808080ULL;  // High bit clear = last byte
+        if (stops == 0) {
+            return false;
+        }
+        length = static_cast<size_t>(countTrailingZeros(stops) >> 3) + 1;
+        if (length > 5) {
+            return false;
+        }
+        uint64_t payload = word & 0x7F7F7F7F7FULL & ((1ULL << (8 * length)) - 1);
+        uint64_t decoded = (payload & 0x7FULL)
+                         | ((payload >> 1) & (0x7FULL << 7))
+                         | ((payload >> 2) & (0x7FULL << 14))
+                         | ((payload >> 3) & (0x7FULL << 21))
+                         | ((payload >> 4) & (0x7FULL << 28));
+        if (decoded > UINT32_MAX) {
+            return false;
+        }
+        value = static_cast<uint32_t>(decoded);
+        return true;
+    }
+#endif
+    uint64_t decoded = 0;
+    for (length = 0; length < 5; length++) {
+        if (p + length >= end) {
+            return false;
+        }
+        uint8_t byte = p[length];
+        decoded |= static_cast<uint64_t>(byte & 0x7F) << (7 * length);
+        if ((byte & 0x80) == 0) {
+            length++;
+            if (decoded > UINT32_MAX) {
+                return false;
+            }
+            value = static_cast<uint32_t>(decoded);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Append an unsigned LEB128 value
+ *
+ * @param out   Output bytes
+ * @param value Value to encode
+ */
+void appendVarU32(std::string& out, uint64_t value) {
+    do {
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        out.push_back(static_cast<char>(value ? (byte | 0x80) : byte));
+    } while (value);
+}
+
+/**
+ * Append a signed LEB128 value (i32.const immediates)
+ *
+ * @param out   Output bytes
+ * @param value Value to encode
+ */
+void appendVarS32(std::string& out, int64_t value) {
+    for (;;) {
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        bool done = (value == 0 && !(byte & 0x40)) || (value == -1 && (byte & 0x40));
+        out.push_back(static_cast<char>(done ? byte : (byte | 0x80)));
+        if (done) return;
+    }
+}
+
+/**
+ * Append a section header (id and payload size)
+ *
+ * @param out  Output bytes
+ * @param id   Section id
+ * @param size Payload size
+ */
+void appendSectionHeader(std::string& out, uint8_t id, uint64_t size) {
+    out.push_back(static_cast<char>(id));
+    appendVarU32(out, size);
+}
+
+/**
+ * Bounds-checked cursor over module bytes. Reads past the end or malformed
+ * LEB128 values clear ok() and return zeros, so decoders check once.
+ */
+class WasmReader {
+public:
+    WasmReader(const uint8_t* p, const uint8_t* end) : p_(p), end_(end) {}
+
+    bool ok() const { return ok_; }
+    bool atEnd() const { return p_ >= end_; }
+    const uint8_t* position() const { return p_; }
+
+    uint8_t byte() {
+        if (p_ >= end_) {
+            ok_ = false;
+            return 0;
+        }
+        return *p_++;
+    }
+    uint32_t u32() {
+        uint32_t value = 0;
+        size_t length = 0;
+        if (!ok_ || !readVarU32(p_, end_, value, length)) {
+            ok_ = false;
+            return 0;
+        }
+        p_ += length;
+        return value;
+    }
+    void skip(uint64_t count) {
+        if (count > static_cast<uint64_t>(end_ - p_)) {
+            ok_ = false;
+            p_ = end_;
+            return;
+        }
+        p_ += count;
+    }
+    /** Skip any LEB128 value up to 64 bits (signed or unsigned) */
+    void skipLeb() {
+        for (int i = 0; i < 10 && ok_; i++) {
+            if ((byte() & 0x80) == 0) return;
+        }
+        ok_ = false;
+    }
+    std::string_view name() {
+        uint32_t length = u32();
+        const uint8_t* start = p_;
+        skip(length);
+        return ok_ ? std::string_view(reinterpret_cast<const char*>(start), length)
+                   : std::string_view();
+    }
+    /** Value type, including typed references (0x63/0x64 + heap type) */
+    void skipValType() {
+        uint8_t type = byte();
+        if (type == 0x63 || type == 0x64) skipLeb();
+    }
+    /** Block type: 0x40, a value type or an s33 type index */
+    void skipBlockType() {
+        if (p_ < end_ && (*p_ == 0x63 || *p_ == 0x64)) {
+            skipValType();
+        } else {
+            skipLeb();
+        }
+    }
+    /** Table and memory limits (shared, memory64 and custom page size flags) */
+    void skipLimits() {
+        uint8_t flags = byte();
+        skipLeb();
+        if (flags & 0x01) skipLeb();
+        if (flags & 0x08) skipLeb();
+    }
+    /** Memory access immediates (multi-memory index when bit 6 of the alignment is set) */
+    void skipMemArg() {
+        if (u32() & 0x40) u32();
+        skipLeb();
+    }
+
+private:
+    const uint8_t* p_;
+    const uint8_t* end_;
+    bool ok_ = true;
+};
+
+/**
+ * Position of a known section id in the required section order
+ * (custom sections, id 0, may appear anywhere)
+ * 
+ * @param id Section id
+ * @return Order rank (1-based), 0 for custom sections, -1 for unknown ids
+ */
+int sectionRank(uint8_t id) {
+    // type import func table memory tag global export start elem datacount code data
+    static constexpr int RANKS[] = {0, 1, 2, 3, 4, 5, 7, 8, 9, 10, 12, 13, 11, 6};
+    return id < std::size(RANKS) ? RANKS[id] : -1;
+}
+
+/**
+ * Scan a module binary before handing it to WasmEdge.
+ * Checks the magic number and version, then walks every section header:
+ * known ids in the required order, LEB128 sizes that fit in the module,
+ * custom section names that fit in their section, and the configured
+ * --max-module-size / --max-section-size limits. Section contents are not
+ * decoded; anything subtler is left to the parser.
+ * 
+ * @param data     Module bytes
+ * @param size     Number of bytes
+ * @param sections Receives the section layout when not null
+ * @return Scan result (offset and reason of the first problem)
+ */
+ScanResult scanModule(const uint8_t* data, size_t size,
+                      std::vector<SectionSpan>* sections = nullptr) {
+    auto fail = [](uint64_t offset, std::string_view reason) {
+        return ScanResult{false, offset, reason};
+    };
+    static constexpr uint8_t MAGIC[] = {0x00, 0x61, 0x73, 0x6D};
+    static constexpr uint8_t VERSION[] = {0x01, 0x00, 0x00, 0x00};
+
+    if (g_maxModuleSize > 0 && size > g_maxModuleSize) {
+        return fail(0, "Module exceeds --max-module-size");
+    }
+    if (size < sizeof(MAGIC) || std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0) {
+        return fail(0, size < sizeof(MAGIC) ? "Truncated magic number" : "Invalid magic number");
+    }
+    if (size < sizeof(MAGIC) + sizeof(VERSION)) {
+        return fail(sizeof(MAGIC), "Truncated version");
+    }
+    if (std::memcmp(data + sizeof(MAGIC), VERSION, sizeof(VERSION)) != 0) {
+        return fail(sizeof(MAGIC), "Unsupported binary version");
+    }
+
+    const uint8_t* end = data + size;
+    const uint8_t* p = data + sizeof(MAGIC) + sizeof(VERSION);
+    int lastRank = 0;
+    while (p < end) {
+        uint64_t headerOffset = static_cast<uint64_t>(p - data);
+        uint8_t id = *p++;
+        int rank = sectionRank(id);
+        if (rank < 0) {
+            return fail(headerOffset, "Unknown section id");
+        }
+        if (rank > 0) {
+            if (rank <= lastRank) {
+                return fail(headerOffset, "Section out of order or duplicated");
+            }
+            lastRank = rank;
+        }
+
+        uint32_t sectionSize = 0;
+        size_t sizeLength = 0;
+        if (!readVarU32(p, end, sectionSize, sizeLength)) {
+            return fail(static_cast<uint64_t>(p - data), "Malformed section size");
+        }
+        p += sizeLength;
+        if (g_maxSectionSize > 0 && sectionSize > g_maxSectionSize) {
+            return fail(headerOffset, "Section exceeds --max-section-size");
+        }
+        if (sectionSize > static_cast<uint64_t>(end - p)) {
+            return fail(headerOffset, "Section extends past end of module");
+        }
+
+        if (id == 0) {
+            uint32_t nameLength = 0;
+            size_t nameLengthSize = 0;
+            if (!readVarU32(p, p + sectionSize, nameLength, nameLengthSize)
+                || nameLength > sectionSize - nameLengthSize) {
+                return fail(static_cast<uint64_t>(p - data), "Malformed custom section name");
+            }
+        }
+        if (sections) {
+            sections->push_back(
+                SectionSpan{id, headerOffset, static_cast<uint64_t>(p - data), sectionSize});
+        }
+        p += sectionSize;
+    }
+    return ScanResult{};
+}
+
+// ============================================================================
+// Content Hashing - 128-bit module digests for cache keys
+// ============================================================================
+
+/**
+ * Streaming 128-bit content hasher.
+ * Runs two XXH64 states (different seeds) over the same 32-byte stripes in a
+ * single pass, giving a 128-bit digest that is cheap enough to compute on
+ * every load. Not a cryptographic hash: it keys caches, it does not
+ * authenticate them.
+ */
+class ContentHasher {
+public:
+    ContentHasher() {
+        resetLanes(lanesA_, SEED_A);
+        resetLanes(lanesB_, SEED_B);
+    }
+
+    /**
+     * Feed more bytes into the digest
+     *
+     * @param data   Bytes to hash
+     * @param length Number of bytes
+     */
+    void update(const void* data, size_t length) {
+        const uint8_t* input = static_cast<const uint8_t*>(data);
+        totalLength_ += length;
+
+        if (bufferedLength_ > 0) {
+            size_t take = std::min(length, STRIPE - bufferedLength_);
+            std::memcpy(buffer_ + bufferedLength_, input, take);
+            bufferedLength_ += take;
+            input += take;
+            length -= take;
+            if (bufferedLength_ < STRIPE) {
+                return;
+            }
+            consumeStripe(buffer_);
+            bufferedLength_ = 0;
+        }
+
+        while (length >= STRIPE) {
+            consumeStripe(input);
+            input += STRIPE;
+            length -= STRIPE;
+        }
+
+        std::memcpy(buffer_, input, length);
+        bufferedLength_ = length;
+    }
+
+    /**
+     * Finish the digest and append it to a string
+     *
+     * @param out Receives the 32-character lowercase hex digest
+     */
+    void appendHexDigest(std::string& out) const {
+        uint64_t high = 0;
+        uint64_t low = 0;
+        digest(high, low);
+        char text[33];
+        std::snprintf(text, sizeof(text), "%016llx%016llx",
+                      static_cast<unsigned long long>(high),
+                      static_cast<unsigned long long>(low));
+        out.append(text, 32);
+    }
+
+    /**
+     * Finish the digest as two 64-bit halves
+     *
+     * @param high Receives the first half (lane A)
+     * @param low  Receives the second half (lane B)
+     */
+    void digest(uint64_t& high, uint64_t& low) const {
+        high = finish(lanesA_, SEED_A);
+        low = finish(lanesB_, SEED_B);
+    }
+
+private:
+    static constexpr uint64_t PRIME1 = 0x9E3779B185EBCA87ULL;
+    static constexpr uint64_t PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+    static constexpr uint64_t PRIME3 = 0x165667B19E3779F9ULL;
+    static constexpr uint64_t PRIME4 = 0x85EBCA77C2B2AE63ULL;
+    static constexpr uint64_t PRIME5 = 0x27D4EB2F165667C5ULL;
+    static constexpr uint64_t SEED_A = 0;
+    static constexpr uint64_t SEED_B = 0x5741534D4D494E49ULL;  // "WASMMINI"
+    static constexpr size_t STRIPE = 32;
+
+    static uint64_t rotl(uint64_t value, int bits) {
+        return (value << bits) | (value >> (64 - bits));
+    }
+    static uint64_t read64(const uint8_t* p) {
+        uint64_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+    static uint32_t read32(const uint8_t* p) {
+        uint32_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+    static uint64_t round(uint64_t acc, uint64_t input) {
+        acc += input * PRIME2;
+        acc = rotl(acc, 31);
+        return acc * PRIME1;
+    }
+    static uint64_t mergeRound(uint64_t acc, uint64_t lane) {
+        acc ^= round(0, lane);
+        return acc * PRIME1 + PRIME4;
+    }
+    static void resetLanes(uint64_t (&lanes)[4], uint64_t seed) {
+        lanes[0] = seed + PRIME1 + PRIME2;
+        lanes[1] = seed + PRIME2;
+        lanes[2] = seed;
+        lanes[3] = seed - PRIME1;
+    }
+
+    void consumeStripe(const uint8_t* stripe) {
+        for (int i = 0; i < 4; i++) {
+            uint64_t word = read64(stripe + 8 * i);
+            lanesA_[i] = round(lanesA_[i], word);
+            lanesB_[i] = round(lanesB_[i], word);
+        }
+    }
+
+    uint64_t finish(const uint64_t (&lanes)[4], uint64_t seed) const {
+        uint64_t hash;
+        if (totalLength_ >= STRIPE) {
+            hash = rotl(lanes[0], 1) + rotl(lanes[1], 7) + rotl(lanes[2], 12) + rotl(lanes[3], 18);
+            for (uint64_t lane : lanes) {
+                hash = mergeRound(hash, lane);
+            }
+        } else {
+            hash = seed + PRIME5;
+        }
+        hash += totalLength_;
+
+        const uint8_t* p = buffer_;
+        size_t remaining = bufferedLength_;
+        for (; remaining >= 8; p += 8, remaining -= 8) {
+            hash ^= round(0, read64(p));
+            hash = rotl(hash, 27) * PRIME1 + PRIME4;
+        }
+        if (remaining >= 4) {
+            hash ^= static_cast<uint64_t>(read32(p)) * PRIME1;
+            hash = rotl(hash, 23) * PRIME2 + PRIME3;
+            p += 4;
+            remaining -= 4;
+        }
+        for (; remaining > 0; p++, remaining--) {
+            hash ^= (*p) * PRIME5;
+            hash = rotl(hash, 11) * PRIME1;
+        }
+
+        hash ^= hash >> 33;
+        hash *= PRIME2;
+        hash ^= hash >> 29;
+        hash *= PRIME3;
+        hash ^= hash >> 32;
+        return hash;
+    }
+
+    uint64_t lanesA_[4];
+    uint64_t lanesB_[4];
+    uint8_t buffer_[STRIPE];
+    size_t bufferedLength_ = 0;
+    uint64_t totalLength_ = 0;
+};
+
+// ============================================================================
+// AOT Compilation - Content-addressed artifact cache
+// ============================================================================
+
+#if defined(_WIN32)
+constexpr std::string_view AOT_EXTENSION = ".dll";
+#elif defined(__APPLE__)
+constexpr std::string_view AOT_EXTENSION = ".dylib";
+#else
+constexpr std::string_view AOT_EXTENSION = ".so";
+#endif
+
+/**
+ * Name of an AOT optimization level as accepted by --opt-level
+ *
+ * @param level Optimization level
+ * @return Level name (O0, O1, O2, O3, Os, Oz)
+ */
+std::string_view optLevelName(WasmEdge_CompilerOptimizationLevel level) {
+    switch (level) {
+        case WasmEdge_CompilerOptimizationLevel_O0: return "O0";
+        case WasmEdge_CompilerOptimizationLevel_O1: return "O1";
+        case WasmEdge_CompilerOptimizationLevel_O2: return "O2";
+        case WasmEdge_CompilerOptimizationLevel_O3: return "O3";
+        case WasmEdge_CompilerOptimizationLevel_Os: return "Os";
+        case WasmEdge_CompilerOptimizationLevel_Oz: return "Oz";
+    }
+    return "O2";
+}
+
+/**
+ * Parse an --opt-level value
+ *
+ * @param text  Level name (O0, O1, O2, O3, Os, Oz)
+ * @param level Receives the optimization level
+ * @return true if text names a known level, false otherwise
+ */
+bool parseOptLevel(std::string_view text, WasmEdge_CompilerOptimizationLevel& level) {
+    constexpr WasmEdge_CompilerOptimizationLevel LEVELS[] = {
+        WasmEdge_CompilerOptimizationLevel_O0, WasmEdge_CompilerOptimizationLevel_O1,
+        WasmEdge_CompilerOptimizationLevel_O2, WasmEdge_CompilerOptimizationLevel_O3,
+        WasmEdge_CompilerOptimizationLevel_Os, WasmEdge_CompilerOptimizationLevel_Oz,
+    };
+    for (WasmEdge_CompilerOptimizationLevel candidate : LEVELS) {
+        if (text == optLevelName(candidate)) {
+            level = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Resolve the cache root directory.
+ * Order: --cache-dir, $WASM_MINI_CACHE_DIR, $XDG_CACHE_HOME/wasm-mini,
+ * $HOME/.cache/wasm-mini, then ./.wasm-mini-cache as a last resort.
+ *
+ * @return Cache root path (not necessarily existing yet)
+ */
+fs::path cacheRoot() {
+    if (!g_cacheDir.empty()) {
+        return g_cacheDir;
+    }
+    if (const char* dir = std::getenv("WASM_MINI_CACHE_DIR"); dir && *dir) {
+        return dir;
+    }
+    if (const char* xdg = std::getenv("XDG_CACHE_HOME"); xdg && *xdg) {
+        return fs::path(xdg) / "wasm-mini";
+    }
+    if (const char* home = std::getenv("HOME"); home && *home) {
+        return fs::path(home) / ".cache" / "wasm-mini";
+    }
+    return ".wasm-mini-cache";
+}
+
+/**
+ * Describe the statistics settings the AOT compiler builds into an
+ * artifact: instruction counting, cost measuring, time measuring, and a
+ * digest of the --cost-table in effect. Built once, after the cost table
+ * has been loaded.
+ *
+ * @return Fingerprint text folded into AOT cache keys
+ */
+const std::string& statisticsFingerprint() {
+    static const std::string fingerprint = [] {
+        std::string text = "count=";
+        text += g_countInstructions ? "1" : "0";
+        text += "|cost=";
+        text += g_measureCost ? "1" : "0";
+        text += "|time=";
+        text += g_measureTime ? "1" : "0";
+        text += "|cost-table=";
+        if (!g_costTable.empty()) {
+            ContentHasher hasher;
+            hasher.update(g_costTable.data(), g_costTable.size() * sizeof(g_costTable[0]));
+            hasher.appendHexDigest(text);
+        }
+        return text;
+    }();
+    return fingerprint;
+}
+
+/**
+ * Append the cache path of the AOT artifact for a module to a string.
+ * The key covers the module bytes, the WasmEdge version, the optimization
+ * level, the proposal set and the statistics settings, so upgrading
+ * WasmEdge or changing --opt-level, --enable/--disable or the statistics
+ * options never reuses a stale artifact.
+ *
+ * @param out        Receives the artifact path under <cache>/aot/
+ * @param moduleHash Hasher already fed the module bytes (copied, not changed)
+ * @param optLevel   Optimization level the artifact is compiled at
+ */
+void appendAotArtifactPath(std::string& out, const ContentHasher& moduleHash,
+                           WasmEdge_CompilerOptimizationLevel optLevel) {
+    static const std::string AOT_DIR = (cacheRoot() / "aot" / "").string();
+    ContentHasher hasher = moduleHash;
+    std::string_view version = WasmEdge_VersionGet();
+    std::string_view level = optLevelName(optLevel);
+    hasher.update(version.data(), version.size());
+    hasher.update("\0", 1);
+    hasher.update(level.data(), level.size());
+    const std::string& proposals = proposalFingerprint();
+    hasher.update("\0", 1);
+    hasher.update(proposals.data(), proposals.size());
+    const std::string& statistics = statisticsFingerprint();
+    hasher.update("\0", 1);
+    hasher.update(statistics.data(), statistics.size());
+
+    out += AOT_DIR;
+    hasher.appendHexDigest(out);
+    out += AOT_EXTENSION;
+}
+
+/**
+ * Compute the cache path of the AOT artifact for a module
+ *
+ * @param module Mapped module bytes
+ * @return Artifact path (see appendAotArtifactPath)
+ */
+fs::path aotArtifactPath(const MappedModule& module) {
+    ContentHasher hasher;
+    hasher.update(module.data(), module.size());
+    std::string path;
+    appendAotArtifactPath(path, hasher, g_optLevel);
+    return path;
+}
+
+/**
+ * Find a cached AOT artifact for a module: the one compiled at --opt-level,
+ * else one compiled at any other level (loading does not depend on the
+ * level, so `compile --opt-level O3` is picked up by a plain `instantiate`)
+ *
+ * @param module Mapped module bytes
+ * @return Artifact path, or empty if the cache is disabled or has no entry
+ */
+std::string findAotArtifact(const MappedModule& module) {
+    if (!g_useAotCache) {
+        return {};
+    }
+    static constexpr WasmEdge_CompilerOptimizationLevel LEVELS[] = {
+        WasmEdge_CompilerOptimizationLevel_O3, WasmEdge_CompilerOptimizationLevel_O2,
+        WasmEdge_CompilerOptimizationLevel_O1, WasmEdge_CompilerOptimizationLevel_Os,
+        WasmEdge_CompilerOptimizationLevel_Oz, WasmEdge_CompilerOptimizationLevel_O0,
+    };
+    ContentHasher hasher;  // The module is hashed once for every level probed
+    hasher.update(module.data(), module.size());
+    // Probed for every module instantiated, so the candidate path is built
+    // in a per-thread buffer and only copied out on a hit
+    thread_local std::string candidate;
+    candidate.clear();
+    appendAotArtifactPath(candidate, hasher, g_optLevel);
+    if (fileExists(candidate)) {
+        return candidate;
+    }
+    for (WasmEdge_CompilerOptimizationLevel level : LEVELS) {
+        if (level == g_optLevel) continue;
+        candidate.clear();
+        appendAotArtifactPath(candidate, hasher, level);
+        if (fileExists(candidate)) {
+            printVerbose("Using the AOT artifact compiled at ", optLevelName(level), " (no ",
+                         optLevelName(g_optLevel), " artifact cached)");
+            return candidate;
+        }
+    }
+    printVerbose("No cached AOT artifact at any optimization level; interpreting.");
+    return {};
+}
+
+// ============================================================================
+// Profiling - Per-phase wall/CPU/RSS/allocation instrumentation (--profile)
+// ============================================================================
+
+// Per-thread count of C++ heap allocations, read by --profile. Counted by the
+// replacement global operator new/delete below. The replacement applies to
+// the whole process, not only to --profile runs: the executable's definition
+// interposes on the shared library's, so WasmEdge's own allocations go
+// through it too. Without --profile it allocates with malloc and counts
+// nothing. Configure with -DWASM_MINI_COUNT_ALLOCATIONS=OFF to keep the
+// standard library's operator new; --profile then reports 0 allocations.
+thread_local uint64_t t_allocCount = 0;
+
+#if WASM_MINI_COUNT_ALLOCATIONS
+
+/**
+ * Counted allocation behind every replacement operator new (counted only
+ * with --profile; otherwise it is plain malloc)
+ *
+ * @param size Requested size
+ * @return Allocated block (throws std::bad_alloc when out of memory)
+ */
+void* countedAlloc(std::size_t size) {
+    if (g_profile) {
+        t_allocCount++;
+    }
+    for (;;) {
+        if (void* ptr = std::malloc(size ? size : 1)) {
+            return ptr;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+/**
+ * Counted allocation for the nothrow forms of operator new
+ *
+ * @param size Requested size
+ * @return Allocated block, or nullptr when out of memory
+ */
+void* countedAllocNoThrow(std::size_t size) noexcept {
+    try {
+        return countedAlloc(size);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void* operator new(std::size_t size) { return countedAlloc(size); }
+void* operator new[](std::size_t size) { return countedAlloc(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return countedAllocNoThrow(size);
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return countedAllocNoThrow(size);
+}
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+
+#endif  // WASM_MINI_COUNT_ALLOCATIONS
+
+/**
+ * Measurements for one phase of one module
+ */
+struct PhaseSample {
+    std::string_view phase;  // context_create, parse, validate, load, ...
+    uint64_t wallNs = 0;     // Monotonic wall time
+    uint64_t cpuNs = 0;      // CPU time of the thread running the phase
+    int64_t rssDeltaKb = 0;  // Process-wide RSS change across the phase, not per module
+    uint64_t allocs = 0;     // Heap allocations made by the thread during the phase
+};
+
+/**
+ * Current resident set size of the process
+ *
+ * @return RSS in KiB, or 0 where it cannot be read
+ */
+int64_t currentRssKb() {
+#if defined(__linux__)
+    // Raw read into a stack buffer so sampling never allocates
+    int fd = ::open("/proc/self/statm", O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return 0;
+    }
+    char text[128];
+    ssize_t length = ::read(fd, text, sizeof(text) - 1);
+    ::close(fd);
+    if (length <= 0) {
+        return 0;
+    }
+    text[length] = '\0';
+    char* cursor = nullptr;
+    std::strtoll(text, &cursor, 10);                            // Total program size
+    int64_t residentPages = std::strtoll(cursor, nullptr, 10);  // Resident set
+    return residentPages * (::sysconf(_SC_PAGESIZE) / 1024);
+#else
+    return 0;
+#endif
+}
+
+/**
+ * Peak resident set size of the process so far
+ *
+ * @return Peak RSS in KiB, or 0 where it cannot be read
+ */
+int64_t peakRssKb() {
+#if defined(__unix__) || defined(__APPLE__)
+    rusage usage {};
+    if (::getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#if defined(__APPLE__)
+    return static_cast<int64_t>(usage.ru_maxrss) / 1024;  // Bytes on macOS
+#else
+    return static_cast<int64_t>(usage.ru_maxrss);
+#endif
+#else
+    return 0;
+#endif
+}
+
+/**
+ * CPU time consumed by the calling thread
+ *
+ * @return Thread CPU time in nanoseconds
+ */
+uint64_t threadCpuNs() {
+#if defined(__unix__) || defined(__APPLE__)
+    timespec now {};
+    if (::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now) == 0) {
+        return static_cast<uint64_t>(now.tv_sec) * 1000000000ULL
+             + static_cast<uint64_t>(now.tv_nsec);
+    }
+#endif
+    return static_cast<uint64_t>(std::clock()) * (1000000000ULL / CLOCKS_PER_SEC);
+}
+
+/**
+ * Snapshot of the counters a phase is measured against
+ */
+struct PhaseClock {
+    std::chrono::steady_clock::time_point wall;
+    uint64_t cpuNs = 0;
+    int64_t rssKb = 0;
+    uint64_t allocs = 0;
+
+    static PhaseClock now() {
+        PhaseClock clock;
+        clock.allocs = t_allocCount;
+        clock.rssKb = currentRssKb();
+        clock.cpuNs = threadCpuNs();
+        clock.wall = std::chrono::steady_clock::now();
+        return clock;
+    }
+
+    /**
+     * Build the sample for the interval from this snapshot to `end`
+     */
+    PhaseSample until(const PhaseClock& end, std::string_view phase) const {
+        PhaseSample sample;
+        sample.phase = phase;
+        sample.wallNs = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(end.wall - wall).count());
+        sample.cpuNs = end.cpuNs - cpuNs;
+        sample.rssDeltaKb = end.rssKb - rssKb;
+        sample.allocs = end.allocs - allocs;
+        return sample;
+    }
+};
+
+/**
+ * Scoped timer appending one PhaseSample when it goes out of scope.
+ * Does nothing unless --profile is enabled.
+ */
+class PhaseTimer {
+public:
+    PhaseTimer(std::vector<PhaseSample>& phases, std::string_view phase)
+        : phases_(g_profile ? &phases : nullptr), phase_(phase) {
+        if (phases_) start_ = PhaseClock::now();
+    }
+    ~PhaseTimer() { stop(); }
+
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+    /**
+     * Record the phase now instead of at scope exit
+     */
+    void stop() {
+        if (phases_) {
+            PhaseClock end = PhaseClock::now();
+            phases_->push_back(start_.until(end, phase_));
+            phases_ = nullptr;
+        }
+    }
+
+private:
+    std::vector<PhaseSample>* phases_;
+    std::string_view phase_;
+    PhaseClock start_;
+};
+
+/**
+ * Times the "teardown" phase: destruction of a handler's RAII contexts.
+ * Declare it before the contexts and a TeardownStart after them; C++
+ * destroys locals in reverse order, so TeardownStart starts the clock
+ * just before the contexts are released and this timer records once
+ * they are gone, on every return path.
+ */
+class TeardownTimer {
+public:
+    explicit TeardownTimer(std::vector<PhaseSample>& phases)
+        : phases_(g_profile ? &phases : nullptr) {}
+    ~TeardownTimer() {
+        if (phases_ && started_) {
+            phases_->push_back(start_.until(PhaseClock::now(), "teardown"));
+        }
+    }
+
+    TeardownTimer(const TeardownTimer&) = delete;
+    TeardownTimer& operator=(const TeardownTimer&) = delete;
+
+    void start() {
+        if (phases_) {
+            start_ = PhaseClock::now();
+            started_ = true;
+        }
+    }
+
+private:
+    std::vector<PhaseSample>* phases_;
+    PhaseClock start_;
+    bool started_ = false;
+};
+
+/**
+ * Starts a TeardownTimer when destroyed (see TeardownTimer)
+ */
+class TeardownStart {
+public:
+    explicit TeardownStart(TeardownTimer& timer) : timer_(timer) {}
+    ~TeardownStart() { timer_.start(); }
+
+    TeardownStart(const TeardownStart&) = delete;
+    TeardownStart& operator=(const TeardownStart&) = delete;
+
+private:
+    TeardownTimer& timer_;
+};
+
+/**
+ * Append a string escaped for use inside a JSON string literal
+ *
+ * @param out  Receives the escaped text (without surrounding quotes)
+ * @param text Raw text
+ */
+void appendJsonEscaped(std::string& out, std::string_view text) {
+    for (char c : text) {
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char code[8];
+                    std::snprintf(code, sizeof(code), "\\u%04x", static_cast<unsigned>(c));
+                    out += code;
+                } else {
+                    out += c;
+                }
+        }
+    }
+}
+
+/**
+ * Escape a string for use inside a JSON string literal
+ *
+ * @param text Raw text
+ * @return Escaped text (without surrounding quotes)
+ */
+std::string jsonEscape(std::string_view text) {
+    std::string escaped;
+    appendJsonEscaped(escaped, text);
+    return escaped;
+}
+
+/**
+ * Stream receiving --profile records (stderr, or the --profile-out file)
+ *
+ * @return Profile output stream
+ */
+std::ostream& profileStream() {
+    static std::ofstream file;
+    if (!g_profileOut.empty()) {
+        if (!file.is_open()) {
+            file.open(g_profileOut, std::ios::out | std::ios::trunc);
+        }
+        if (file) {
+            return file;
+        }
+    }
+    return std::cerr;
+}
+
+/**
+ * Print --profile records for a module, one NDJSON line per phase
+ *
+ * @param command  Command name
+ * @param filename Path to the .wasm file
+ * @param phases   Phase samples in execution order
+ */
+void printProfile(std::string_view command, std::string_view filename,
+                  const std::vector<PhaseSample>& phases) {
+    std::ostream& out = profileStream();
+    std::string file = jsonEscape(filename);
+    for (const PhaseSample& sample : phases) {
+        out << "{\"type\":\"phase\",\"command\":\"" << command
+            << "\",\"file\":\"" << file
+            << "\",\"phase\":\"" << sample.phase
+            << "\",\"wall_ns\":" << sample.wallNs
+            << ",\"cpu_ns\":" << sample.cpuNs
+            << ",\"process_rss_delta_kb\":" << sample.rssDeltaKb
+            << ",\"allocs\":" << sample.allocs << "}\n";
+    }
+}
+
+/**
+ * Print --profile per-phase totals closing a batch run, then the peak RSS
+ *
+ * @param command Command name
+ * @param totals  Summed samples, one per phase
+ * @param counts  Number of samples summed into each total
+ */
+void printProfileTotals(std::string_view command, const std::vector<PhaseSample>& totals,
+                        const std::vector<size_t>& counts) {
+    std::ostream& out = profileStream();
+    for (size_t i = 0; i < totals.size(); i++) {
+        out << "{\"type\":\"phase_total\",\"command\":\"" << command
+            << "\",\"phase\":\"" << totals[i].phase
+            << "\",\"count\":" << counts[i]
+            << ",\"wall_ns\":" << totals[i].wallNs
+            << ",\"cpu_ns\":" << totals[i].cpuNs
+            << ",\"process_rss_delta_kb\":" << totals[i].rssDeltaKb
+            << ",\"allocs\":" << totals[i].allocs << "}\n";
+    }
+    out << "{\"type\":\"peak_rss\",\"command\":\"" << command
+        << "\",\"peak_rss_kb\":" << peakRssKb() << "}\n";
+    out.flush();
+}
+
+// ============================================================================
+// Module Results - One record per processed module
+// ============================================================================
+
+/**
+ * Kind of failure recorded in a ModuleResult
+ */
+enum class ErrorKind {
+    None,      // Module passed the command
+    WasmEdge,  // WasmEdge API returned a non-OK WasmEdge_Result
+    Context,   // WasmEdge context creation returned nullptr
+    Input,     // Module could not be read (missing file, unreadable path)
+    Scan       // Pre-parse scanner rejected the binary (detail + offset)
+};
+
+/**
+ * Outcome of running one sub-command against one module.
+ * Produced by the per-module handlers and rendered by printResult().
+ *
+ * Records hold no per-module heap data of their own on the default path:
+ * every string field is a view. The filename borrows the path the caller
+ * passed to processModule(), which lives in the batch input list (or the
+ * serve request) until the record has been written.
+ */
+struct ModuleResult {
+    std::string_view filename;           // Borrowed from the caller's input list
+    std::string_view command;            // PARSE, VALIDATE, INSTANTIATE
+    std::string_view status;             // SUCCESS, VALID, READY, FAILED, ...
+    ErrorKind errorKind = ErrorKind::None;
+    WasmEdge_Result result{};            // Set when errorKind == WasmEdge
+    std::string_view detail;             // Context name or input error text
+    std::string_view phase;              // Phase that produced the verdict
+    int exitCode = EXIT_OK;
+    uint64_t wallNs = 0;                 // Wall time spent on the module
+    bool cached = false;                 // Verdict answered from the verdict cache
+    uint64_t offset = 0;                 // Byte offset of a scanner rejection
+    std::string extra;                   // Command report: text lines or a JSON object (inspect)
+    std::vector<PhaseSample> phases;     // Filled when --profile is enabled
+};
+
+/**
+ * Phase that produces a command's final verdict
+ *
+ * @param command Command name
+ * @return Phase name used in result records
+ */
+std::string_view commandPhase(std::string_view command) {
+    if (command == "PARSE") return "parse";
+    if (command == "VALIDATE") return "validate";
+    if (command == "COMPILE") return "compile";
+    if (command == "INSPECT") return "inspect";
+    return "instantiate";
+}
+
+/**
+ * Build a successful result record
+ *
+ * @param command   Command name
+ * @param filename  Path to the .wasm file
+ * @param status    Status string (SUCCESS, VALID, READY)
+ * @return Result record with EXIT_OK
+ */
+ModuleResult makeSuccess(std::string_view command, const std::string& filename,
+                         std::string_view status) {
+    ModuleResult record;
+    record.filename = filename;
+    record.command = command;
+    record.status = status;
+    record.phase = commandPhase(command);
+    return record;
+}
+
+/**
+ * Build a result record for a failed WasmEdge API call
+ *
+ * @param command   Command name
+ * @param filename  Path to the .wasm file
+ * @param phase     Phase that failed (parse, validate, load, ...)
+ * @param status    Status string (FAILED, INVALID, etc.)
+ * @param result    WasmEdge result containing error details
+ * @return Result record with EXIT_RUNTIME_ERROR
+ */
+ModuleResult makeWasmEdgeError(std::string_view command, const std::string& filename,
+                               std::string_view phase, std::string_view status,
+                               WasmEdge_Result result) {
+    ModuleResult record = makeSuccess(command, filename, status);
+    record.phase = phase;
+    record.errorKind = ErrorKind::WasmEdge;
+    record.result = result;
+    record.exitCode = EXIT_RUNTIME_ERROR;
+    return record;
+}
+
+/**
+ * Build a result record for a failed context creation
+ *
+ * @param command      Command name
+ * @param filename     Path to the .wasm file
+ * @param contextName  Name of the context that failed to create
+ * @return Result record with EXIT_RUNTIME_ERROR
+ */
+ModuleResult makeContextError(std::string_view command, const std::string& filename,
+                              std::string_view contextName) {
+    ModuleResult record = makeSuccess(command, filename, "FAILED");
+    record.phase = "context_create";
+    record.errorKind = ErrorKind::Context;
+    record.detail = contextName;
+    record.exitCode = EXIT_RUNTIME_ERROR;
+    return record;
+}
+
+/**
+ * Build a result record for a module that could not be read
+ *
+ * @param command   Command name
+ * @param filename  Path to the .wasm file
+ * @param message   Input error description
+ * @return Result record with EXIT_CLI_ERROR
+ */
+ModuleResult makeInputError(std::string_view command, const std::string& filename,
+                            std::string_view message) {
+    ModuleResult record = makeSuccess(command, filename, "FAILED");
+    record.phase = "read";
+    record.errorKind = ErrorKind::Input;
+    record.detail = message;
+    record.exitCode = EXIT_CLI_ERROR;
+    return record;
+}
+
+/**
+ * Build a result record for a module rejected by the pre-parse scanner
+ *
+ * @param command  Command name
+ * @param filename Path to the .wasm file
+ * @param scan     Failed scan result
+ * @return Result record with EXIT_RUNTIME_ERROR
+ */
+ModuleResult makeScanError(std::string_view command, const std::string& filename,
+                           const ScanResult& scan) {
+    ModuleResult record = makeSuccess(command, filename, "REJECTED");
+    record.phase = "scan";
+    record.errorKind = ErrorKind::Scan;
+    record.detail = scan.reason;
+    record.offset = scan.offset;
+    record.exitCode = EXIT_RUNTIME_ERROR;
+    return record;
+}
+
+/**
+ * Print a result record using the structured output helpers
+ *
+ * @param record Result record to print
+ */
+void printResult(const ModuleResult& record) {
+    if (g_profile) {
+        printProfile(record.command, record.filename, record.phases);
+    }
+    switch (record.errorKind) {
+        case ErrorKind::None:
+            printSuccess(record.command, record.filename, record.status);
+            std::cout << record.extra;
+            break;
+        case ErrorKind::WasmEdge:
+            printWasmEdgeError(record.command, record.filename, record.status, record.result);
+            std::cerr << record.extra;
+            break;
+        case ErrorKind::Context:
+            printContextError(record.command, record.filename, record.detail);
+            break;
+        case ErrorKind::Input:
+            std::cerr << "[" << record.command << "]\n"
+                      << "File   : " << record.filename << "\n"
+                      << "Status : " << record.status << "\n"
+                      << "Error  : " << record.detail << "\n";
+            break;
+        case ErrorKind::Scan:
+            std::cerr << "[" << record.command << "]\n"
+                      << "File   : " << record.filename << "\n"
+                      << "Status : " << record.status << "\n"
+                      << "Error  : " << record.detail << " (offset " << record.offset << ")\n";
+            break;
+    }
+}
+
+// ============================================================================
+// Structured Output - JSON/NDJSON records and buffered writer (--format)
+// ============================================================================
+
+/**
+ * Append the fields of a result record as an unterminated JSON object, so
+ * callers can add their own fields before closing it with '}'
+ *
+ * @param json   Receives the JSON text
+ * @param record Result record
+ */
+void appendRecordJsonFields(std::string& json, const ModuleResult& record) {
+    json.reserve(json.size() + 160 + record.filename.size() + record.extra.size()
+                 + 96 * record.phases.size());
+    json += "{\"type\":\"module\",\"file\":\"";
+    appendJsonEscaped(json, record.filename);
+    json += "\",\"command\":\"";
+    json += record.command;
+    json += "\",\"phase\":\"";
+    json += record.phase;
+    json += "\",\"status\":\"";
+    json += record.status;
+    json += "\",\"exit_code\":";
+    json += std::to_string(record.exitCode);
+
+    json += ",\"error_code\":";
+    json += std::to_string(record.errorKind == ErrorKind::WasmEdge
+                           ? WasmEdge_ResultGetCode(record.result) : 0u);
+    json += ",\"error\":";
+    switch (record.errorKind) {
+        case ErrorKind::None:
+            json += "null";
+            break;
+        case ErrorKind::WasmEdge: {
+            const char* message = WasmEdge_ResultGetMessage(record.result);
+            json += "\"";
+            appendJsonEscaped(json, message ? message : "Unknown error");
+            json += "\"";
+            break;
+        }
+        case ErrorKind::Context:
+            json += "\"Failed to create ";
+            appendJsonEscaped(json, record.detail);
+            json += "\"";
+            break;
+        case ErrorKind::Input:
+            json += "\"";
+            appendJsonEscaped(json, record.detail);
+            json += "\"";
+            break;
+        case ErrorKind::Scan:
+            json += "\"";
+            appendJsonEscaped(json, record.detail);
+            json += "\",\"offset\":";
+            json += std::to_string(record.offset);
+            break;
+    }
+
+    json += ",\"wall_ns\":";
+    json += std::to_string(record.wallNs);
+    json += record.cached ? ",\"cached\":true" : ",\"cached\":false";
+    if (!record.extra.empty()) {
+        json += ",\"details\":";
+        json += record.extra;
+    }
+    if (!record.phases.empty()) {
+        json += ",\"phases\":[";
+        for (size_t i = 0; i < record.phases.size(); i++) {
+            const PhaseSample& sample = record.phases[i];
+            if (i > 0) json += ",";
+            json += "{\"phase\":\"";
+            json += sample.phase;
+            json += "\",\"wall_ns\":";
+            json += std::to_string(sample.wallNs);
+            json += ",\"cpu_ns\":";
+            json += std::to_string(sample.cpuNs);
+            json += ",\"process_rss_delta_kb\":";
+            json += std::to_string(sample.rssDeltaKb);
+            json += ",\"allocs\":";
+            json += std::to_string(sample.allocs);
+            json += "}";
+        }
+        json += "]";
+    }
+}
+
+/**
+ * Append a result record as one compact JSON object (no trailing newline).
+ * Pure formatting with no shared state, so workers can call it in parallel.
+ *
+ * @param json   Receives the JSON text
+ * @param record Result record
+ */
+void appendRecordJson(std::string& json, const ModuleResult& record) {
+    appendRecordJsonFields(json, record);
+    json += "}";
+}
+
+/**
+ * Render a result record as one compact JSON object (no trailing newline)
+ *
+ * @param record Result record
+ * @return JSON text
+ */
+std::string renderRecordJson(const ModuleResult& record) {
+    std::string json;
+    appendRecordJson(json, record);
+    return json;
+}
+
+/**
+ * Large preallocated output buffer written to a stdio stream in big chunks.
+ * Owned by the single printer thread, so appending takes no locks and
+ * records are not flushed one line at a time.
+ */
+class OutputBuffer {
+public:
+    explicit OutputBuffer(std::FILE* stream, size_t capacity = 1 << 20)
+        : stream_(stream) {
+        buffer_.reserve(capacity);
+    }
+    ~OutputBuffer() { flush(); }
+
+    OutputBuffer(const OutputBuffer&) = delete;
+    OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+    /**
+     * Append text, writing the buffer out first if it would overflow
+     *
+     * @param text Text to append
+     */
+    void append(std::string_view text) {
+        if (buffer_.size() + text.size() > buffer_.capacity()) {
+            flush();
+        }
+        if (text.size() > buffer_.capacity()) {
+            std::fwrite(text.data(), 1, text.size(), stream_);
+            return;
+        }
+        buffer_.insert(buffer_.end(), text.begin(), text.end());
+    }
+
+    /**
+     * Write out everything buffered so far
+     */
+    void flush() {
+        if (!buffer_.empty()) {
+            std::fwrite(buffer_.data(), 1, buffer_.size(), stream_);
+            buffer_.clear();
+        }
+        std::fflush(stream_);
+    }
+
+private:
+    std::FILE* stream_;
+    std::vector<char> buffer_;
+};
+
+constexpr uint32_t RESULT_LOG_MAGIC = 0x4C524D57;  // "WMRL"
+constexpr uint32_t RESULT_LOG_VERSION = 1;
+constexpr uint32_t RESULT_LOG_BLOCK_RECORDS = 65536;  // Records per block (bounds writer memory)
+
+// Result log layout (--format bin, host byte order): a ResultLogHeader, then
+// blocks of up to RESULT_LOG_BLOCK_RECORDS records. A block is a
+// ResultLogBlockHeader followed by one column per field, widest first so
+// every column is naturally aligned in a mapping of the file:
+//   u64 wallNs[records]
+//   u64 phaseNs[phases][records]   Wall time per phase (0 = not run; --profile)
+//   u32 errorCode[records]         WasmEdge error code (0 unless errorKind is WasmEdge)
+//   u32 pathOffset[records]        Into the block's path table
+//   u32 pathLength[records]
+//   u16 phaseSymbol[phases]        Symbol id naming each phase column
+//   u16 command[records], status[records], phase[records]  Symbol ids
+//   u8  exitCode[records], errorKind[records], cached[records]
+//   u32 symbolOffset[symbols + 1]  (at the next 4-byte boundary)
+//   char symbolText[], pathText[]  (block padded to 8 bytes)
+struct ResultLogHeader {
+    uint32_t magic;
+    uint32_t version;
+};
+struct ResultLogBlockHeader {
+    uint32_t records;
+    uint32_t phases;
+    uint32_t symbols;
+    uint32_t symbolBytes;
+    uint32_t pathBytes;
+    uint32_t reserved;
+    uint64_t size;  // Whole block, header included
+};
+static_assert(sizeof(ResultLogHeader) == 8 && sizeof(ResultLogBlockHeader) == 32,
+              "result log headers have a fixed on-disk size");
+
+/**
+ * Byte offsets of the columns of one result log block, from the block start
+ */
+struct ResultLogLayout {
+    size_t wallNs, phaseNs, errorCode, pathOffset, pathLength, phaseSymbol;
+    size_t command, status, phase, exitCode, errorKind, cached;
+    size_t symbolOffset, symbolText, pathText, size;
+};
+
+/**
+ * Lay out the columns of a result log block
+ *
+ * @param header Block header (records, phases, symbols and text sizes)
+ * @return Column offsets and the padded block size
+ */
+ResultLogLayout resultLogLayout(const ResultLogBlockHeader& header) {
+    size_t records = header.records;
+    ResultLogLayout layout{};
+    layout.wallNs = sizeof(ResultLogBlockHeader);
+    layout.phaseNs = layout.wallNs + 8 * records;
+    layout.errorCode = layout.phaseNs + 8 * records * header.phases;
+    layout.pathOffset = layout.errorCode + 4 * records;
+    layout.pathLength = layout.pathOffset + 4 * records;
+    layout.phaseSymbol = layout.pathLength + 4 * records;
+    layout.command = layout.phaseSymbol + 2 * size_t{header.phases};
+    layout.status = layout.command + 2 * records;
+    layout.phase = layout.status + 2 * records;
+    layout.exitCode = layout.phase + 2 * records;
+    layout.errorKind = layout.exitCode + records;
+    layout.cached = layout.errorKind + records;
+    layout.symbolOffset = (layout.cached + records + 3) & ~size_t{3};
+    layout.symbolText = layout.symbolOffset + 4 * (size_t{header.symbols} + 1);
+    layout.pathText = layout.symbolText + header.symbolBytes;
+    layout.size = (layout.pathText + header.pathBytes + 7) & ~size_t{7};
+    return layout;
+}
+
+/**
+ * Columns of the result log block being filled by the printer thread.
+ * Commands, statuses and phases come from a small fixed vocabulary, so
+ * each block names them once in its symbol table.
+ */
+class ResultLogBlock {
+public:
+    /**
+     * Add one module record
+     *
+     * @param record Result record
+     */
+    void add(const ModuleResult& record) {
+        wallNs_.push_back(record.wallNs);
+        errorCode_.push_back(record.errorKind == ErrorKind::WasmEdge
+                                 ? WasmEdge_ResultGetCode(record.result) : 0u);
+        pathOffset_.push_back(static_cast<uint32_t>(pathText_.size()));
+        pathLength_.push_back(static_cast<uint32_t>(record.filename.size()));
+        pathText_.append(record.filename);
+        command_.push_back(symbol(record.command));
+        status_.push_back(symbol(record.status));
+        phase_.push_back(symbol(record.phase));
+        exitCode_.push_back(static_cast<uint8_t>(record.exitCode));
+        errorKind_.push_back(static_cast<uint8_t>(record.errorKind));
+        cached_.push_back(record.cached ? 1 : 0);
+
+        // A phase seen for the first time gets a column, zero for earlier records
+        for (std::vector<uint64_t>& column : phaseNs_) column.push_back(0);
+        for (const PhaseSample& sample : record.phases) {
+            uint16_t id = symbol(sample.phase);
+            size_t column =
+                std::find(phaseSymbol_.begin(), phaseSymbol_.end(), id) - phaseSymbol_.begin();
+            if (column == phaseSymbol_.size()) {
+                phaseSymbol_.push_back(id);
+                phaseNs_.emplace_back(wallNs_.size(), 0);
+            }
+            phaseNs_[column].back() += sample.wallNs;  // Phases such as context_create can repeat
+        }
+    }
+
+    /**
+     * Number of records in the block
+     *
+     * @return Record count
+     */
+    size_t size() const { return wallNs_.size(); }
+
+    /**
+     * Append the block in its on-disk layout and start a new one
+     *
+     * @param out Receives the block bytes
+     */
+    void flushTo(std::string& out) {
+        ResultLogBlockHeader header{};
+        header.records = static_cast<uint32_t>(wallNs_.size());
+        header.phases = static_cast<uint32_t>(phaseSymbol_.size());
+        header.symbols = static_cast<uint32_t>(symbolOffset_.size());
+        header.symbolBytes = static_cast<uint32_t>(symbolText_.size());
+        header.pathBytes = static_cast<uint32_t>(pathText_.size());
+        ResultLogLayout layout = resultLogLayout(header);
+        header.size = layout.size;
+
+        size_t base = out.size();
+        out.resize(base + layout.size, '\0');
+        auto put = [&out, base](size_t offset, const void* data, size_t bytes) {
+            if (bytes > 0) std::memcpy(&out[base + offset], data, bytes);
+        };
+        auto column = [&put](size_t offset, const auto& values) {
+            put(offset, values.data(), values.size() * sizeof(values[0]));
+        };
+        put(0, &header, sizeof(header));
+        column(layout.wallNs, wallNs_);
+        for (size_t i = 0; i < phaseNs_.size(); i++) {
+            column(layout.phaseNs + 8 * i * header.records, phaseNs_[i]);
+        }
+        column(layout.errorCode, errorCode_);
+        column(layout.pathOffset, pathOffset_);
+        column(layout.pathLength, pathLength_);
+        column(layout.phaseSymbol, phaseSymbol_);
+        column(layout.command, command_);
+        column(layout.status, status_);
+        column(layout.phase, phase_);
+        column(layout.exitCode, exitCode_);
+        column(layout.errorKind, errorKind_);
+        column(layout.cached, cached_);
+        std::vector<uint32_t> offsets = symbolOffset_;
+        offsets.push_back(header.symbolBytes);
+        column(layout.symbolOffset, offsets);
+        put(layout.symbolText, symbolText_.data(), symbolText_.size());
+        put(layout.pathText, pathText_.data(), pathText_.size());
+        clear();
+    }
+
+private:
+    /**
+     * Empty every column, keeping the capacity for the next block
+     */
+    void clear() {
+        wallNs_.clear();
+        phaseNs_.clear();
+        for (auto* column : {&errorCode_, &pathOffset_, &pathLength_, &symbolOffset_}) {
+            column->clear();
+        }
+        for (auto* column : {&phaseSymbol_, &command_, &status_, &phase_}) column->clear();
+        for (auto* column : {&exitCode_, &errorKind_, &cached_}) column->clear();
+        symbolText_.clear();
+        pathText_.clear();
+    }
+
+    /**
+     * Symbol id of a string, adding it to the block's symbol table
+     *
+     * @param text Command, status or phase name
+     * @return Symbol id
+     */
+    uint16_t symbol(std::string_view text) {
+        for (size_t i = 0; i < symbolOffset_.size(); i++) {
+            size_t end = i + 1 < symbolOffset_.size() ? symbolOffset_[i + 1] : symbolText_.size();
+            std::string_view existing =
+                std::string_view(symbolText_).substr(symbolOffset_[i], end - symbolOffset_[i]);
+            if (existing == text) {
+                return static_cast<uint16_t>(i);
+            }
+        }
+        symbolOffset_.push_back(static_cast<uint32_t>(symbolText_.size()));
+        symbolText_.append(text);
+        return static_cast<uint16_t>(symbolOffset_.size() - 1);
+    }
+
+    std::vector<uint64_t> wallNs_;
+    std::vector<std::vector<uint64_t>> phaseNs_;
+    std::vector<uint32_t> errorCode_, pathOffset_, pathLength_, symbolOffset_;
+    std::vector<uint16_t> phaseSymbol_, command_, status_, phase_;
+    std::vector<uint8_t> exitCode_, errorKind_, cached_;
+    std::string symbolText_, pathText_;
+};
+
+/**
+ * Writes result records and the closing summary in the selected format.
+ * Text records go through printResult(); JSON records arrive pre-rendered
+ * (see renderRecordJson) and are framed into the output buffer; binary
+ * records are gathered into ResultLogBlock columns and written a block at
+ * a time.
+ */
+class RecordWriter {
+public:
+    RecordWriter() : out_(stdout) {
+        if (g_format == OutputFormat::Json) {
+            out_.append("{\"records\":[");
+        } else if (g_format == OutputFormat::Bin) {
+            ResultLogHeader header{RESULT_LOG_MAGIC, RESULT_LOG_VERSION};
+            out_.append(std::string_view(reinterpret_cast<const char*>(&header), sizeof(header)));
+        }
+    }
+
+    /**
+     * Write one module record
+     *
+     * @param record   Result record
+     * @param rendered Pre-rendered JSON (ignored in text and bin mode)
+     */
+    void write(const ModuleResult& record, std::string_view rendered) {
+        if (g_format == OutputFormat::Text) {
+            printResult(record);
+            return;
+        }
+        if (g_profile && !g_profileOut.empty()) {
+            printProfile(record.command, record.filename, record.phases);
+        }
+        if (g_format == OutputFormat::Bin) {
+            block_.add(record);
+            if (block_.size() == RESULT_LOG_BLOCK_RECORDS) {
+                flushBlock();
+            }
+            return;
+        }
+        if (g_format == OutputFormat::Json && records_ > 0) {
+            out_.append(",");
+        }
+        out_.append(rendered);
+        if (g_format == OutputFormat::Ndjson) {
+            out_.append("\n");
+        }
+        records_++;
+    }
+
+    /**
+     * Write the summary record closing the output
+     *
+     * @param summaryJson Summary JSON object (ignored in text and bin mode)
+     */
+    void finish(std::string_view summaryJson) {
+        if (g_format == OutputFormat::Bin && block_.size() > 0) {
+            flushBlock();
+        }
+        if (g_format == OutputFormat::Json) {
+            out_.append("],\"summary\":");
+            out_.append(summaryJson.empty() ? std::string_view("null") : summaryJson);
+            out_.append("}\n");
+        } else if (g_format == OutputFormat::Ndjson && !summaryJson.empty()) {
+            out_.append(summaryJson);
+            out_.append("\n");
+        }
+        out_.flush();
+    }
+
+private:
+    /**
+     * Write out the current result log block
+     */
+    void flushBlock() {
+        blockBytes_.clear();
+        block_.flushTo(blockBytes_);
+        out_.append(blockBytes_);
+    }
+
+    OutputBuffer out_;
+    size_t records_ = 0;
+    ResultLogBlock block_;    // --format bin: records not yet written
+    std::string blockBytes_;  // --format bin: reused block encoding buffer
+};
+
+// ============================================================================
+// Module Linking - Library modules registered by name (--link)
+// ============================================================================
+
+/**
+ * A library module named by --link NAME=PATH. Parsed and validated once per
+ * process; the AST is shared read-only by every link set.
+ */
+struct LinkedLibrary {
+    std::string name;    // Module name the imports of later modules refer to
+    std::string path;
+    std::string digest;  // Content digest (hex), folded into verdict keys
+    ASTModulePtr ast;    // Validated AST
+};
+
+/**
+ * Get the --link libraries, in dependency order
+ *
+ * @return Library list (filled by loadLinkedLibraries)
+ */
+std::vector<LinkedLibrary>& linkedLibraries() {
+    static std::vector<LinkedLibrary> libraries;
+    return libraries;
+}
+
+/**
+ * The --link libraries instantiated into a private store, in dependency
+ * order, so each library resolves its imports against the ones before it.
+ * A VM imports the instances by name (WasmEdge_VMRegisterModuleFromImport),
+ * so instantiating any number of modules against the libraries parses,
+ * validates and instantiates each library once per link set. Library state
+ * (memories, tables, globals) is shared by the modules linked against it.
+ */
+class LinkSet {
+public:
+    /**
+     * Instantiate every library
+     *
+     * @param result Receives the WasmEdge result of a failed instantiation
+     * @param failed Receives the name of the library that failed (empty if
+     *               the store or executor could not be created)
+     * @return true on success
+     */
+    bool instantiate(WasmEdge_Result& result, std::string_view& failed) {
+        store_.reset(WasmEdge_StoreCreate());
+        executor_.reset(WasmEdge_ExecutorCreate(toolConfig(), nullptr));
+        if (!store_ || !executor_) {
+            failed = std::string_view();
+            return false;
+        }
+        for (const LinkedLibrary& library : linkedLibraries()) {
+            WasmEdge_ModuleInstanceContext* rawInstance = nullptr;
+            WasmEdge_String name = WasmEdge_StringWrap(library.name.data(),
+                                                       static_cast<uint32_t>(library.name.size()));
+            result = WasmEdge_ExecutorRegister(executor_.get(), &rawInstance, store_.get(),
+                                               library.ast.get(), name);
+            ModuleInstancePtr instance(rawInstance);
+            if (!WasmEdge_ResultOK(result)) {
+                failed = library.name;
+                return false;
+            }
+            instances_.push_back(std::move(instance));
+        }
+        return true;
+    }
+
+    /**
+     * Register the library instances in a VM's store
+     *
+     * @param vm     VM context (its store holds no libraries yet)
+     * @param result Receives the WasmEdge result of a failed registration
+     * @param failed Receives the name of the library that failed
+     * @return true on success
+     */
+    bool importInto(WasmEdge_VMContext* vm, WasmEdge_Result& result,
+                    std::string_view& failed) const {
+        for (size_t i = 0; i < instances_.size(); i++) {
+            result = WasmEdge_VMRegisterModuleFromImport(vm, instances_[i].get());
+            if (!WasmEdge_ResultOK(result)) {
+                failed = linkedLibraries()[i].name;
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    StorePtr store_;
+    ExecutorPtr executor_;
+    std::vector<ModuleInstancePtr> instances_;  // Declared last: deleted before the store
+};
+
+/**
+ * Parse and validate the --link libraries, then link them once so a
+ * missing import or a trapping start function is reported before any
+ * module runs
+ *
+ * @param error Receives the error message on failure
+ * @return true on success (or without --link)
+ */
+bool loadLinkedLibraries(std::string& error) {
+    if (g_links.empty()) {
+        return true;
+    }
+    ParserPtr parserCtx(WasmEdge_ParserCreate(toolConfig()));
+    ValidatorPtr validatorCtx(WasmEdge_ValidatorCreate(toolConfig()));
+    if (!parserCtx || !validatorCtx) {
+        error = "Failed to create the contexts for '--link'.";
+        return false;
+    }
+    std::vector<LinkedLibrary>& libraries = linkedLibraries();
+    for (const std::string& spec : g_links) {
+        LinkedLibrary library;
+        size_t equals = spec.find('=');
+        library.name = spec.substr(0, equals);
+        library.path = spec.substr(equals + 1);
+        for (const LinkedLibrary& earlier : libraries) {
+            if (earlier.name == library.name) {
+                error = "Module name '" + library.name + "' is linked more than once.";
+                return false;
+            }
+        }
+
+        MappedModule module;
+        if (!module.open(library.path)) {
+            error = "Cannot read linked module: " + library.path;
+            return false;
+        }
+        ContentHasher hasher;
+        hasher.update(module.data(), module.size());
+        hasher.appendHexDigest(library.digest);
+
+        WasmEdge_ASTModuleContext* rawAstModule = nullptr;
+        WasmEdge_Result result =
+            WasmEdge_ParserParseFromBytes(parserCtx.get(), &rawAstModule, module.bytes());
+        library.ast.reset(rawAstModule);
+        std::string_view step = "parse";
+        if (WasmEdge_ResultOK(result)) {
+            step = "validate";
+            result = WasmEdge_ValidatorValidate(validatorCtx.get(), library.ast.get());
+        }
+        if (!WasmEdge_ResultOK(result)) {
+            error = "Linked module '" + library.name + "' (" + library.path + ") failed to "
+                  + std::string(step) + ": " + WasmEdge_ResultGetMessage(result);
+            return false;
+        }
+        printVerbose("Linked module ", library.name, ": ", library.path);
+        libraries.push_back(std::move(library));
+    }
+
+    LinkSet trial;
+    WasmEdge_Result result = WasmEdge_Result_Success;
+    std::string_view failed;
+    if (!trial.instantiate(result, failed)) {
+        error = failed.empty()
+            ? std::string("Failed to create the store for '--link'.")
+            : "Linked module '" + std::string(failed) + "' failed to instantiate: "
+                  + WasmEdge_ResultGetMessage(result);
+        return false;
+    }
+    return true;
+}
+
+// ============================================================================
+// Session - WasmEdge contexts reused across modules
+// ============================================================================
+
+/**
+ * Reusable WasmEdge contexts for processing many modules in one process.
+ * Contexts are created lazily on first use and shared by every module the
+ * session processes; RAII wrappers release them when the session ends.
+ */
+class Session {
+public:
+    /**
+     * Get the shared parser context, creating it on first use
+     *
+     * @return Parser context, or nullptr if creation failed
+     */
+    WasmEdge_ParserContext* parser() {
+        if (!parserCtx_) {
+            printVerbose("Creating parser context...");
+            PhaseTimer timer(phases_, "context_create");
+            parserCtx_.reset(WasmEdge_ParserCreate(toolConfig()));
+        }
+        return parserCtx_.get();
+    }
+
+    /**
+     * Get the shared validator context, creating it on first use
+     *
+     * @return Validator context, or nullptr if creation failed
+     */
+    WasmEdge_ValidatorContext* validator() {
+        if (!validatorCtx_) {
+            printVerbose("Creating validator context...");
+            PhaseTimer timer(phases_, "context_create");
+            validatorCtx_.reset(WasmEdge_ValidatorCreate(toolConfig()));
+        }
+        return validatorCtx_.get();
+    }
+
+    /**
+     * Get the shared AOT compiler context, creating it on first use
+     * (toolConfig() carries the --opt-level in effect)
+     *
+     * @return Compiler context, or nullptr if creation failed (for example
+     *         when WasmEdge was built without the AOT compiler)
+     */
+    WasmEdge_CompilerContext* compiler() {
+        if (!compilerCtx_) {
+            printVerbose("Creating compiler context...");
+            PhaseTimer timer(phases_, "context_create");
+            compilerCtx_.reset(WasmEdge_CompilerCreate(toolConfig()));
+        }
+        return compilerCtx_.get();
+    }
+
+    /**
+     * Borrow a VM context: an idle one from the attached pool, else a newly
+     * created one (recorded as context_create)
+     *
+     * @return VM lease (empty if creation failed)
+     */
+    VMPool::Lease acquireVM() {
+        VMPtr vm = vmPool_ ? vmPool_->take() : VMPtr();
+        if (vm) {
+            printVerbose("Reusing pooled VM context...");
+        } else {
+            printVerbose("Creating VM context...");
+            PhaseTimer timer(phases_, "context_create");
+            vm = createVM();
+        }
+        return VMPool::Lease(vmPool_, std::move(vm));
+    }
+
+    /**
+     * Register the --link libraries in a VM's store. The session's link set
+     * is instantiated on first use (recorded as link) and imported by
+     * every VM the session borrows afterwards.
+     *
+     * @param vm     VM context to link (nullptr only prepares the link set)
+     * @param result Receives the WasmEdge result of a failure
+     * @param failed Receives the name of the library that failed (empty if
+     *               a context could not be created)
+     * @return true on success (always without --link)
+     */
+    bool linkModules(WasmEdge_VMContext* vm, WasmEdge_Result& result, std::string_view& failed) {
+        if (linkedLibraries().empty()) {
+            return true;
+        }
+        if (!linkSet_) {
+            printVerbose("Instantiating linked modules...");
+            PhaseTimer timer(phases_, "link");
+            auto links = std::make_unique<LinkSet>();
+            if (!links->instantiate(result, failed)) {
+                return false;
+            }
+            linkSet_ = std::move(links);
+        }
+        return !vm || linkSet_->importInto(vm, result, failed);
+    }
+
+    /**
+     * Get the session's WASI host module, creating it on first use. It is
+     * built once per session and re-initialized by initWasi for each
+     * instantiation; VMs import it by name, so WasmEdge_VMCleanup does not
+     * rebuild it.
+     *
+     * @return WASI module instance, or nullptr if creation failed
+     */
+    WasmEdge_ModuleInstanceContext* wasiModule() {
+        if (!wasi_) {
+            printVerbose("Creating WASI host module...");
+            PhaseTimer timer(phases_, "context_create");
+            wasi_.reset(WasmEdge_ModuleInstanceCreateWASI(nullptr, 0, nullptr, 0, nullptr, 0));
+        }
+        return wasi_.get();
+    }
+
+    /**
+     * The session's WASI host module, without creating it
+     *
+     * @return WASI module instance, or nullptr if none was created
+     */
+    const WasmEdge_ModuleInstanceContext* wasi() const { return wasi_.get(); }
+
+    /**
+     * Share a VM pool with other sessions (without one, VMs are per module)
+     *
+     * @param pool VM pool that outlives the session's handler calls
+     */
+    void setVMPool(VMPool* pool) { vmPool_ = pool; }
+
+    /**
+     * Phase samples recorded for the module currently being processed
+     *
+     * @return Phase log (moved into the module's result record)
+     */
+    std::vector<PhaseSample>& phases() { return phases_; }
+
+    /**
+     * Get the session's buffer for stream inputs (reused across modules)
+     *
+     * @return Stream arena
+     */
+    StreamArena& streamArena() { return streamArena_; }
+
+    /**
+     * Supply the bytes of the next module directly instead of reading them
+     * from its path (serve payloads, or a mapping already made for hashing).
+     * The bytes must outlive the handler call.
+     *
+     * @param bytes Module bytes
+     */
+    void setInlineModule(std::string_view bytes) {
+        inlineModule_ = bytes;
+        hasInlineModule_ = true;
+    }
+
+    /**
+     * Read modules from their paths again
+     */
+    void clearInlineModule() {
+        inlineModule_ = std::string_view();
+        hasInlineModule_ = false;
+    }
+
+    bool hasInlineModule() const { return hasInlineModule_; }
+
+    /**
+     * Open the current module: the inline bytes if set, else the mapped file
+     * (read into a buffer with --no-mmap)
+     *
+     * @param module   Receives the module view
+     * @param filename Path to the .wasm file
+     * @return true on success, false if the module could not be read
+     */
+    bool openModule(MappedModule& module, const std::string& filename) const {
+        if (hasInlineModule_) {
+            return module.borrow(inlineModule_);
+        }
+        return g_useMmap ? module.open(filename) : module.read(filename);
+    }
+
+private:
+    ParserPtr parserCtx_;
+    ValidatorPtr validatorCtx_;
+    CompilerPtr compilerCtx_;
+    std::vector<PhaseSample> phases_;
+    StreamArena streamArena_;
+    std::string_view inlineModule_;
+    bool hasInlineModule_ = false;
+    VMPool* vmPool_ = nullptr;
+    std::unique_ptr<LinkSet> linkSet_;  // --link library instances (built on first use)
+    ModuleInstancePtr wasi_;             // --wasi host module (built on first use)
+};
+
+/**
+ * Hands a module mapping made by an earlier stage (scan, cache key) to the
+ * handlers for the duration of a scope, so the file is mapped only once.
+ * Does nothing with --no-mmap, when the session already has an inline
+ * module, or when the mapping is empty.
+ */
+class InlineModuleScope {
+public:
+    InlineModuleScope(Session& session, const MappedModule& module)
+        : session_(session),
+          active_(g_useMmap && module.data() && !session.hasInlineModule()) {
+        if (active_) {
+            session_.setInlineModule(std::string_view(reinterpret_cast<const char*>(module.data()),
+                                                      module.size()));
+        }
+    }
+
+    /**
+     * Hand over bytes that exist only in memory (a stream input), so this
+     * applies with --no-mmap too
+     *
+     * @param session Session to supply
+     * @param bytes   Module bytes (must outlive the scope)
+     */
+    InlineModuleScope(Session& session, std::string_view bytes)
+        : session_(session), active_(!session.hasInlineModule()) {
+        if (active_) {
+            session_.setInlineModule(bytes);
+        }
+    }
+    ~InlineModuleScope() {
+        if (active_) session_.clearInlineModule();
+    }
+
+    InlineModuleScope(const InlineModuleScope&) = delete;
+    InlineModuleScope& operator=(const InlineModuleScope&) = delete;
+
+private:
+    Session& session_;
+    bool active_;
+};
+
+/**
+ * Read a stream input into the session's arena, timed as the "read" phase
+ * 
+ * @param session  Session owning the arena
+ * @param filename '-' or a FIFO/device path
+ * @param error    Receives a static description when reading fails
+ * @return Module bytes (valid until the next stream read), or nullopt on failure
+ */
+std::optional<std::string_view> readStreamInput(Session& session, const std::string& filename,
+                                               std::string_view& error) {
+    PhaseTimer timer(session.phases(), "read");
+    printVerbose("Reading module stream: ", filename);
+    StreamArena& arena = session.streamArena();
+    if (!arena.fill(filename, error)) {
+        return std::nullopt;
+    }
+    return arena.view();
+}
+
+/**
+ * Run the pre-parse scanner over a module, unless --no-scan is set.
+ * Unreadable modules pass through, so the handler reports them as usual.
+ * 
+ * @param session   Session supplying any inline module and collecting phases
+ * @param command   Command name used in the rejection record
+ * @param filename  Path to the .wasm file
+ * @param module    Receives the mapping, for reuse by later stages
+ * @param rejection Receives the result record when the scan fails
+ * @return false if the scanner rejected the module
+ */
+bool scanModuleInput(Session& session, std::string_view command, const std::string& filename,
+                     MappedModule& module, ModuleResult& rejection) {
+    if (!g_scan || !session.openModule(module, filename)) {
+        return true;
+    }
+    ScanResult scan;
+    {
+        PhaseTimer timer(session.phases(), "scan");
+        scan = scanModule(module.data(), module.size());
+    }
+    if (!scan.ok) {
+        printVerbose("Scanner rejected module: ", scan.reason);
+        rejection = makeScanError(command, filename, scan);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Parse a module with the configured loading path.
+ * With mmap enabled (default) the file is mapped and handed to
+ * WasmEdge_ParserParseFromBytes, then unmapped as soon as the AST exists
+ * (the AST owns copies of everything it needs). --no-mmap uses
+ * WasmEdge_ParserParseFromFile. Inline modules set on the session are
+ * always parsed from their bytes.
+ * 
+ * @param session   Session supplying any inline module
+ * @param parserCtx Parser context
+ * @param filename  Path to the .wasm file
+ * @param astModule Receives the parsed AST module (ownership transferred)
+ * @param readError Set to true if the file could not be mapped
+ * @return WasmEdge result of the parse
+ */
+WasmEdge_Result parseModuleFile(Session& session, WasmEdge_ParserContext* parserCtx,
+                                const std::string& filename, ASTModulePtr& astModule,
+                                bool& readError) {
+    readError = false;
+    WasmEdge_ASTModuleContext* rawAstModule = nullptr;
+    WasmEdge_Result result;
+
+    if (g_useMmap || session.hasInlineModule()) {
+        MappedModule module;
+        if (!session.openModule(module, filename)) {
+            readError = true;
+            return WasmEdge_Result_Fail;
+        }
+        result = WasmEdge_ParserParseFromBytes(parserCtx, &rawAstModule, module.bytes());
+    } else {
+        result = WasmEdge_ParserParseFromFile(parserCtx, &rawAstModule, filename.c_str());
+    }
+
+    astModule.reset(rawAstModule);  // Take ownership immediately
+    return result;
+}
+
+
+/**
+ * Per-module sub-command handler signature
+ */
+using ModuleHandler = ModuleResult (*)(Session&, const std::string&);
+
+// ============================================================================
+// Snapshots - Post-instantiation state saved to a file (--snapshot)
+// ============================================================================
+
+constexpr uint32_t SNAPSHOT_MAGIC = 0x4E534D57;  // "WMSN"
+constexpr uint32_t SNAPSHOT_VERSION = 1;
+constexpr uint64_t WASM_PAGE_SIZE = 65536;
+constexpr uint64_t SNAPSHOT_CHUNK = 1ull << 30;  // Memory bytes per WasmEdge pointer request
+
+// Snapshot file layout (host byte order): header, entries, export names,
+// then one image per memory at a WASM_PAGE_SIZE-aligned offset, so an image
+// can be mapped straight over the linear memory of a new instance.
+struct SnapshotHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t moduleHigh;  // Digest of the module the snapshot was taken from
+    uint64_t moduleLow;
+    uint64_t stateHigh;   // Digest of the entries, names and images
+    uint64_t stateLow;
+    uint32_t entryCount;
+    uint32_t reserved;
+};
+enum SnapshotKind : uint32_t {
+    SNAPSHOT_MEMORY = 0,
+    SNAPSHOT_GLOBAL = 1,
+    SNAPSHOT_TABLE = 2,
+};
+struct SnapshotEntry {
+    uint32_t kind;         // SnapshotKind
+    uint32_t nameLength;
+    uint64_t nameOffset;   // File offset of the export name
+    uint64_t dataOffset;   // Memory: file offset of the image
+    uint64_t size;         // Memory: pages; table: elements
+    uint8_t value[16];     // Global: raw value
+    uint8_t valueType[8];  // Global: WasmEdge_ValType
+};
+static_assert(sizeof(SnapshotEntry) == 56, "snapshot entries are 56 bytes on disk");
+static_assert(sizeof(WasmEdge_Value::Value) <= 16 && sizeof(WasmEdge_ValType) <= 8,
+              "snapshot entries hold a raw WasmEdge_Value");
+
+/**
+ * Names of one kind of export of a module instance
+ *
+ * @param module Module instance
+ * @param length WasmEdge_ModuleInstanceList*Length for the kind
+ * @param list   WasmEdge_ModuleInstanceList* for the kind
+ * @return Export names
+ */
+std::vector<std::string> listInstanceExports(
+    const WasmEdge_ModuleInstanceContext* module,
+    uint32_t (*length)(const WasmEdge_ModuleInstanceContext*),
+    uint32_t (*list)(const WasmEdge_ModuleInstanceContext*, WasmEdge_String*, const uint32_t)) {
+    std::vector<WasmEdge_String> raw(length(module));
+    raw.resize(list(module, raw.data(), static_cast<uint32_t>(raw.size())));
+    std::vector<std::string> names;
+    names.reserve(raw.size());
+    for (const WasmEdge_String& name : raw) {
+        names.emplace_back(name.Buf, name.Length);
+    }
+    return names;
+}
+
+/**
+ * Wrap a std::string as a non-owning WasmEdge_String
+ *
+ * @param text String that outlives the use
+ * @return String view for the C API
+ */
+WasmEdge_String wrapString(const std::string& text) {
+    return WasmEdge_StringWrap(text.data(), static_cast<uint32_t>(text.size()));
+}
+
+/**
+ * Skip a constant expression (the offset of an active data segment)
+ *
+ * @param p   First instruction
+ * @param end End of the section payload
+ * @return Pointer past the closing end opcode, or nullptr if the expression
+ *         is truncated or uses an instruction not allowed there
+ */
+const uint8_t* skipConstExpr(const uint8_t* p, const uint8_t* end) {
+    auto skipLeb = [&p, end](size_t maxBytes) {
+        for (size_t i = 0; i < maxBytes && p < end; i++) {
+            if ((*p++ & 0x80) == 0) return true;
+        }
+        return false;
+    };
+    while (p < end) {
+        uint8_t opcode = *p++;
+        switch (opcode) {
+        case 0x0B:  // end
+            return p;
+        case 0x41:  // i32.const
+        case 0x23:  // global.get
+        case 0xD0:  // ref.null (heap type)
+        case 0xD2:  // ref.func
+            if (!skipLeb(5)) return nullptr;
+            break;
+        case 0x42:  // i64.const
+            if (!skipLeb(10)) return nullptr;
+            break;
+        case 0x43:  // f32.const
+        case 0x44:  // f64.const
+            if (end - p < (opcode == 0x43 ? 4 : 8)) return nullptr;
+            p += opcode == 0x43 ? 4 : 8;
+            break;
+        case 0x6A: case 0x6B: case 0x6C:  // i32.add/sub/mul (extended-const)
+        case 0x7C: case 0x7D: case 0x7E:  // i64.add/sub/mul
+            break;
+        default:
+            return nullptr;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * Build the module a snapshot is restored into: the start section is
+ * dropped and every active data segment becomes an empty passive one, so
+ * instantiation runs neither. Passive segments are kept for memory.init,
+ * and segment indices and the data count are unchanged (memory.init on a
+ * former active segment behaves as on a dropped one). Element segments are
+ * kept: they are cheap and restore the function references of tables.
+ *
+ * @param data  Module bytes (already scanned)
+ * @param spans Section layout from scanModule
+ * @param out   Receives the rewritten module
+ * @return false if the data section cannot be decoded
+ */
+bool stripInitialization(const uint8_t* data, const std::vector<SectionSpan>& spans,
+                         std::string& out) {
+    constexpr uint8_t START_SECTION = 8;
+    constexpr uint8_t DATA_SECTION = 11;
+    out.assign(reinterpret_cast<const char*>(data), 8);  // Magic and version
+    for (const SectionSpan& span : spans) {
+        const uint8_t* p = data + span.offset;
+        const uint8_t* end = p + span.size;
+        if (span.id == START_SECTION) {
+            continue;
+        }
+        if (span.id != DATA_SECTION) {
+            out.append(reinterpret_cast<const char*>(data + span.headerOffset),
+                       static_cast<size_t>(end - (data + span.headerOffset)));
+            continue;
+        }
+
+        std::string section;
+        uint32_t count = 0;
+        size_t length = 0;
+        if (!readVarU32(p, end, count, length)) {
+            return false;
+        }
+        section.append(reinterpret_cast<const char*>(p), length);
+        p += length;
+        for (uint32_t i = 0; i < count; i++) {
+            const uint8_t* segment = p;
+            uint32_t flags = 0;
+            uint32_t memoryIndex = 0;
+            if (!readVarU32(p, end, flags, length)) {
+                return false;
+            }
+            p += length;
+            if (flags == 2) {
+                if (!readVarU32(p, end, memoryIndex, length)) {
+                    return false;
+                }
+                p += length;
+            }
+            if (flags == 0 || flags == 2) {
+                p = skipConstExpr(p, end);
+            } else if (flags != 1) {
+                return false;
+            }
+            uint32_t byteCount = 0;
+            if (!p || !readVarU32(p, end, byteCount, length)
+                || byteCount > static_cast<uint64_t>(end - p) - length) {
+                return false;
+            }
+            p += length + byteCount;
+            if (flags == 1) {
+                section.append(reinterpret_cast<const char*>(segment),
+                               static_cast<size_t>(p - segment));
+            } else {
+                section.append("\x01\x00", 2);  // Passive, no bytes
+            }
+        }
+        appendSectionHeader(out, DATA_SECTION, section.size());
+        out += section;
+    }
+    return true;
+}
+
+/**
+ * Check that a snapshot of a module can hold all the state its
+ * initialization produces. The snapshot only captures exports, and the
+ * stripped module a snapshot is restored into skips every active data
+ * segment and the start function, so a memory that is not exported would
+ * come back empty, and a mutable global that is not exported (such as a
+ * __stack_pointer the start function moved) would come back at its
+ * initial value. Only table sizes are saved, so any table in a module with
+ * a start function is refused: entries the start function writes with
+ * table.set, table.init, table.fill or table.grow would be lost.
+ *
+ * @param data  Module bytes (already scanned)
+ * @param spans Section layout from scanModule
+ * @return Reason the module cannot be snapshotted, empty if it can
+ */
+std::string_view snapshotLimitation(const uint8_t* data, const std::vector<SectionSpan>& spans) {
+    std::vector<bool> memoryExported;  // Per memory index, imports first
+    std::vector<bool> globalMutable;   // Per global index, imports first
+    std::vector<bool> globalExported;
+    uint32_t tables = 0;  // Imported and defined
+    bool hasStart = false;
+    for (const SectionSpan& span : spans) {
+        const uint8_t* end = data + span.offset + span.size;
+        WasmReader in(data + span.offset, end);
+        switch (span.id) {
+        case 2:  // Import
+            for (uint32_t n = in.u32(); n > 0 && in.ok(); n--) {
+                in.name();
+                in.name();
+                switch (in.byte()) {
+                case 0: in.u32(); break;
+                case 1: in.skipValType(); in.skipLimits(); tables++; break;
+                case 2: in.skipLimits(); memoryExported.push_back(false); break;
+                case 3: in.skipValType(); globalMutable.push_back(in.byte() == 1); break;
+                case 4: in.byte(); in.u32(); break;
+                default: return "Malformed import section";
+                }
+            }
+            break;
+        case 4:  // Table
+            tables += in.u32();  // Only the count matters here
+            break;
+        case 5:  // Memory
+            for (uint32_t n = in.u32(); n > 0 && in.ok(); n--) {
+                in.skipLimits();
+                memoryExported.push_back(false);
+            }
+            break;
+        case 6:  // Global
+            for (uint32_t n = in.u32(); n > 0 && in.ok(); n--) {
+                in.skipValType();
+                globalMutable.push_back(in.byte() == 1);
+                const uint8_t* next = in.ok() ? skipConstExpr(in.position(), end) : nullptr;
+                if (!next) {
+                    return "Cannot decode a global initializer";
+                }
+                in.skip(static_cast<uint64_t>(next - in.position()));
+            }
+            break;
+        case 7:  // Export
+            globalExported.assign(globalMutable.size(), false);
+            for (uint32_t n = in.u32(); n > 0 && in.ok(); n--) {
+                in.name();
+                uint8_t kind = in.byte();
+                uint32_t index = in.u32();
+                if (kind == 2 && index < memoryExported.size()) memoryExported[index] = true;
+                if (kind == 3 && index < globalExported.size()) globalExported[index] = true;
+            }
+            break;
+        case 8:  // Start
+            hasStart = true;
+            break;
+        default:
+            break;
+        }
+        if (!in.ok()) {
+            return "Malformed module section";
+        }
+    }
+    if (std::find(memoryExported.begin(), memoryExported.end(), false) != memoryExported.end()) {
+        return "Module has a memory that is not exported, so a snapshot cannot capture it";
+    }
+    if (hasStart && tables > 0) {
+        return "Module has a start function and a table, so a snapshot cannot capture "
+               "what the start function writes to it";
+    }
+    globalExported.resize(globalMutable.size(), false);
+    for (size_t i = 0; hasStart && i < globalMutable.size(); i++) {
+        if (globalMutable[i] && !globalExported[i]) {
+            return "Module has a start function and a mutable global that is not exported, "
+                   "so a snapshot cannot capture what the start function writes to it";
+        }
+    }
+    return std::string_view();
+}
+
+/**
+ * Capture the exported memories, mutable globals and table sizes of an
+ * instantiated module into a snapshot file (written to a temporary file,
+ * then renamed into place)
+ *
+ * @param vmCtx  VM holding the instantiated module
+ * @param module Module bytes (for the module digest)
+ * @param path   Snapshot file to write
+ * @return Error text, empty on success
+ */
+std::string_view writeSnapshot(const WasmEdge_VMContext* vmCtx, const MappedModule& module,
+                               const std::string& path) {
+    const WasmEdge_ModuleInstanceContext* instance = WasmEdge_VMGetActiveModule(vmCtx);
+    if (!instance) {
+        return "No instantiated module";
+    }
+    std::vector<SectionSpan> spans;
+    if (!scanModule(module.data(), module.size(), &spans).ok) {
+        return "Cannot decode the module";
+    }
+    std::string_view limitation = snapshotLimitation(module.data(), spans);
+    if (!limitation.empty()) {
+        return limitation;
+    }
+
+    // Entries and names first; memory images follow at aligned offsets
+    std::vector<SnapshotEntry> entries;
+    std::string names;
+    std::vector<const WasmEdge_MemoryInstanceContext*> memories;
+    auto addEntry = [&](SnapshotKind kind, const std::string& name) -> SnapshotEntry& {
+        SnapshotEntry& entry = entries.emplace_back();
+        std::memset(&entry, 0, sizeof(entry));
+        entry.kind = kind;
+        entry.nameLength = static_cast<uint32_t>(name.size());
+        entry.nameOffset = names.size();  // Relative until the layout is known
+        names += name;
+        return entry;
+    };
+    for (const std::string& name :
+         listInstanceExports(instance, WasmEdge_ModuleInstanceListMemoryLength,
+                             WasmEdge_ModuleInstanceListMemory)) {
+        const WasmEdge_MemoryInstanceContext* memory =
+            WasmEdge_ModuleInstanceFindMemory(instance, wrapString(name));
+        addEntry(SNAPSHOT_MEMORY, name).size = WasmEdge_MemoryInstanceGetPageSize(memory);
+        memories.push_back(memory);
+    }
+    for (const std::string& name :
+         listInstanceExports(instance, WasmEdge_ModuleInstanceListGlobalLength,
+                             WasmEdge_ModuleInstanceListGlobal)) {
+        const WasmEdge_GlobalInstanceContext* global =
+            WasmEdge_ModuleInstanceFindGlobal(instance, wrapString(name));
+        const WasmEdge_GlobalTypeContext* type = WasmEdge_GlobalInstanceGetGlobalType(global);
+        WasmEdge_Value value = WasmEdge_GlobalInstanceGetValue(global);
+        if (WasmEdge_GlobalTypeGetMutability(type) != WasmEdge_Mutability_Var) {
+            continue;  // Immutable globals are recomputed by instantiation
+        }
+        if (WasmEdge_ValTypeIsRef(value.Type)) {
+            printVerbose("Snapshot skips reference global: ", name);
+            continue;  // References are process addresses
+        }
+        SnapshotEntry& entry = addEntry(SNAPSHOT_GLOBAL, name);
+        std::memcpy(entry.value, &value.Value, sizeof(value.Value));
+        std::memcpy(entry.valueType, &value.Type, sizeof(value.Type));
+    }
+    for (const std::string& name :
+         listInstanceExports(instance, WasmEdge_ModuleInstanceListTableLength,
+                             WasmEdge_ModuleInstanceListTable)) {
+        const WasmEdge_TableInstanceContext* table =
+            WasmEdge_ModuleInstanceFindTable(instance, wrapString(name));
+        addEntry(SNAPSHOT_TABLE, name).size = WasmEdge_TableInstanceGetSize(table);
+    }
+
+    uint64_t namesOffset = sizeof(SnapshotHeader) + entries.size() * sizeof(SnapshotEntry);
+    uint64_t dataOffset =
+        (namesOffset + names.size() + WASM_PAGE_SIZE - 1) / WASM_PAGE_SIZE * WASM_PAGE_SIZE;
+    for (SnapshotEntry& entry : entries) {
+        entry.nameOffset += namesOffset;
+        if (entry.kind == SNAPSHOT_MEMORY) {
+            entry.dataOffset = dataOffset;
+            dataOffset += entry.size * WASM_PAGE_SIZE;
+        }
+    }
+
+    ContentHasher moduleHasher;
+    moduleHasher.update(module.data(), module.size());
+    ContentHasher stateHasher;
+    stateHasher.update(entries.data(), entries.size() * sizeof(SnapshotEntry));
+    stateHasher.update(names.data(), names.size());
+
+    std::string tmpPath = temporaryPathFor(path);
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        out.seekp(static_cast<std::streamoff>(sizeof(SnapshotHeader)));
+        out.write(reinterpret_cast<const char*>(entries.data()),
+                  static_cast<std::streamsize>(entries.size() * sizeof(SnapshotEntry)));
+        out.write(names.data(), static_cast<std::streamsize>(names.size()));
+        size_t memoryIndex = 0;
+        for (const SnapshotEntry& entry : entries) {
+            if (entry.kind != SNAPSHOT_MEMORY) {
+                continue;
+            }
+            const WasmEdge_MemoryInstanceContext* memory = memories[memoryIndex++];
+            out.seekp(static_cast<std::streamoff>(entry.dataOffset));
+            uint64_t total = entry.size * WASM_PAGE_SIZE;
+            for (uint64_t offset = 0; offset < total && out; offset += SNAPSHOT_CHUNK) {
+                uint32_t chunk = static_cast<uint32_t>(std::min(SNAPSHOT_CHUNK, total - offset));
+                const uint8_t* bytes = WasmEdge_MemoryInstanceGetPointerConst(
+                    memory, static_cast<uint32_t>(offset), chunk);
+                if (!bytes) {
+                    out.setstate(std::ios::failbit);
+                    break;
+                }
+                stateHasher.update(bytes, chunk);
+                out.write(reinterpret_cast<const char*>(bytes), chunk);
+            }
+        }
+        SnapshotHeader header{};
+        header.magic = SNAPSHOT_MAGIC;
+        header.version = SNAPSHOT_VERSION;
+        moduleHasher.digest(header.moduleHigh, header.moduleLow);
+        stateHasher.digest(header.stateHigh, header.stateLow);
+        header.entryCount = static_cast<uint32_t>(entries.size());
+        out.seekp(0);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        if (!out) {
+            out.close();
+            std::error_code ec;
+            fs::remove(tmpPath, ec);
+            return "Cannot write snapshot file";
+        }
+    }
+    if (!publishTemporary(tmpPath, path)) {
+        return "Cannot write snapshot file";
+    }
+    return std::string_view();
+}
+
+/**
+ * A snapshot opened with --from-snapshot. Restoring maps each memory image
+ * copy-on-write (MAP_PRIVATE | MAP_FIXED) over the linear memory of a fresh
+ * instance, so pages are read lazily from the page cache and only the
+ * pages an instance writes are copied. With --no-mmap, or when the memory
+ * is not page-aligned, the image is copied instead.
+ */
+class Snapshot {
+public:
+    Snapshot() = default;
+    ~Snapshot() {
+#if defined(__unix__) || defined(__APPLE__)
+        if (fd_ >= 0) ::close(fd_);
+#endif
+    }
+    Snapshot(const Snapshot&) = delete;
+    Snapshot& operator=(const Snapshot&) = delete;
+
+    /**
+     * Read and check the header, entries and names of a snapshot file
+     *
+     * @param path  Snapshot file
+     * @param error Receives a message on failure
+     * @return true on success
+     */
+    bool open(const std::string& path, std::string& error) {
+        path_ = path;
+        std::ifstream in(path, std::ios::binary);
+        std::error_code ec;
+        uint64_t fileSize = fs::file_size(path, ec);
+        if (!in || ec || !in.read(reinterpret_cast<char*>(&header_), sizeof(header_))) {
+            error = "Cannot read snapshot: " + path;
+            return false;
+        }
+        if (header_.magic != SNAPSHOT_MAGIC || header_.version != SNAPSHOT_VERSION) {
+            error = "Not a wasm-mini snapshot (or written by another version): " + path;
+            return false;
+        }
+        // Bounded by the file size before anything is allocated for the entries
+        if (header_.entryCount > (fileSize - sizeof(header_)) / sizeof(SnapshotEntry)) {
+            error = "Snapshot is truncated or corrupt: " + path;
+            return false;
+        }
+        entries_.resize(header_.entryCount);
+        in.read(reinterpret_cast<char*>(entries_.data()),
+                static_cast<std::streamsize>(entries_.size() * sizeof(SnapshotEntry)));
+        for (const SnapshotEntry& entry : entries_) {
+            // Kind and name bounds are checked before the name is allocated
+            bool known = entry.kind == SNAPSHOT_MEMORY || entry.kind == SNAPSHOT_GLOBAL
+                      || entry.kind == SNAPSHOT_TABLE;
+            bool nameFits = entry.nameOffset <= fileSize
+                         && entry.nameLength <= fileSize - entry.nameOffset;
+            if (!in || !known || !nameFits) {
+                error = "Snapshot is truncated or corrupt: " + path;
+                return false;
+            }
+            std::string& name = names_.emplace_back(entry.nameLength, '\0');
+            in.seekg(static_cast<std::streamoff>(entry.nameOffset));
+            in.read(name.data(), static_cast<std::streamsize>(name.size()));
+            bool fits = entry.kind != SNAPSHOT_MEMORY
+                || (entry.dataOffset % WASM_PAGE_SIZE == 0 && entry.dataOffset <= fileSize
+                    && entry.size <= (fileSize - entry.dataOffset) / WASM_PAGE_SIZE);
+            if (!in || !fits) {
+                error = "Snapshot is truncated or corrupt: " + path;
+                return false;
+            }
+        }
+#if defined(__unix__) || defined(__APPLE__)
+        fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd_ < 0) {
+            error = "Cannot read snapshot: " + path;
+            return false;
+        }
+#endif
+        return true;
+    }
+
+    /**
+     * Check that the snapshot was taken from this module
+     *
+     * @param module Module bytes
+     * @return true if the module digest matches
+     */
+    bool matches(const MappedModule& module) const {
+        ContentHasher hasher;
+        hasher.update(module.data(), module.size());
+        uint64_t high = 0;
+        uint64_t low = 0;
+        hasher.digest(high, low);
+        return high == header_.moduleHigh && low == header_.moduleLow;
+    }
+
+    /**
+     * Identify the captured state (folded into verdict cache keys)
+     *
+     * @return State digest (hex)
+     */
+    std::string stateDigest() const {
+        char text[33];
+        std::snprintf(text, sizeof(text), "%016llx%016llx",
+                      static_cast<unsigned long long>(header_.stateHigh),
+                      static_cast<unsigned long long>(header_.stateLow));
+        return text;
+    }
+
+    /**
+     * Restore the captured state into a module instantiated from the
+     * stripped module (see stripInitialization)
+     *
+     * @param vmCtx VM holding the instance
+     * @param error Receives the failure (static text); the export is named in verbose output
+     * @return true on success
+     */
+    bool restore(WasmEdge_VMContext* vmCtx, std::string_view& error) const {
+        const WasmEdge_ModuleInstanceContext* instance = WasmEdge_VMGetActiveModule(vmCtx);
+        for (size_t i = 0; i < entries_.size() && instance; i++) {
+            const SnapshotEntry& entry = entries_[i];
+            WasmEdge_String name = wrapString(names_[i]);
+            bool restored = false;
+            if (entry.kind == SNAPSHOT_MEMORY) {
+                WasmEdge_MemoryInstanceContext* memory =
+                    WasmEdge_ModuleInstanceFindMemory(instance, name);
+                restored = memory && restoreMemory(memory, entry);
+            } else if (entry.kind == SNAPSHOT_GLOBAL) {
+                WasmEdge_GlobalInstanceContext* global =
+                    WasmEdge_ModuleInstanceFindGlobal(instance, name);
+                WasmEdge_Value value{};
+                std::memcpy(&value.Value, entry.value, sizeof(value.Value));
+                std::memcpy(&value.Type, entry.valueType, sizeof(value.Type));
+                restored = global
+                    && WasmEdge_ResultOK(WasmEdge_GlobalInstanceSetValue(global, value));
+            } else if (entry.kind == SNAPSHOT_TABLE) {
+                WasmEdge_TableInstanceContext* table =
+                    WasmEdge_ModuleInstanceFindTable(instance, name);
+                uint32_t current = table ? WasmEdge_TableInstanceGetSize(table) : 0;
+                uint32_t growth = static_cast<uint32_t>(entry.size - current);
+                restored = table && current <= entry.size
+                    && (current == entry.size
+                        || WasmEdge_ResultOK(WasmEdge_TableInstanceGrow(table, growth)));
+            }
+            if (!restored) {
+                printVerbose("Cannot restore snapshot export: ", names_[i]);
+                error = "Snapshot does not fit the module instance";
+                return false;
+            }
+        }
+        if (!instance) {
+            error = "No instantiated module";
+            return false;
+        }
+        return true;
+    }
+
+private:
+    /**
+     * Grow a memory to the captured size and fill it with the image
+     *
+     * @param memory Memory instance
+     * @param entry  Memory entry
+     * @return true on success
+     */
+    bool restoreMemory(WasmEdge_MemoryInstanceContext* memory, const SnapshotEntry& entry) const {
+        uint32_t current = WasmEdge_MemoryInstanceGetPageSize(memory);
+        uint32_t growth = static_cast<uint32_t>(entry.size - current);
+        if (current > entry.size
+            || (current < entry.size
+                && !WasmEdge_ResultOK(WasmEdge_MemoryInstanceGrowPage(memory, growth)))) {
+            return false;
+        }
+        uint64_t total = entry.size * WASM_PAGE_SIZE;
+        if (total == 0) {
+            return true;
+        }
+#if defined(__unix__) || defined(__APPLE__)
+        // One mapping over the whole memory, if WasmEdge reports it as one page-aligned block
+        uint8_t* base = WasmEdge_MemoryInstanceGetPointer(memory, 0, 1);
+        uint8_t* last =
+            WasmEdge_MemoryInstanceGetPointer(memory, static_cast<uint32_t>(total - 1), 1);
+        static const uintptr_t pageSize = static_cast<uintptr_t>(::sysconf(_SC_PAGESIZE));
+        if (g_useMmap && base && last == base + (total - 1)
+            && reinterpret_cast<uintptr_t>(base) % pageSize == 0) {
+            void* mapped = ::mmap(base, total, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd_,
+                                  static_cast<off_t>(entry.dataOffset));
+            if (mapped == base) {
+                return true;
+            }
+            printVerbose("Snapshot mapping failed, copying: ", std::strerror(errno));
+        }
+#endif
+        std::ifstream in(path_, std::ios::binary);
+        in.seekg(static_cast<std::streamoff>(entry.dataOffset));
+        for (uint64_t offset = 0; offset < total && in; offset += SNAPSHOT_CHUNK) {
+            uint32_t chunk = static_cast<uint32_t>(std::min(SNAPSHOT_CHUNK, total - offset));
+            uint8_t* bytes =
+                WasmEdge_MemoryInstanceGetPointer(memory, static_cast<uint32_t>(offset), chunk);
+            if (!bytes || !in.read(reinterpret_cast<char*>(bytes), chunk)) {
+                return false;
+            }
+        }
+        return static_cast<bool>(in);
+    }
+
+    std::string path_;
+#if defined(__unix__) || defined(__APPLE__)
+    int fd_ = -1;
+#endif
+    SnapshotHeader header_{};
+    std::vector<SnapshotEntry> entries_;
+    std::vector<std::string> names_;
+};
+
+/**
+ * Build a result record for a snapshot that could not be written or restored
+ *
+ * @param command  Command name
+ * @param filename Path to the .wasm file
+ * @param phase    "snapshot" or "restore"
+ * @param message  Static failure description
+ * @return Result record with EXIT_RUNTIME_ERROR
+ */
+ModuleResult makeSnapshotError(std::string_view command, const std::string& filename,
+                               std::string_view phase, std::string_view message) {
+    ModuleResult record = makeInputError(command, filename, message);
+    record.phase = phase;
+    record.exitCode = EXIT_RUNTIME_ERROR;
+    return record;
+}
+
+/**
+ * Get the snapshot named by --from-snapshot
+ *
+ * @return Snapshot (opened by loadSnapshot)
+ */
+Snapshot& loadedSnapshot() {
+    static Snapshot snapshot;
+    return snapshot;
+}
+
+/**
+ * Open the --from-snapshot file before any module is processed
+ *
+ * @param error Receives a message on failure
+ * @return true on success (or without --from-snapshot)
+ */
+bool loadSnapshot(std::string& error) {
+    return g_fromSnapshot.empty() || loadedSnapshot().open(g_fromSnapshot, error);
+}
+
+// ============================================================================
+// Verdict Cache - Content-addressed parse/validate/instantiate results
+// ============================================================================
+
+// Commands, statuses and phases a cached verdict can name. Slots store
+// indexes into these tables so restored records point at static strings.
+// Entries are only ever appended, so existing index files stay readable.
+constexpr std::string_view VERDICT_COMMANDS[] = {"PARSE", "VALIDATE", "INSTANTIATE", "CHECK-ALL"};
+constexpr std::string_view VERDICT_STATUSES[] = {
+    "SUCCESS", "FAILED", "VALID", "INVALID", "FAILED (Parse Error)", "READY",
+    "FAILED (Load Error)", "FAILED (Validation Error)", "FAILED (Instantiation Error)", "PASSED"};
+constexpr std::string_view VERDICT_PHASES[] = {"parse", "validate", "load", "instantiate"};
+
+constexpr uint32_t VERDICT_INDEX_MAGIC = 0x4356574D;  // "MWVC"
+constexpr uint32_t VERDICT_INDEX_VERSION = 1;
+constexpr uint32_t VERDICT_INDEX_SLOTS = 1u << 16;    // Power of two; 2 MiB of slots
+constexpr uint32_t VERDICT_MAX_PROBE = 32;            // Linear-probe window before eviction
+
+/**
+ * Look up a name in one of the verdict tables
+ *
+ * @param table Table to search
+ * @param name  Name to find
+ * @return Index, or -1 if the name is not in the table
+ */
+template <size_t N>
+int verdictIndexOf(const std::string_view (&table)[N], std::string_view name) {
+    for (size_t i = 0; i < N; i++) {
+        if (table[i] == name) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+/**
+ * Fixed-size header at the start of the index file
+ */
+struct VerdictIndexHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slotCount;
+    uint32_t slotSize;
+};
+
+/**
+ * One open-addressing slot of the index file. A slot is valid only when
+ * check matches its other fields, which lets readers detect empty slots
+ * and slots torn by a concurrent writer without taking a lock.
+ */
+struct VerdictSlot {
+    uint64_t keyHigh;
+    uint64_t keyLow;
+    uint32_t resultCode;  // Raw WasmEdge_Result of a failed verdict (category and code)
+    uint8_t command;      // Index into VERDICT_COMMANDS
+    uint8_t status;       // Index into VERDICT_STATUSES
+    uint8_t phase;        // Index into VERDICT_PHASES
+    uint8_t failed;       // 1 if the verdict is a WasmEdge error
+    uint64_t check;       // Checksum of the fields above (0 = empty)
+};
+static_assert(sizeof(VerdictSlot) == 32, "verdict slots are 32 bytes on disk");
+
+/**
+ * Checksum tying a slot's fields together (never 0)
+ *
+ * @param slot Slot to checksum
+ * @return Checksum value
+ */
+uint64_t verdictCheck(const VerdictSlot& slot) {
+    uint64_t packed = (static_cast<uint64_t>(slot.resultCode) << 32)
+                    | (static_cast<uint64_t>(slot.command) << 24)
+                    | (static_cast<uint64_t>(slot.status) << 16)
+                    | (static_cast<uint64_t>(slot.phase) << 8)
+                    | slot.failed;
+    uint64_t mix = slot.keyHigh ^ (slot.keyLow * 0x9E3779B185EBCA87ULL)
+                 ^ (packed * 0xC2B2AE3D27D4EB4FULL);
+    mix ^= mix >> 29;
+    return mix | 1;
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+
+/**
+ * On-disk verdict cache shared by concurrent processes.
+ *
+ * The index is a fixed-size open-addressing table of 32-byte slots in
+ * <cache>/verdicts.idx, mapped read-only with MAP_SHARED. Lookups read the
+ * mapping directly with no locks or syscalls. Writers take flock() (and a
+ * mutex for threads within one process) and pwrite() the slot; the mapping
+ * sees the write through the page cache. A key that finds no free slot in
+ * its probe window evicts the slot at its home position.
+ */
+class VerdictCache {
+public:
+    explicit VerdictCache(const fs::path& path) { open(path); }
+    ~VerdictCache() {
+        if (map_) ::munmap(const_cast<uint8_t*>(map_), mapSize_);
+        if (fd_ >= 0) ::close(fd_);
+    }
+
+    VerdictCache(const VerdictCache&) = delete;
+    VerdictCache& operator=(const VerdictCache&) = delete;
+
+    bool ready() const { return map_ != nullptr; }
+
+    /**
+     * Find the verdict for a key and command
+     *
+     * @param keyHigh First half of the key
+     * @param keyLow  Second half of the key
+     * @param command Index into VERDICT_COMMANDS
+     * @param found   Receives the slot
+     * @return true on a hit
+     */
+    bool lookup(uint64_t keyHigh, uint64_t keyLow, uint8_t command, VerdictSlot& found) const {
+        for (uint32_t probe = 0; probe < VERDICT_MAX_PROBE; probe++) {
+            std::memcpy(&found, slotAt(keyLow + probe), sizeof(found));
+            if (found.check == 0) {
+                return false;  // Empty slot ends the probe sequence
+            }
+            if (found.keyHigh == keyHigh && found.keyLow == keyLow && found.command == command
+                && found.check == verdictCheck(found)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Record a verdict (best effort: write failures leave the cache unchanged)
+     *
+     * @param slot Slot to store (check is filled in here)
+     */
+    void store(VerdictSlot slot) {
+        slot.check = verdictCheck(slot);
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        if (::flock(fd_, LOCK_EX) != 0) {
+            return;
+        }
+        uint64_t target = slot.keyLow;  // Evict the home slot if the window is full
+        for (uint32_t probe = 0; probe < VERDICT_MAX_PROBE; probe++) {
+            VerdictSlot existing;
+            std::memcpy(&existing, slotAt(slot.keyLow + probe), sizeof(existing));
+            if (existing.check == 0
+                || (existing.keyHigh == slot.keyHigh && existing.keyLow == slot.keyLow
+                    && existing.command == slot.command)) {
+                target = slot.keyLow + probe;
+                break;
+            }
+        }
+        uint64_t slotIndex = target & (VERDICT_INDEX_SLOTS - 1);
+        off_t offset = static_cast<off_t>(sizeof(VerdictIndexHeader)
+                                          + slotIndex * sizeof(VerdictSlot));
+        ssize_t written = ::pwrite(fd_, &slot, sizeof(slot), offset);
+        (void)written;  // A failed write only costs a future cache miss
+        ::flock(fd_, LOCK_UN);
+    }
+
+private:
+    static constexpr size_t INDEX_SIZE = sizeof(VerdictIndexHeader)
+                                       + size_t{VERDICT_INDEX_SLOTS} * sizeof(VerdictSlot);
+
+    const uint8_t* slotAt(uint64_t position) const {
+        return map_ + sizeof(VerdictIndexHeader)
+             + (position & (VERDICT_INDEX_SLOTS - 1)) * sizeof(VerdictSlot);
+    }
+
+    /**
+     * Open and map the index file. A missing, foreign or outdated index is
+     * replaced by an empty one built in a temporary file and renamed into
+     * place: other processes may still have the old file mapped, and
+     * truncating it under them would fault their next lookup (SIGBUS).
+     */
+    void open(const fs::path& path) {
+        std::error_code ec;
+        fs::create_directories(path.parent_path(), ec);
+
+        VerdictIndexHeader expected {VERDICT_INDEX_MAGIC, VERDICT_INDEX_VERSION,
+                                     VERDICT_INDEX_SLOTS, sizeof(VerdictSlot)};
+        for (int attempt = 0; attempt < 2; attempt++) {
+            fd_ = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+            if (fd_ >= 0 && headerMatches(expected)) {
+                break;
+            }
+            if (fd_ >= 0) {
+                ::close(fd_);
+                fd_ = -1;
+            }
+            if (!publishEmptyIndex(path.string(), expected)) {
+                return;
+            }
+        }
+        if (fd_ < 0) {
+            return;
+        }
+
+        void* addr = ::mmap(nullptr, INDEX_SIZE, PROT_READ, MAP_SHARED, fd_, 0);
+        if (addr == MAP_FAILED) {
+            return;
+        }
+        map_ = static_cast<const uint8_t*>(addr);
+        mapSize_ = INDEX_SIZE;
+    }
+
+    /**
+     * Write an empty index to a temporary file and rename it over path.
+     * Concurrent rebuilders each publish a complete file; the last rename
+     * wins and stores made to a replaced file are lost, which only costs
+     * cache misses.
+     *
+     * @param path     Index path
+     * @param expected Header of the new index
+     * @return true if the new index was published
+     */
+    static bool publishEmptyIndex(const std::string& path, const VerdictIndexHeader& expected) {
+        std::string tmpPath = temporaryPathFor(path);
+        int fd = ::open(tmpPath.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            return false;
+        }
+        bool written = ::ftruncate(fd, static_cast<off_t>(INDEX_SIZE)) == 0
+                    && ::pwrite(fd, &expected, sizeof(expected), 0) == sizeof(expected);
+        ::close(fd);
+        if (!written) {
+            ::unlink(tmpPath.c_str());
+            return false;
+        }
+        return publishTemporary(tmpPath, path);
+    }
+
+    bool headerMatches(const VerdictIndexHeader& expected) const {
+        struct stat info {};
+        VerdictIndexHeader header {};
+        return ::fstat(fd_, &info) == 0
+            && static_cast<size_t>(info.st_size) == INDEX_SIZE
+            && ::pread(fd_, &header, sizeof(header), 0) == sizeof(header)
+            && std::memcmp(&header, &expected, sizeof(header)) == 0;
+    }
+
+    int fd_ = -1;
+    const uint8_t* map_ = nullptr;
+    size_t mapSize_ = 0;
+    std::mutex writeMutex_;
+};
+
+#else
+
+// Without POSIX mmap/flock the verdict cache is unavailable
+class VerdictCache {
+public:
+    explicit VerdictCache(const fs::path&) {}
+    bool ready() const { return false; }
+    bool lookup(uint64_t, uint64_t, uint8_t, VerdictSlot&) const { return false; }
+    void store(VerdictSlot) {}
+};
+
+#endif
+
+/**
+ * Process-wide verdict cache, opened on first use
+ *
+ * @return Verdict cache, or nullptr when --verdict-cache is off or the
+ *         index cannot be opened
+ */
+VerdictCache* verdictCache() {
+    if (!g_useVerdictCache || !g_snapshotOut.empty()) {
+        return nullptr;  // A hit would skip writing the --snapshot file
+    }
+    static VerdictCache cache(cacheRoot() / "verdicts.idx");
+    return cache.ready() ? &cache : nullptr;
+}
+
+/**
+ * Describe the configure options that can change a verdict
+ *
+ * @return Fingerprint text folded into verdict keys
+ */
+const std::string& configFingerprint() {
+    static const std::string fingerprint = [] {
+        std::string text = proposalFingerprint() + "|aot-cache=" + (g_useAotCache ? "1" : "0");
+        // Start functions see the WASI arguments, environment and preopens
+        text += g_wasi ? "|wasi=1" : "|wasi=0";
+        for (const std::vector<std::string>* list :
+             {&g_wasiArgs, &g_wasiEnvs, &g_wasiDirs, &g_plugins}) {
+            text += "|";
+            for (const std::string& item : *list) {
+                text += item;
+                text += '\0';
+            }
+        }
+        // Imports resolve against the linked libraries' names and contents
+        text += "|link=";
+        for (const LinkedLibrary& library : linkedLibraries()) {
+            text += library.name;
+            text += '\0';
+            text += library.digest;
+            text += '\0';
+        }
+        // Restored instances start from the captured state instead of running initialization
+        if (!g_fromSnapshot.empty()) {
+            text += "|from-snapshot=" + loadedSnapshot().stateDigest();
+        }
+        // A lazy verdict over some bodies says nothing about the others
+        if (!g_lazyFunctionList.empty()) {
+            text += "|lazy-functions=" + g_lazyFunctionList;
+        }
+        return text;
+    }();
+    return fingerprint;
+}
+
+/**
+ * Run a handler through the verdict cache.
+ *
+ * The key is the 128-bit digest of the module bytes, WasmEdge_VersionGet()
+ * and configFingerprint(). A hit rebuilds the record without creating any
+ * WasmEdge context. On a miss the mapping made for hashing is handed to the
+ * handler, so the module is only mapped once. Only WasmEdge verdicts are
+ * stored; unreadable inputs and context failures are never cached.
+ *
+ * @param session  Session owning the reusable contexts
+ * @param handler  Per-module handler
+ * @param command  Command name
+ * @param filename Path to the .wasm file
+ * @return Result record for the module
+ */
+ModuleResult runWithVerdictCache(Session& session, ModuleHandler handler,
+                                 std::string_view command, const std::string& filename) {
+    int commandIndex = verdictIndexOf(VERDICT_COMMANDS, command);
+    VerdictCache* cache = commandIndex >= 0 ? verdictCache() : nullptr;
+    if (!cache) {
+        return handler(session, filename);
+    }
+
+    MappedModule module;
+    uint64_t keyHigh = 0;
+    uint64_t keyLow = 0;
+    VerdictSlot slot {};
+    bool hit = false;
+    {
+        PhaseTimer timer(session.phases(), "cache_lookup");
+        if (!session.openModule(module, filename)) {
+            timer.stop();
+            return handler(session, filename);  // Let the handler report the read error
+        }
+        ContentHasher hasher;
+        hasher.update(module.data(), module.size());
+        std::string_view version = WasmEdge_VersionGet();
+        const std::string& fingerprint = configFingerprint();
+        hasher.update(version.data(), version.size());
+        hasher.update("\0", 1);
+        hasher.update(fingerprint.data(), fingerprint.size());
+        hasher.digest(keyHigh, keyLow);
+        hit = cache->lookup(keyHigh, keyLow, static_cast<uint8_t>(commandIndex), slot)
+            && slot.status < std::size(VERDICT_STATUSES) && slot.phase < std::size(VERDICT_PHASES);
+    }
+
+    if (hit) {
+        printVerbose("Verdict cache hit: ", filename);
+        ModuleResult record = makeSuccess(command, filename, VERDICT_STATUSES[slot.status]);
+        record.phase = VERDICT_PHASES[slot.phase];
+        if (slot.failed) {
+            record.errorKind = ErrorKind::WasmEdge;
+            record.result = WasmEdge_Result{slot.resultCode};
+            record.exitCode = EXIT_RUNTIME_ERROR;
+        }
+        record.cached = true;
+        return record;
+    }
+
+    // Miss: reuse the mapping unless modules are being loaded from files
+    ModuleResult record;
+    {
+        InlineModuleScope shared(session, module);
+        record = handler(session, filename);
+    }
+
+    int status = verdictIndexOf(VERDICT_STATUSES, record.status);
+    int phase = verdictIndexOf(VERDICT_PHASES, record.phase);
+    if ((record.errorKind == ErrorKind::None || record.errorKind == ErrorKind::WasmEdge)
+        && status >= 0 && phase >= 0) {
+        slot.keyHigh = keyHigh;
+        slot.keyLow = keyLow;
+        slot.command = static_cast<uint8_t>(commandIndex);
+        slot.status = static_cast<uint8_t>(status);
+        slot.phase = static_cast<uint8_t>(phase);
+        slot.failed = record.errorKind == ErrorKind::WasmEdge ? 1 : 0;
+        slot.resultCode = slot.failed ? record.result.Code : 0;
+        cache->store(slot);
+    }
+    return record;
+}
+
+// ============================================================================
+// Sub-command Implementations
+// ============================================================================
+
+/**
+ * Parse sub-command implementation using WasmEdge C API
+ * 
+ * Demonstrates: Parser context lifecycle, AST module creation
+ * Uses RAII wrappers for automatic resource cleanup.
+ * 
+ * @param session  Session owning the reusable parser context
+ * @param filename Path to the .wasm file to parse
+ * @return Result record (EXIT_OK or EXIT_RUNTIME_ERROR)
+ */
+ModuleResult cmdParse(Session& session, const std::string& filename) {
+    printVerbose("Processing file: ", filename);
+    TeardownTimer teardown(session.phases());
+    
+    // Step 1: Get the parser context (created once per session)
+    WasmEdge_ParserContext* parserCtx = session.parser();
+    if (!parserCtx) {
+        return makeContextError("PARSE", filename, "parser context");
+    }
+
+    // Step 2: Parse the WebAssembly file
+    printVerbose("Parsing WebAssembly module...");
+    ASTModulePtr astModuleCtx;
+    TeardownStart teardownStart(teardown);
+    bool readError = false;
+    WasmEdge_Result result;
+    {
+        PhaseTimer timer(session.phases(), "parse");
+        result = parseModuleFile(session, parserCtx, filename, astModuleCtx, readError);
+    }
+
+    if (readError) {
+        return makeInputError("PARSE", filename, "Cannot read file");
+    }
+    if (!WasmEdge_ResultOK(result)) {
+        return makeWasmEdgeError("PARSE", filename, "parse", "FAILED", result);
+    }
+
+    // Success
+    printVerbose("Parse completed successfully.");
+    return makeSuccess("PARSE", filename, "SUCCESS");
+    // RAII: astModuleCtx automatically cleaned up
+}
+
+/**
+ * Validate sub-command implementation using WasmEdge C API
+ * 
+ * Pipeline: Parse -> Validate
+ * Demonstrates: Multi-context lifecycle, semantic validation
+ * Uses RAII wrappers for automatic resource cleanup.
+ * 
+ * @param session  Session owning the reusable parser and validator contexts
+ * @param filename Path to the .wasm file to validate
+ * @return Result record (EXIT_OK or EXIT_RUNTIME_ERROR)
+ */
+ModuleResult cmdValidate(Session& session, const std::string& filename) {
+    printVerbose("Processing file: ", filename);
+    TeardownTimer teardown(session.phases());
+    
+    // Step 1: Get the parser context (created once per session)
+    WasmEdge_ParserContext* parserCtx = session.parser();
+    if (!parserCtx) {
+        return makeContextError("VALIDATE", filename, "parser context");
+    }
+
+    // Step 2: Parse the WebAssembly file
+    printVerbose("Parsing WebAssembly module...");
+    ASTModulePtr astModuleCtx;
+    TeardownStart teardownStart(teardown);
+    bool readError = false;
+    WasmEdge_Result result;
+    {
+        PhaseTimer timer(session.phases(), "parse");
+        result = parseModuleFile(session, parserCtx, filename, astModuleCtx, readError);
+    }
+
+    if (readError) {
+        return makeInputError("VALIDATE", filename, "Cannot read file");
+    }
+    if (!WasmEdge_ResultOK(result)) {
+        return makeWasmEdgeError("VALIDATE", filename, "parse", "FAILED (Parse Error)", result);
+    }
+
+    // Step 3: Get the validator context (created once per session)
+    WasmEdge_ValidatorContext* validatorCtx = session.validator();
+    if (!validatorCtx) {
+        return makeContextError("VALIDATE", filename, "validator context");
+    }
+
+    // Step 4: Validate the AST module
+    printVerbose("Validating WebAssembly module...");
+    {
+        PhaseTimer timer(session.phases(), "validate");
+        result = WasmEdge_ValidatorValidate(validatorCtx, astModuleCtx.get());
+    }
+
+    if (!WasmEdge_ResultOK(result)) {
+        return makeWasmEdgeError("VALIDATE", filename, "validate", "INVALID", result);
+    }
+
+    // Success
+    printVerbose("Validation completed successfully.");
+    return makeSuccess("VALIDATE", filename, "VALID");
+    // RAII: astModuleCtx automatically cleaned up
+}
+
+// ============================================================================
+// Lazy Validation - Function bodies checked in parallel chunks (--lazy)
+// ============================================================================
+
+constexpr std::string_view STUB_BODY("\x03\x00\x00\x0B", 4);  // Size 3: no locals, unreachable, end
+constexpr size_t LAZY_CHUNKS_PER_THREAD = 4;                   // Per body thread, for load balance
+
+/**
+ * A module split around its code section. Any module with every body
+ * replaced by STUB_BODY (valid for every function type) checks everything
+ * but the bodies; putting some real bodies back checks just those, because
+ * a body's validity depends only on the module around it.
+ */
+struct LazyModule {
+    std::string_view prefix;                 // Header and sections before the code section
+    std::string_view suffix;                 // Sections after the code section
+    std::string chunkPrefix;                 // prefix without custom sections
+    std::string chunkSuffix;                 // suffix without custom sections or segment bytes
+    std::vector<std::string_view> bodies;    // Body bytes, size prefix included
+    bool hasCode = false;
+};
+
+/**
+ * Copy a data section with every segment's bytes removed. Segment kinds,
+ * memories and offsets are kept, so the segment count and every data index
+ * a body uses stay valid.
+ *
+ * @param p       Section payload
+ * @param end     End of the payload
+ * @param section Receives the new payload
+ * @return false if the section cannot be decoded
+ */
+bool emptyDataSegments(const uint8_t* p, const uint8_t* end, std::string& section) {
+    uint32_t count = 0;
+    size_t length = 0;
+    if (!readVarU32(p, end, count, length)) {
+        return false;
+    }
+    section.append(reinterpret_cast<const char*>(p), length);
+    p += length;
+    for (uint32_t i = 0; i < count; i++) {
+        const uint8_t* segment = p;
+        uint32_t value = 0;
+        if (!readVarU32(p, end, value, length) || value > 2) {
+            return false;
+        }
+        uint32_t flags = value;
+        p += length;
+        if (flags == 2) {
+            if (!readVarU32(p, end, value, length)) {
+                return false;
+            }
+            p += length;
+        }
+        if (flags != 1) {
+            p = skipConstExpr(p, end);
+        }
+        uint32_t byteCount = 0;
+        if (!p || !readVarU32(p, end, byteCount, length)
+            || byteCount > static_cast<uint64_t>(end - p) - length) {
+            return false;
+        }
+        section.append(reinterpret_cast<const char*>(segment), static_cast<size_t>(p - segment));
+        section.push_back('\0');
+        p += length + byteCount;
+    }
+    return true;
+}
+
+/**
+ * Split a scanned module around its code section
+ *
+ * @param data  Module bytes (already scanned)
+ * @param size  Module size
+ * @param spans Section layout from scanModule
+ * @param split Receives the split module (views into data)
+ * @return false if the code or data section cannot be decoded
+ */
+bool splitLazyModule(const uint8_t* data, size_t size, const std::vector<SectionSpan>& spans,
+                     LazyModule& split) {
+    constexpr uint8_t CUSTOM_SECTION = 0;
+    constexpr uint8_t CODE_SECTION = 10;
+    constexpr uint8_t DATA_SECTION = 11;
+    const char* text = reinterpret_cast<const char*>(data);
+    auto code = std::find_if(spans.begin(), spans.end(),
+                             [](const SectionSpan& span) { return span.id == CODE_SECTION; });
+    split.hasCode = code != spans.end();
+    size_t codeStart = split.hasCode ? code->headerOffset : size;
+    size_t codeEnd = split.hasCode ? code->offset + code->size : size;
+    split.prefix = std::string_view(text, codeStart);
+    split.suffix = std::string_view(text + codeEnd, size - codeEnd);
+    split.chunkPrefix.assign(text, 8);  // Magic and version
+
+    for (const SectionSpan& span : spans) {
+        std::string& out = span.headerOffset < codeStart ? split.chunkPrefix : split.chunkSuffix;
+        if (span.id == CUSTOM_SECTION || span.id == CODE_SECTION) {
+            continue;
+        }
+        if (span.id != DATA_SECTION) {
+            out.append(text + span.headerOffset, span.offset + span.size - span.headerOffset);
+            continue;
+        }
+        std::string section;
+        if (!emptyDataSegments(data + span.offset, data + span.offset + span.size, section)) {
+            return false;
+        }
+        appendSectionHeader(out, DATA_SECTION, section.size());
+        out += section;
+    }
+
+    if (split.hasCode) {
+        const uint8_t* p = data + code->offset;
+        const uint8_t* end = p + code->size;
+        uint32_t count = 0;
+        size_t length = 0;
+        if (!readVarU32(p, end, count, length)) {
+            return false;
+        }
+        p += length;
+        split.bodies.reserve(count);
+        for (uint32_t i = 0; i < count; i++) {
+            uint32_t bodySize = 0;
+            if (!readVarU32(p, end, bodySize, length)
+                || bodySize > static_cast<uint64_t>(end - p) - length) {
+                return false;
+            }
+            split.bodies.emplace_back(reinterpret_cast<const char*>(p), length + bodySize);
+            p += length + bodySize;
+        }
+    }
+    return true;
+}
+
+/**
+ * Assemble a module from a split: stub bodies except for the real ones
+ *
+ * @param split    Split module
+ * @param chunk    true for a chunk module (no custom sections, empty data segments)
+ * @param selected Defined function indices whose bodies are real, ascending
+ * @param count    Number of selected indices
+ * @param out      Receives the module bytes
+ */
+void buildLazyModule(const LazyModule& split, bool chunk, const uint32_t* selected, size_t count,
+                     std::string& out) {
+    out.clear();
+    out += chunk ? std::string_view(split.chunkPrefix) : split.prefix;
+    if (split.hasCode) {
+        std::string section;
+        section.reserve(STUB_BODY.size() * split.bodies.size());
+        appendVarU32(section, split.bodies.size());
+        const uint32_t* real = selected;
+        const uint32_t* realEnd = selected + count;
+        for (size_t i = 0; i < split.bodies.size(); i++) {
+            if (real != realEnd && *real == i) {
+                section += split.bodies[i];
+                real++;
+            } else {
+                section += STUB_BODY;
+            }
+        }
+        appendSectionHeader(out, 10, section.size());
+        out += section;
+    }
+    out += chunk ? std::string_view(split.chunkSuffix) : split.suffix;
+}
+
+/**
+ * Parse and validate assembled module bytes
+ *
+ * @param parserCtx    Parser context
+ * @param validatorCtx Validator context
+ * @param bytes        Module bytes
+ * @param parseFailed  Receives true if the parser rejected the bytes
+ * @return WasmEdge result of the failing step, or success
+ */
+WasmEdge_Result checkLazyModule(WasmEdge_ParserContext* parserCtx,
+                                WasmEdge_ValidatorContext* validatorCtx,
+                                std::string_view bytes, bool& parseFailed) {
+    WasmEdge_ASTModuleContext* rawAstModule = nullptr;
+    WasmEdge_Result result = WasmEdge_ParserParseFromBytes(
+        parserCtx, &rawAstModule,
+        WasmEdge_BytesWrap(reinterpret_cast<const uint8_t*>(bytes.data()),
+                           static_cast<uint32_t>(bytes.size())));
+    ASTModulePtr astModule(rawAstModule);
+    parseFailed = !WasmEdge_ResultOK(result);
+    if (parseFailed) {
+        return result;
+    }
+    return WasmEdge_ValidatorValidate(validatorCtx, astModule.get());
+}
+
+/**
+ * Report of a lazy validation, as text lines or a JSON object
+ *
+ * @param selected Bodies selected for checking
+ * @param bodies   Bodies in the module
+ * @param chunks   Chunk modules checked
+ * @param threads  Threads that checked them
+ * @param headerNs Time until everything but the bodies was validated
+ * @param function Failing function index (counting imports), or -1
+ * @param offset   File offset of the failing body
+ * @return Command report for ModuleResult::extra
+ */
+std::string renderLazyReport(size_t selected, size_t bodies, size_t chunks, size_t threads,
+                             uint64_t headerNs, int64_t function, uint64_t offset) {
+    if (g_format == OutputFormat::Text) {
+        std::string out = "Bodies : " + std::to_string(selected) + " of " + std::to_string(bodies)
+                        + " in " + std::to_string(chunks) + " chunk(s) on "
+                        + std::to_string(threads) + " thread(s)\n"
+                        + "Header : valid after " + formatDurationNs(static_cast<double>(headerNs))
+                        + "\n";
+        if (function >= 0) {
+            out += "Body   : function " + std::to_string(function) + " at offset "
+                 + std::to_string(offset) + "\n";
+        }
+        return out;
+    }
+    return "{\"bodies\":" + std::to_string(bodies) + ",\"selected\":" + std::to_string(selected)
+         + ",\"chunks\":" + std::to_string(chunks) + ",\"threads\":" + std::to_string(threads)
+         + ",\"header_ns\":" + std::to_string(headerNs)
+         + ",\"function\":" + (function >= 0 ? std::to_string(function) : std::string("null"))
+         + (function >= 0 ? ",\"offset\":" + std::to_string(offset) : std::string()) + "}";
+}
+
+/**
+ * Validate sub-command with --lazy.
+ *
+ * Pipeline: Split -> Parse + Validate the stubbed module -> Check bodies.
+ * The module with every body stubbed out is validated first, so a broken
+ * header, import, export or segment is reported without reading the code.
+ * The bodies (all, or the --lazy-functions ones) are then checked in chunk
+ * modules on g_bodyThreads threads, each with its own parser and validator
+ * contexts. Chunks are claimed in order and a thread stops once an earlier
+ * chunk has failed, so the first failing chunk always gets checked; it is
+ * then bisected to name the first invalid function.
+ *
+ * @param session  Session owning the reusable parser and validator contexts
+ * @param filename Path to the .wasm file to validate
+ * @return Result record (EXIT_OK or EXIT_RUNTIME_ERROR)
+ */
+ModuleResult cmdValidateLazy(Session& session, const std::string& filename) {
+    printVerbose("Processing file: ", filename);
+    auto start = std::chrono::steady_clock::now();
+    TeardownTimer teardown(session.phases());
+
+    MappedModule module;
+    if (!session.openModule(module, filename)) {
+        return makeInputError("VALIDATE", filename, "Cannot read file");
+    }
+    LazyModule split;
+    std::string bytes;
+    {
+        PhaseTimer timer(session.phases(), "split");
+        std::vector<SectionSpan> spans;
+        ScanResult scan = scanModule(module.data(), module.size(), &spans);
+        if (!scan.ok) {
+            return makeScanError("VALIDATE", filename, scan);
+        }
+        if (!splitLazyModule(module.data(), module.size(), spans, split)) {
+            return makeInputError("VALIDATE", filename, "Cannot decode the code or data section");
+        }
+        buildLazyModule(split, false, nullptr, 0, bytes);
+    }
+
+    // Step 1: Everything but the bodies, on the session's contexts
+    WasmEdge_ParserContext* parserCtx = session.parser();
+    if (!parserCtx) {
+        return makeContextError("VALIDATE", filename, "parser context");
+    }
+    WasmEdge_ValidatorContext* validatorCtx = session.validator();
+    if (!validatorCtx) {
+        return makeContextError("VALIDATE", filename, "validator context");
+    }
+    printVerbose("Validating the module with stub bodies...");
+    TeardownStart teardownStart(teardown);
+    ASTModulePtr astModule;
+    WasmEdge_Result result;
+    {
+        PhaseTimer timer(session.phases(), "parse");
+        WasmEdge_ASTModuleContext* rawAstModule = nullptr;
+        result = WasmEdge_ParserParseFromBytes(
+            parserCtx, &rawAstModule,
+            WasmEdge_BytesWrap(reinterpret_cast<const uint8_t*>(bytes.data()),
+                               static_cast<uint32_t>(bytes.size())));
+        astModule.reset(rawAstModule);
+    }
+    if (!WasmEdge_ResultOK(result)) {
+        return makeWasmEdgeError("VALIDATE", filename, "parse", "FAILED (Parse Error)", result);
+    }
+    {
+        PhaseTimer timer(session.phases(), "validate");
+        result = WasmEdge_ValidatorValidate(validatorCtx, astModule.get());
+    }
+    if (!WasmEdge_ResultOK(result)) {
+        return makeWasmEdgeError("VALIDATE", filename, "validate", "INVALID", result);
+    }
+    uint64_t headerNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+
+    // Function indices count imports; only defined functions have bodies
+    uint32_t imported = 0;
+    std::vector<const WasmEdge_ImportTypeContext*> imports(
+        WasmEdge_ASTModuleListImportsLength(astModule.get()));
+    WasmEdge_ASTModuleListImports(astModule.get(), imports.data(),
+                                  static_cast<uint32_t>(imports.size()));
+    for (const WasmEdge_ImportTypeContext* entry : imports) {
+        imported += WasmEdge_ImportTypeGetExternalType(entry) == WasmEdge_ExternalType_Function;
+    }
+    astModule.reset();
+    std::vector<uint32_t> selected;
+    if (g_lazyFunctions.empty()) {
+        selected.resize(split.bodies.size());
+        std::iota(selected.begin(), selected.end(), 0u);
+    } else {
+        for (auto [low, high] : g_lazyFunctions) {
+            if (uint64_t{high} >= uint64_t{imported} + split.bodies.size()) {
+                return makeInputError("VALIDATE", filename,
+                                      "A '--lazy-functions' index is past the last function");
+            }
+            for (uint64_t index = std::max(low, imported); index <= high; index++) {
+                selected.push_back(static_cast<uint32_t>(index - imported));
+            }
+        }
+        std::sort(selected.begin(), selected.end());
+        selected.erase(std::unique(selected.begin(), selected.end()), selected.end());
+    }
+    printVerbose("Module valid apart from its bodies after ",
+                 formatDurationNs(static_cast<double>(headerNs)), "; checking ", selected.size(),
+                 " of ", split.bodies.size(), " bodies");
+
+    // Step 2: Chunks of about equal body bytes, claimed in order by the threads
+    std::vector<std::pair<size_t, size_t>> chunks;  // Ranges of selected
+    size_t threads = std::max<size_t>(1, std::min(g_bodyThreads, selected.size()));
+    uint64_t total = 0;
+    for (uint32_t index : selected) total += split.bodies[index].size();
+    uint64_t target = std::max<uint64_t>(1, total / (threads * LAZY_CHUNKS_PER_THREAD));
+    for (size_t begin = 0, i = 0; i < selected.size();) {
+        uint64_t bytesInChunk = 0;
+        while (i < selected.size() && (bytesInChunk < target || threads == 1)) {
+            bytesInChunk += split.bodies[selected[i++]].size();
+        }
+        chunks.emplace_back(begin, i);
+        begin = i;
+    }
+    threads = std::min(threads, chunks.size());
+
+    const size_t NO_FAILURE = SIZE_MAX;
+    std::atomic<size_t> nextChunk{0};
+    std::atomic<size_t> failedChunk{NO_FAILURE};
+    std::atomic<bool> contextFailed{false};
+    std::mutex failureMutex;
+    auto checkChunks = [&](WasmEdge_ParserContext* parser, WasmEdge_ValidatorContext* validator) {
+        std::string chunkBytes;
+        for (size_t chunk; (chunk = nextChunk.fetch_add(1)) < chunks.size();) {
+            if (chunk > failedChunk.load()) {
+                break;  // An earlier chunk already decides the verdict
+            }
+            auto [begin, end] = chunks[chunk];
+            buildLazyModule(split, true, selected.data() + begin, end - begin, chunkBytes);
+            bool parseFailed = false;
+            if (!WasmEdge_ResultOK(checkLazyModule(parser, validator, chunkBytes, parseFailed))) {
+                std::lock_guard<std::mutex> lock(failureMutex);
+                if (chunk < failedChunk.load()) failedChunk.store(chunk);
+            }
+        }
+    };
+    {
+        PhaseTimer timer(session.phases(), "bodies");
+        std::vector<std::thread> workers;
+        for (size_t t = 1; t < threads; t++) {
+            workers.emplace_back([&] {
+                ParserPtr parser(WasmEdge_ParserCreate(toolConfig()));
+                ValidatorPtr validator(WasmEdge_ValidatorCreate(toolConfig()));
+                if (!parser || !validator) {
+                    contextFailed.store(true);
+                    return;
+                }
+                checkChunks(parser.get(), validator.get());
+            });
+        }
+        checkChunks(parserCtx, validatorCtx);
+        for (std::thread& worker : workers) worker.join();
+    }
+    if (contextFailed.load() && failedChunk.load() == NO_FAILURE) {
+        return makeContextError("VALIDATE", filename, "body validation contexts");
+    }
+
+    if (failedChunk.load() == NO_FAILURE) {
+        printVerbose("Validation completed successfully.");
+        ModuleResult record = makeSuccess("VALIDATE", filename, "VALID");
+        record.extra = renderLazyReport(selected.size(), split.bodies.size(), chunks.size(),
+                                        threads, headerNs, -1, 0);
+        return record;
+    }
+
+    // Step 3: Bisect the failing chunk down to its first invalid body
+    bool parseFailed = false;
+    {
+        PhaseTimer timer(session.phases(), "bisect");
+        auto [begin, end] = chunks[failedChunk.load()];
+        while (end - begin > 1) {
+            size_t middle = begin + (end - begin) / 2;
+            buildLazyModule(split, true, selected.data() + begin, middle - begin, bytes);
+            bool failed =
+                !WasmEdge_ResultOK(checkLazyModule(parserCtx, validatorCtx, bytes, parseFailed));
+            (failed ? end : begin) = middle;
+        }
+        buildLazyModule(split, true, selected.data() + begin, 1, bytes);
+        result = checkLazyModule(parserCtx, validatorCtx, bytes, parseFailed);
+        chunks[failedChunk.load()] = {begin, end};
+    }
+    uint32_t failing = selected[chunks[failedChunk.load()].first];
+    ModuleResult record = parseFailed
+        ? makeWasmEdgeError("VALIDATE", filename, "parse", "FAILED (Parse Error)", result)
+        : makeWasmEdgeError("VALIDATE", filename, "validate", "INVALID", result);
+    uint64_t failingOffset = static_cast<uint64_t>(
+        split.bodies[failing].data() - reinterpret_cast<const char*>(module.data()));
+    record.extra = renderLazyReport(selected.size(), split.bodies.size(), chunks.size(), threads,
+                                    headerNs, int64_t{imported} + failing, failingOffset);
+    return record;
+}
+
+/**
+ * A module ready to be loaded into VMs: its cached AOT artifact, or its AST
+ * when there is none. Preparing once and loading many times lets one parse
+ * serve several instances.
+ */
+struct PreparedModule {
+    std::string artifact;  // Cached AOT artifact path (empty = load ast)
+    ASTModulePtr ast;      // Parsed module, set when there is no artifact
+};
+
+/**
+ * Parse the stripped form of a module for a --from-snapshot restore (no
+ * data segment copies, no start function). Cached AOT artifacts are of the
+ * original module, so they are not used.
+ *
+ * @param session  Session supplying the parser and any inline module
+ * @param command  Command name used in result records
+ * @param filename Path to the .wasm file
+ * @param prepared Receives the AST
+ * @param failure  Receives the error record on failure
+ * @return true on success
+ */
+bool prepareFromSnapshot(Session& session, std::string_view command, const std::string& filename,
+                         PreparedModule& prepared, ModuleResult& failure) {
+    MappedModule module;
+    if (!session.openModule(module, filename)) {
+        failure = makeInputError(command, filename, "Cannot read file");
+        return false;
+    }
+    if (!loadedSnapshot().matches(module)) {
+        failure = makeInputError(command, filename, "Snapshot was taken from a different module");
+        return false;
+    }
+    std::vector<SectionSpan> spans;
+    std::string stripped;
+    {
+        PhaseTimer timer(session.phases(), "strip");
+        ScanResult scan = scanModule(module.data(), module.size(), &spans);
+        if (!scan.ok) {
+            failure = makeScanError(command, filename, scan);
+            return false;
+        }
+        if (!stripInitialization(module.data(), spans, stripped)) {
+            failure = makeInputError(command, filename, "Cannot decode the data section");
+            return false;
+        }
+    }
+
+    WasmEdge_ParserContext* parserCtx = session.parser();
+    if (!parserCtx) {
+        failure = makeContextError(command, filename, "parser context");
+        return false;
+    }
+    WasmEdge_Result result;
+    {
+        PhaseTimer timer(session.phases(), "parse");
+        WasmEdge_ASTModuleContext* rawAstModule = nullptr;
+        result = WasmEdge_ParserParseFromBytes(
+            parserCtx, &rawAstModule,
+            WasmEdge_BytesWrap(reinterpret_cast<const uint8_t*>(stripped.data()),
+                               static_cast<uint32_t>(stripped.size())));
+        prepared.ast.reset(rawAstModule);
+    }
+    if (!WasmEdge_ResultOK(result)) {
+        failure = makeWasmEdgeError(command, filename, "parse", "FAILED (Load Error)", result);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Find the module's cached AOT artifact, or parse it with the session's
+ * parser (or its stripped form with --from-snapshot)
+ *
+ * @param session  Session supplying the parser and any inline module
+ * @param command  Command name used in result records
+ * @param filename Path to the .wasm file
+ * @param prepared Receives the artifact path or the AST
+ * @param failure  Receives the error record on failure
+ * @return true on success
+ */
+bool prepareModule(Session& session, std::string_view command, const std::string& filename,
+                   PreparedModule& prepared, ModuleResult& failure) {
+    if (!g_fromSnapshot.empty()) {
+        return prepareFromSnapshot(session, command, filename, prepared, failure);
+    }
+    std::vector<PhaseSample>& phases = session.phases();
+    MappedModule module;  // Mapped for the artifact key and reused by the parse
+    if (g_useAotCache) {
+        if (!session.openModule(module, filename)) {
+            failure = makeInputError(command, filename, "Cannot read file");
+            return false;
+        }
+        prepared.artifact = findAotArtifact(module);
+        if (!prepared.artifact.empty()) {
+            return true;
+        }
+    }
+
+    WasmEdge_ParserContext* parserCtx = session.parser();
+    if (!parserCtx) {
+        failure = makeContextError(command, filename, "parser context");
+        return false;
+    }
+    bool readError = false;
+    WasmEdge_Result result;
+    {
+        InlineModuleScope shared(session, module);
+        PhaseTimer timer(phases, "parse");
+        result = parseModuleFile(session, parserCtx, filename, prepared.ast, readError);
+    }
+    if (readError) {
+        failure = makeInputError(command, filename, "Cannot read file");
+        return false;
+    }
+    if (!WasmEdge_ResultOK(result)) {
+        failure = makeWasmEdgeError(command, filename, "parse", "FAILED (Load Error)", result);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Shared instantiate pipeline: Link -> Load -> Validate -> Instantiate into
+ * a VM.
+ * Prefers a cached AOT artifact for the module when one exists. Otherwise
+ * the module is parsed once with the session's parser and the resulting
+ * AST is handed to the VM with WasmEdge_VMLoadWasmFromASTModule, so the
+ * VM never re-reads or re-parses the bytes.
+ * 
+ * @param session  Session supplying the parser and any inline module, and
+ *                 collecting phases
+ * @param vmCtx    VM context to load the module into
+ * @param command  Command name used in result records
+ * @param filename Path to the .wasm file
+ * @param prepared Module prepared by the caller (nullptr = prepare it here)
+ * @return Result record (status READY on success)
+ */
+ModuleResult loadAndInstantiate(Session& session, WasmEdge_VMContext* vmCtx,
+                                std::string_view command, const std::string& filename,
+                                const PreparedModule* prepared = nullptr) {
+    std::vector<PhaseSample>& phases = session.phases();
+    WasmEdge_Result result = WasmEdge_Result_Success;
+
+    // Step 0: Register the --link libraries the module may import from
+    std::string_view failedLibrary;
+    if (!session.linkModules(vmCtx, result, failedLibrary)) {
+        if (failedLibrary.empty()) {
+            return makeContextError(command, filename, "link store");
+        }
+        printVerbose("Linking failed for module: ", failedLibrary);
+        return makeWasmEdgeError(command, filename, "link", "FAILED (Link Error)", result);
+    }
+
+    // Step 1: Load the module: a cached AOT artifact, or the session's parse
+    printVerbose("Loading WebAssembly module...");
+    PreparedModule local;
+    if (!prepared) {
+        ModuleResult failure;
+        if (!prepareModule(session, command, filename, local, failure)) {
+            return failure;
+        }
+        prepared = &local;
+    }
+    if (!prepared->artifact.empty()) {
+        printVerbose("Using cached AOT artifact: ", prepared->artifact);
+        PhaseTimer timer(phases, "load");
+        result = WasmEdge_VMLoadWasmFromFile(vmCtx, prepared->artifact.c_str());
+    } else {
+        PhaseTimer timer(phases, "load");
+        result = WasmEdge_VMLoadWasmFromASTModule(vmCtx, prepared->ast.get());
+        // The VM holds its own copy of the AST
+    }
+
+    if (!WasmEdge_ResultOK(result)) {
+        return makeWasmEdgeError(command, filename, "load", "FAILED (Load Error)", result);
+    }
+
+    // Step 2: Validate the loaded module
+    printVerbose("Validating loaded module...");
+    {
+        PhaseTimer timer(phases, "validate");
+        result = WasmEdge_VMValidate(vmCtx);
+    }
+
+    if (!WasmEdge_ResultOK(result)) {
+        return makeWasmEdgeError(command, filename, "validate", "FAILED (Validation Error)",
+                                 result);
+    }
+
+    // Step 3: Instantiate the module (imports from wasi_snapshot_preview1 resolve
+    // against the session's WASI host module)
+    if (g_wasi) {
+        WasmEdge_ModuleInstanceContext* wasi = session.wasiModule();
+        if (!wasi) {
+            return makeContextError(command, filename, "WASI host module");
+        }
+        initWasi(wasi, filename);
+        result = WasmEdge_VMRegisterModuleFromImport(vmCtx, wasi);
+        if (!WasmEdge_ResultOK(result)) {
+            return makeWasmEdgeError(command, filename, "instantiate",
+                                     "FAILED (Instantiation Error)", result);
+        }
+    }
+    printVerbose("Instantiating module...");
+    {
+        PhaseTimer timer(phases, "instantiate");
+        result = WasmEdge_VMInstantiate(vmCtx);
+    }
+
+    if (!WasmEdge_ResultOK(result)) {
+        return makeWasmEdgeError(command, filename, "instantiate", "FAILED (Instantiation Error)",
+                                 result);
+    }
+
+    // Step 4: Replace the skipped initialization with the --from-snapshot state
+    if (!g_fromSnapshot.empty()) {
+        std::string_view error;
+        bool restored;
+        {
+            PhaseTimer timer(phases, "restore");
+            restored = loadedSnapshot().restore(vmCtx, error);
+        }
+        if (!restored) {
+            return makeSnapshotError(command, filename, "restore", error);
+        }
+        printVerbose("Restored snapshot: ", g_fromSnapshot);
+    }
+
+    return makeSuccess(command, filename, "READY");
+}
+
+/**
+ * Instantiate sub-command implementation using WasmEdge C API
+ * 
+ * Pipeline: VM Acquire -> Load -> Validate -> Instantiate [-> Snapshot]
+ * Demonstrates: VM lifecycle, streamlined module loading
+ * Uses RAII wrappers for automatic resource cleanup.
+ * Does not execute any functions - only creates a ready VM instance.
+ * In batch and serve runs the VM comes from a shared pool and is cleaned up
+ * and returned to it afterwards.
+ * 
+ * @param session  Session for the current run (supplies the VM; collects
+ *                 --profile phase samples)
+ * @param filename Path to the .wasm file to instantiate
+ * @return Result record (EXIT_OK or EXIT_RUNTIME_ERROR)
+ */
+ModuleResult cmdInstantiate(Session& session, const std::string& filename) {
+    printVerbose("Processing file: ", filename);
+    TeardownTimer teardown(session.phases());
+    
+    // Step 1: Acquire a VM context (pooled or new; RAII managed)
+    VMPool::Lease vmCtx = session.acquireVM();
+    TeardownStart teardownStart(teardown);
+    if (!vmCtx) {
+        return makeContextError("INSTANTIATE", filename, "VM context");
+    }
+
+    // Steps 2-4: Load -> Validate -> Instantiate
+    ModuleResult record = loadAndInstantiate(session, vmCtx.get(), "INSTANTIATE", filename);
+    if (record.exitCode != EXIT_OK) {
+        return record;
+    }
+
+    // Step 5: Capture the instance state (--snapshot)
+    if (!g_snapshotOut.empty()) {
+        MappedModule module;
+        if (!session.openModule(module, filename)) {
+            return makeInputError("INSTANTIATE", filename, "Cannot read file");
+        }
+        std::string_view error;
+        {
+            PhaseTimer timer(session.phases(), "snapshot");
+            error = writeSnapshot(vmCtx.get(), module, g_snapshotOut);
+        }
+        if (!error.empty()) {
+            return makeSnapshotError("INSTANTIATE", filename, "snapshot", error);
+        }
+        printVerbose("Snapshot written: ", g_snapshotOut);
+    }
+
+    // Success
+    printVerbose("Instantiation completed successfully.");
+    return record;
+    // RAII: vmCtx cleaned up and returned to the pool (or deleted)
+}
+
+/**
+ * Check-all sub-command: the parse, validate and instantiate checks in one
+ * pipeline.
+ * 
+ * Pipeline: Parse -> VM Load (AST) -> Validate -> Instantiate
+ * The module is parsed exactly once. Its AST goes straight into a pooled VM,
+ * whose validation and instantiation provide the other two verdicts, so a
+ * corpus needs one pass instead of separate parse, validate and
+ * instantiate runs.
+ * 
+ * @param session  Session owning the parser and supplying the VM
+ * @param filename Path to the .wasm file to check
+ * @return Result record (status PASSED, or the first failing check)
+ */
+ModuleResult cmdCheckAll(Session& session, const std::string& filename) {
+    printVerbose("Processing file: ", filename);
+    TeardownTimer teardown(session.phases());
+
+    // Step 1: Acquire a VM context (pooled or new; RAII managed)
+    VMPool::Lease vmCtx = session.acquireVM();
+    TeardownStart teardownStart(teardown);
+    if (!vmCtx) {
+        return makeContextError("CHECK-ALL", filename, "VM context");
+    }
+
+    // Steps 2-5: Parse -> Load -> Validate -> Instantiate
+    ModuleResult record = loadAndInstantiate(session, vmCtx.get(), "CHECK-ALL", filename);
+    if (record.exitCode == EXIT_OK) {
+        printVerbose("All checks passed.");
+        record.status = "PASSED";
+    } else if (record.errorKind == ErrorKind::WasmEdge && record.phase == "parse") {
+        record.status = "FAILED (Parse Error)";
+    } else if (record.errorKind == ErrorKind::WasmEdge && record.phase == "validate") {
+        record.status = "INVALID";
+    }
+    return record;
+}
+
+/**
+ * Compile sub-command implementation using WasmEdge C API
+ * 
+ * Pipeline: Map -> Hash -> Cache lookup -> AOT Compile -> Publish
+ * Mirrors `wasmedgec`: produces a native shared library at the selected
+ * optimization level. Without --output the artifact is stored in the
+ * content-addressed cache, where `instantiate` picks it up automatically.
+ * Artifacts are written to a temporary file and renamed into place so
+ * concurrent runs never observe a partial artifact.
+ * 
+ * @param session  Session owning the reusable compiler context
+ * @param filename Path to the .wasm file to compile
+ * @return Result record (EXIT_OK or EXIT_RUNTIME_ERROR)
+ */
+ModuleResult cmdCompile(Session& session, const std::string& filename) {
+    printVerbose("Processing file: ", filename);
+
+    // Step 1: Map the module and resolve the artifact path
+    MappedModule module;
+    if (!session.openModule(module, filename)) {
+        return makeInputError("COMPILE", filename, "Cannot read file");
+    }
+
+    bool useCache = g_compileOutput.empty();
+    fs::path artifact = useCache ? aotArtifactPath(module) : fs::path(g_compileOutput);
+    printVerbose("AOT artifact: ", artifact.string());
+
+    std::error_code ec;
+    if (useCache && fs::is_regular_file(artifact, ec)) {
+        printVerbose("Artifact already cached, skipping compilation.");
+        return makeSuccess("COMPILE", filename, "CACHED");
+    }
+
+    // Step 2: Get the compiler context (created once per session)
+    WasmEdge_CompilerContext* compilerCtx = session.compiler();
+    if (!compilerCtx) {
+        return makeContextError("COMPILE", filename, "compiler context");
+    }
+
+    // Step 3: Compile into a temporary file next to the final artifact
+    if (artifact.has_parent_path()) {
+        fs::create_directories(artifact.parent_path(), ec);
+    }
+    fs::path tmpArtifact = temporaryPathFor(artifact.string());
+
+    printVerbose("Compiling WebAssembly module (", optLevelName(g_optLevel), ")...");
+    WasmEdge_Result result;
+    {
+        PhaseTimer timer(session.phases(), "compile");
+        result = g_useMmap || session.hasInlineModule()
+            ? WasmEdge_CompilerCompileFromBytes(compilerCtx, module.bytes(),
+                                                tmpArtifact.string().c_str())
+            : WasmEdge_CompilerCompile(compilerCtx, filename.c_str(), tmpArtifact.string().c_str());
+    }
+    module.release();
+
+    if (!WasmEdge_ResultOK(result)) {
+        fs::remove(tmpArtifact, ec);
+        return makeWasmEdgeError("COMPILE", filename, "compile", "FAILED (Compile Error)", result);
+    }
+
+    // Step 4: Publish atomically
+    if (!publishTemporary(tmpArtifact.string(), artifact.string())) {
+        return makeInputError("COMPILE", filename, "Cannot write AOT artifact");
+    }
+
+    printVerbose("Compilation completed successfully.");
+    return makeSuccess("COMPILE", filename, "COMPILED");
+}
+
+// ============================================================================
+// Inspect Sub-command - Module structure report and on-disk index
+// ============================================================================
+
+constexpr std::string_view INDEX_EXTENSION = ".wmidx";
+constexpr uint32_t INDEX_MAGIC = 0x58494D57;  // "WMIX"
+constexpr uint32_t INDEX_VERSION = 1;
+
+// Section names by id (ids 0-13, as accepted by the scanner)
+constexpr std::string_view SECTION_NAMES[] = {
+    "custom", "type", "import", "function", "table", "memory", "global",
+    "export", "start", "element", "code", "data", "datacount", "tag"};
+
+/**
+ * One section of an inspected module
+ */
+struct InspectSection {
+    uint8_t id = 0;
+    uint64_t offset = 0;  // Payload offset
+    uint64_t size = 0;    // Payload size
+    std::string name;     // Custom section name (id 0 only)
+};
+
+/**
+ * One defined function: its type index and code body location
+ */
+struct InspectFunction {
+    uint32_t typeIndex = 0;
+    uint64_t offset = 0;  // Body offset (after the body size)
+    uint64_t size = 0;    // Body size
+};
+
+/**
+ * One function asked for with --lookup
+ */
+struct InspectLookup {
+    uint32_t index = 0;       // Function index, counting imports
+    bool imported = false;    // Imported functions have no type index or body here
+    InspectFunction function; // Defined functions only
+};
+
+/**
+ * One import or export of an inspected module
+ */
+struct InspectItem {
+    std::string module;     // Import module name (empty for exports)
+    std::string name;
+    std::string_view kind;  // func, table, memory, global, tag
+    std::string type;       // Rendered type, e.g. "(i32, i32) -> (i32)"
+};
+
+/**
+ * Everything inspect reports about a module
+ */
+struct InspectReport {
+    uint64_t moduleSize = 0;
+    std::vector<InspectSection> sections;
+    uint32_t importedFunctions = 0;
+    uint32_t definedFunctions = 0;
+    std::vector<InspectFunction> functions;  // Only filled when building from the binary
+    std::vector<InspectLookup> lookups;      // --lookup functions, from the binary or the index
+    std::vector<InspectItem> imports;
+    std::vector<InspectItem> exports;
+};
+
+/**
+ * Check the --lookup functions against a module's function count
+ *
+ * @param report Report with its function counts set
+ * @return false if an index is past the last function
+ */
+bool lookupsInRange(const InspectReport& report) {
+    uint64_t total = uint64_t{report.importedFunctions} + report.definedFunctions;
+    for (auto [low, high] : g_lookupFunctions) {
+        if (high >= total) return false;
+    }
+    return true;
+}
+
+/**
+ * Fill the --lookup functions of a report. Indices past the last function
+ * are skipped (see lookupsInRange).
+ *
+ * @param report   Report with its function counts set; receives the lookups
+ * @param function Returns defined function i (from the binary or the index)
+ */
+template <typename FunctionAt>
+void resolveLookups(InspectReport& report, FunctionAt function) {
+    uint64_t total = uint64_t{report.importedFunctions} + report.definedFunctions;
+    for (auto [low, high] : g_lookupFunctions) {
+        for (uint64_t index = low; index <= high && index < total; index++) {
+            InspectLookup lookup;
+            lookup.index = static_cast<uint32_t>(index);
+            lookup.imported = index < report.importedFunctions;
+            if (!lookup.imported) {
+                lookup.function = function(static_cast<uint32_t>(index - report.importedFunctions));
+            }
+            report.lookups.push_back(lookup);
+        }
+    }
+}
+
+// On-disk index layout: header, section table, function table, import and
+// export table, string pool. All fields are in host byte order and 8-byte
+// aligned, so tools can map the file and index the tables directly;
+// function i (counting imports) is functions[i - importedFunctions].
+// An index written on a host of the other byte order reads its magic
+// byte-swapped, so it fails the magic check and is treated as stale.
+struct IndexHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t moduleSize;         // Staleness check: module size...
+    int64_t moduleMtime;         // ...and modification time (file clock ticks)
+    uint32_t sectionCount;
+    uint32_t functionCount;      // Defined functions
+    uint32_t importedFunctions;
+    uint32_t importCount;
+    uint32_t exportCount;
+    uint32_t reserved;
+    uint64_t stringPoolSize;
+    uint64_t reserved2;
+};
+struct IndexSection {
+    uint32_t id;
+    uint32_t nameOffset;  // Into the string pool
+    uint32_t nameLength;
+    uint32_t reserved;
+    uint64_t offset;
+    uint64_t size;
+};
+struct IndexFunction {
+    uint32_t typeIndex;
+    uint32_t reserved;
+    uint64_t offset;
+    uint64_t size;
+};
+struct IndexItem {
+    uint32_t kind;  // WasmEdge_ExternalType
+    uint32_t moduleOffset;
+    uint32_t moduleLength;
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    uint32_t typeOffset;
+    uint32_t typeLength;
+    uint32_t reserved;
+};
+static_assert(sizeof(IndexHeader) == 64 && sizeof(IndexSection) == 32
+              && sizeof(IndexFunction) == 24 && sizeof(IndexItem) == 32,
+              "index records have a fixed on-disk size");
+
+/**
+ * Name of a value type as written in the text format
+ *
+ * @param type Value type
+ * @return Type name
+ */
+std::string_view valTypeName(WasmEdge_ValType type) {
+    if (WasmEdge_ValTypeIsI32(type)) return "i32";
+    if (WasmEdge_ValTypeIsI64(type)) return "i64";
+    if (WasmEdge_ValTypeIsF32(type)) return "f32";
+    if (WasmEdge_ValTypeIsF64(type)) return "f64";
+    if (WasmEdge_ValTypeIsV128(type)) return "v128";
+    if (WasmEdge_ValTypeIsFuncRef(type)) return "funcref";
+    if (WasmEdge_ValTypeIsExternRef(type)) return "externref";
+    return "ref";
+}
+
+/**
+ * Render a function type as "(params) -> (results)"
+ *
+ * @param funcType Function type (may be null)
+ * @return Rendered type
+ */
+std::string formatFunctionType(const WasmEdge_FunctionTypeContext* funcType) {
+    if (!funcType) {
+        return "?";
+    }
+    auto join = [](const std::vector<WasmEdge_ValType>& types) {
+        std::string text = "(";
+        for (size_t i = 0; i < types.size(); i++) {
+            if (i > 0) text += ", ";
+            text += valTypeName(types[i]);
+        }
+        return text + ")";
+    };
+    std::vector<WasmEdge_ValType> params(WasmEdge_FunctionTypeGetParametersLength(funcType));
+    WasmEdge_FunctionTypeGetParameters(funcType, params.data(),
+                                       static_cast<uint32_t>(params.size()));
+    std::vector<WasmEdge_ValType> returns(WasmEdge_FunctionTypeGetReturnsLength(funcType));
+    WasmEdge_FunctionTypeGetReturns(funcType, returns.data(),
+                                    static_cast<uint32_t>(returns.size()));
+    return join(params) + " -> " + join(returns);
+}
+
+/**
+ * Render table/memory limits as "{min N, max M}"
+ *
+ * @param limit Limits
+ * @return Rendered limits
+ */
+std::string formatLimit(const WasmEdge_Limit& limit) {
+    std::string text = "{min " + std::to_string(limit.Min);
+    if (limit.HasMax) text += ", max " + std::to_string(limit.Max);
+    text += "}";
+    if (limit.Shared) text += " shared";
+    return text;
+}
+
+// ImportTypeGet*Type / ExportTypeGet*Type for one external kind
+template <typename Entry, typename Type>
+using ExternTypeGetter = const Type* (*)(const WasmEdge_ASTModuleContext*, const Entry*);
+
+/**
+ * Describe an import or export from its external type.
+ * ImportType and ExportType expose the same queries, so one template
+ * serves both.
+ *
+ * @param astModule AST module owning the type
+ * @param entry     Import or export type
+ * @param getKind   ...GetExternalType
+ * @param getFunc   ...GetFunctionType
+ * @param getTable  ...GetTableType
+ * @param getMemory ...GetMemoryType
+ * @param getGlobal ...GetGlobalType
+ * @param item      Receives kind and type
+ */
+template <typename Entry>
+void describeExtern(const WasmEdge_ASTModuleContext* astModule, const Entry* entry,
+                    WasmEdge_ExternalType (*getKind)(const Entry*),
+                    ExternTypeGetter<Entry, WasmEdge_FunctionTypeContext> getFunc,
+                    ExternTypeGetter<Entry, WasmEdge_TableTypeContext> getTable,
+                    ExternTypeGetter<Entry, WasmEdge_MemoryTypeContext> getMemory,
+                    ExternTypeGetter<Entry, WasmEdge_GlobalTypeContext> getGlobal,
+                    InspectItem& item) {
+    switch (getKind(entry)) {
+        case WasmEdge_ExternalType_Function:
+            item.kind = "func";
+            item.type = formatFunctionType(getFunc(astModule, entry));
+            break;
+        case WasmEdge_ExternalType_Table:
+            item.kind = "table";
+            if (const WasmEdge_TableTypeContext* table = getTable(astModule, entry)) {
+                item.type = std::string(valTypeName(WasmEdge_TableTypeGetRefType(table))) + " "
+                          + formatLimit(WasmEdge_TableTypeGetLimit(table));
+            }
+            break;
+        case WasmEdge_ExternalType_Memory:
+            item.kind = "memory";
+            if (const WasmEdge_MemoryTypeContext* memory = getMemory(astModule, entry)) {
+                item.type = formatLimit(WasmEdge_MemoryTypeGetLimit(memory));
+            }
+            break;
+        case WasmEdge_ExternalType_Global:
+            item.kind = "global";
+            if (const WasmEdge_GlobalTypeContext* global = getGlobal(astModule, entry)) {
+                bool isMutable =
+                    WasmEdge_GlobalTypeGetMutability(global) == WasmEdge_Mutability_Var;
+                item.type = std::string(isMutable ? "mut " : "")
+                          + std::string(valTypeName(WasmEdge_GlobalTypeGetValType(global)));
+            }
+            break;
+        default:
+            item.kind = "tag";
+            break;
+    }
+}
+
+/**
+ * Copy a WasmEdge_String view into a std::string
+ *
+ * @param text WasmEdge string (not owned)
+ * @return Copied text
+ */
+std::string toStdString(WasmEdge_String text) {
+    return std::string(text.Buf, text.Length);
+}
+
+/**
+ * Fill the section, function and import/export parts of a report
+ *
+ * @param data      Module bytes
+ * @param spans     Section layout from scanModule()
+ * @param astModule Parsed module
+ * @param report    Receives the structure
+ * @return Failed ScanResult if the function or code section is malformed
+ */
+ScanResult buildInspectReport(const uint8_t* data, const std::vector<SectionSpan>& spans,
+                              const WasmEdge_ASTModuleContext* astModule, InspectReport& report) {
+    std::vector<uint32_t> typeIndexes;
+    uint64_t functionsAt = 0;
+    for (const SectionSpan& span : spans) {
+        InspectSection section{span.id, span.offset, span.size, {}};
+        const uint8_t* p = data + span.offset;
+        const uint8_t* end = p + span.size;
+        uint32_t value = 0;
+        size_t length = 0;
+        if (span.id == 0 && readVarU32(p, end, value, length)) {
+            section.name.assign(reinterpret_cast<const char*>(p + length), value);
+        } else if (span.id == 3 || span.id == 10) {
+            // Function section: type indexes; code section: sized bodies
+            auto malformed = [&] {
+                return ScanResult{false, static_cast<uint64_t>(p - data),
+                                  span.id == 3 ? "Malformed function section"
+                                               : "Malformed code section"};
+            };
+            uint32_t count = 0;
+            if (!readVarU32(p, end, count, length)) return malformed();
+            p += length;
+            if (span.id == 3) functionsAt = span.headerOffset;
+            for (uint32_t i = 0; i < count; i++) {
+                if (!readVarU32(p, end, value, length)) return malformed();
+                p += length;
+                if (span.id == 3) {
+                    typeIndexes.push_back(value);
+                    continue;
+                }
+                if (value > static_cast<uint64_t>(end - p)) return malformed();
+                report.functions.push_back(InspectFunction{
+                    0, static_cast<uint64_t>(p - data), value});
+                p += value;
+            }
+        }
+        report.sections.push_back(std::move(section));
+    }
+    if (typeIndexes.size() != report.functions.size()) {
+        // The parser would reject this too; keep the table consistent
+        return ScanResult{false, functionsAt, "Function and code section counts differ"};
+    }
+    for (size_t i = 0; i < typeIndexes.size(); i++) {
+        report.functions[i].typeIndex = typeIndexes[i];
+    }
+    report.definedFunctions = static_cast<uint32_t>(report.functions.size());
+
+    std::vector<const WasmEdge_ImportTypeContext*> imports(
+        WasmEdge_ASTModuleListImportsLength(astModule));
+    WasmEdge_ASTModuleListImports(astModule, imports.data(),
+                                  static_cast<uint32_t>(imports.size()));
+    for (const WasmEdge_ImportTypeContext* entry : imports) {
+        InspectItem item;
+        item.module = toStdString(WasmEdge_ImportTypeGetModuleName(entry));
+        item.name = toStdString(WasmEdge_ImportTypeGetExternalName(entry));
+        describeExtern(astModule, entry, WasmEdge_ImportTypeGetExternalType,
+                       WasmEdge_ImportTypeGetFunctionType, WasmEdge_ImportTypeGetTableType,
+                       WasmEdge_ImportTypeGetMemoryType, WasmEdge_ImportTypeGetGlobalType, item);
+        if (item.kind == "func") report.importedFunctions++;
+        report.imports.push_back(std::move(item));
+    }
+
+    std::vector<const WasmEdge_ExportTypeContext*> exports(
+        WasmEdge_ASTModuleListExportsLength(astModule));
+    WasmEdge_ASTModuleListExports(astModule, exports.data(),
+                                  static_cast<uint32_t>(exports.size()));
+    for (const WasmEdge_ExportTypeContext* entry : exports) {
+        InspectItem item;
+        item.name = toStdString(WasmEdge_ExportTypeGetExternalName(entry));
+        describeExtern(astModule, entry, WasmEdge_ExportTypeGetExternalType,
+                       WasmEdge_ExportTypeGetFunctionType, WasmEdge_ExportTypeGetTableType,
+                       WasmEdge_ExportTypeGetMemoryType, WasmEdge_ExportTypeGetGlobalType, item);
+        report.exports.push_back(std::move(item));
+    }
+    return ScanResult{};
+}
+
+/**
+ * Path of the index file that sits next to a module
+ *
+ * @param filename Path to the .wasm file
+ * @return Index path (<module>.wmidx)
+ */
+std::string indexPathFor(const std::string& filename) {
+    return filename + std::string(INDEX_EXTENSION);
+}
+
+/**
+ * Modification time of a file in file clock ticks
+ *
+ * @param path File path
+ * @param mtime Receives the modification time
+ * @return false if the file cannot be stat'ed
+ */
+bool fileMtime(const std::string& path, int64_t& mtime) {
+    std::error_code ec;
+    fs::file_time_type time = fs::last_write_time(path, ec);
+    if (ec) return false;
+    mtime = static_cast<int64_t>(time.time_since_epoch().count());
+    return true;
+}
+
+/**
+ * Write the index for a module (temporary file renamed into place)
+ *
+ * @param indexPath   Index path
+ * @param report      Report built from the module binary
+ * @param moduleMtime Module modification time
+ * @return true on success
+ */
+bool writeInspectIndex(const std::string& indexPath, const InspectReport& report,
+                       int64_t moduleMtime) {
+    std::string pool;
+    auto intern = [&pool](std::string_view text, uint32_t& offset, uint32_t& length) {
+        offset = static_cast<uint32_t>(pool.size());
+        length = static_cast<uint32_t>(text.size());
+        pool += text;
+    };
+
+    std::vector<IndexSection> sections;
+    for (const InspectSection& section : report.sections) {
+        IndexSection entry{section.id, 0, 0, 0, section.offset, section.size};
+        intern(section.name, entry.nameOffset, entry.nameLength);
+        sections.push_back(entry);
+    }
+    std::vector<IndexFunction> functions;
+    functions.reserve(report.functions.size());
+    for (const InspectFunction& function : report.functions) {
+        functions.push_back(IndexFunction{function.typeIndex, 0, function.offset, function.size});
+    }
+    std::vector<IndexItem> items;
+    auto kindCode = [](std::string_view kind) {
+        if (kind == "func") return WasmEdge_ExternalType_Function;
+        if (kind == "table") return WasmEdge_ExternalType_Table;
+        if (kind == "memory") return WasmEdge_ExternalType_Memory;
+        if (kind == "global") return WasmEdge_ExternalType_Global;
+        return WasmEdge_ExternalType_Tag;
+    };
+    for (const std::vector<InspectItem>* list : {&report.imports, &report.exports}) {
+        for (const InspectItem& item : *list) {
+            IndexItem entry{};
+            entry.kind = static_cast<uint32_t>(kindCode(item.kind));
+            intern(item.module, entry.moduleOffset, entry.moduleLength);
+            intern(item.name, entry.nameOffset, entry.nameLength);
+            intern(item.type, entry.typeOffset, entry.typeLength);
+            items.push_back(entry);
+        }
+    }
+
+    IndexHeader header{};
+    header.magic = INDEX_MAGIC;
+    header.version = INDEX_VERSION;
+    header.moduleSize = report.moduleSize;
+    header.moduleMtime = moduleMtime;
+    header.sectionCount = static_cast<uint32_t>(sections.size());
+    header.functionCount = static_cast<uint32_t>(functions.size());
+    header.importedFunctions = report.importedFunctions;
+    header.importCount = static_cast<uint32_t>(report.imports.size());
+    header.exportCount = static_cast<uint32_t>(report.exports.size());
+    header.stringPoolSize = pool.size();
+
+    std::string tmpPath = temporaryPathFor(indexPath);
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(sections.data()),
+                  static_cast<std::streamsize>(sections.size() * sizeof(IndexSection)));
+        out.write(reinterpret_cast<const char*>(functions.data()),
+                  static_cast<std::streamsize>(functions.size() * sizeof(IndexFunction)));
+        out.write(reinterpret_cast<const char*>(items.data()),
+                  static_cast<std::streamsize>(items.size() * sizeof(IndexItem)));
+        out.write(pool.data(), static_cast<std::streamsize>(pool.size()));
+        if (!out) {
+            out.close();
+            std::remove(tmpPath.c_str());
+            return false;
+        }
+    }
+    return publishTemporary(tmpPath, indexPath);
+}
+
+/**
+ * Load a report from a module's index if the index is current.
+ * The function table is not copied; only the --lookup entries are read
+ * from it, straight by index.
+ *
+ * @param indexPath   Index path
+ * @param moduleSize  Current module size
+ * @param moduleMtime Current module modification time
+ * @param report      Receives the report
+ * @return false if the index is missing, stale or malformed
+ */
+bool loadInspectIndex(const std::string& indexPath, uint64_t moduleSize, int64_t moduleMtime,
+                      InspectReport& report) {
+    MappedModule index;  // Any read-only file mapping will do
+    if (!index.open(indexPath) || index.size() < sizeof(IndexHeader)) {
+        return false;
+    }
+    IndexHeader header;
+    std::memcpy(&header, index.data(), sizeof(header));
+    if (header.magic != INDEX_MAGIC || header.version != INDEX_VERSION
+        || header.moduleSize != moduleSize || header.moduleMtime != moduleMtime) {
+        return false;
+    }
+    uint64_t itemCount = uint64_t{header.importCount} + header.exportCount;
+    uint64_t sectionsAt = sizeof(IndexHeader);
+    uint64_t functionsAt = sectionsAt + uint64_t{header.sectionCount} * sizeof(IndexSection);
+    uint64_t itemsAt = functionsAt + uint64_t{header.functionCount} * sizeof(IndexFunction);
+    uint64_t poolAt = itemsAt + itemCount * sizeof(IndexItem);
+    if (poolAt + header.stringPoolSize != index.size()) {
+        return false;
+    }
+    const char* pool = reinterpret_cast<const char*>(index.data() + poolAt);
+    auto text = [&](uint32_t offset, uint32_t length, std::string& out) {
+        if (uint64_t{offset} + length > header.stringPoolSize) return false;
+        out.assign(pool + offset, length);
+        return true;
+    };
+
+    report.moduleSize = header.moduleSize;
+    report.importedFunctions = header.importedFunctions;
+    report.definedFunctions = header.functionCount;
+    for (uint32_t i = 0; i < header.sectionCount; i++) {
+        IndexSection entry;
+        std::memcpy(&entry, index.data() + sectionsAt + i * sizeof(IndexSection), sizeof(entry));
+        InspectSection section{static_cast<uint8_t>(entry.id), entry.offset, entry.size, {}};
+        if (entry.id >= std::size(SECTION_NAMES)
+            || !text(entry.nameOffset, entry.nameLength, section.name)) {
+            return false;
+        }
+        report.sections.push_back(std::move(section));
+    }
+    static constexpr std::string_view KINDS[] = {"func", "table", "memory", "global", "tag"};
+    for (uint64_t i = 0; i < itemCount; i++) {
+        IndexItem entry;
+        std::memcpy(&entry, index.data() + itemsAt + i * sizeof(IndexItem), sizeof(entry));
+        InspectItem item;
+        if (entry.kind >= std::size(KINDS)
+            || !text(entry.moduleOffset, entry.moduleLength, item.module)
+            || !text(entry.nameOffset, entry.nameLength, item.name)
+            || !text(entry.typeOffset, entry.typeLength, item.type)) {
+            return false;
+        }
+        item.kind = KINDS[entry.kind];
+        (i < header.importCount ? report.imports : report.exports).push_back(std::move(item));
+    }
+    resolveLookups(report, [&](uint32_t defined) {
+        IndexFunction entry;
+        std::memcpy(&entry, index.data() + functionsAt + uint64_t{defined} * sizeof(IndexFunction),
+                    sizeof(entry));
+        return InspectFunction{entry.typeIndex, entry.offset, entry.size};
+    });
+    return true;
+}
+
+/**
+ * Find the import that defines an imported function
+ *
+ * @param report Report with its imports
+ * @param index  Function index (below importedFunctions)
+ * @return The import, or null if the report has fewer function imports
+ */
+const InspectItem* importedFunction(const InspectReport& report, uint32_t index) {
+    for (const InspectItem& item : report.imports) {
+        if (item.kind == "func" && index-- == 0) return &item;
+    }
+    return nullptr;
+}
+
+/**
+ * Render an inspect report as text lines (after the record header) or,
+ * with --format json/ndjson, as a JSON object
+ *
+ * @param report    Report to render
+ * @param indexNote Index status ("used", "written", or empty)
+ * @param indexPath Index path shown with the note
+ * @return Rendered report
+ */
+std::string renderInspectReport(const InspectReport& report, std::string_view indexNote,
+                                const std::string& indexPath) {
+    std::string out;
+    if (g_format == OutputFormat::Text) {
+        char line[160];
+        out += "Size   : " + std::to_string(report.moduleSize) + " bytes\n";
+        if (!indexNote.empty()) {
+            out += "Index  : " + indexPath + " (" + std::string(indexNote) + ")\n";
+        }
+        out += "Sections:\n";
+        for (const InspectSection& section : report.sections) {
+            std::string name(SECTION_NAMES[section.id]);
+            if (section.id == 0) name += " \"" + section.name + "\"";
+            std::snprintf(line, sizeof(line), "  %-20s offset %-12llu size %llu\n", name.c_str(),
+                          static_cast<unsigned long long>(section.offset),
+                          static_cast<unsigned long long>(section.size));
+            out += line;
+        }
+        out += "Functions: " + std::to_string(report.importedFunctions + report.definedFunctions)
+             + " (" + std::to_string(report.importedFunctions) + " imported, "
+             + std::to_string(report.definedFunctions) + " defined)\n";
+        for (const InspectLookup& lookup : report.lookups) {
+            if (lookup.imported) {
+                const InspectItem* item = importedFunction(report, lookup.index);
+                out += "  func[" + std::to_string(lookup.index) + "]  imported";
+                if (item) out += " " + item->module + "." + item->name;
+                out += "\n";
+                continue;
+            }
+            std::snprintf(line, sizeof(line), "  func[%u]  type %u, body offset %llu size %llu\n",
+                          lookup.index, lookup.function.typeIndex,
+                          static_cast<unsigned long long>(lookup.function.offset),
+                          static_cast<unsigned long long>(lookup.function.size));
+            out += line;
+        }
+        out += "Imports: " + std::to_string(report.imports.size()) + "\n";
+        for (const InspectItem& item : report.imports) {
+            out += "  " + item.module + "." + item.name + "  " + std::string(item.kind) + " "
+                 + item.type + "\n";
+        }
+        out += "Exports: " + std::to_string(report.exports.size()) + "\n";
+        for (const InspectItem& item : report.exports) {
+            out += "  " + item.name + "  " + std::string(item.kind) + " " + item.type + "\n";
+        }
+        return out;
+    }
+
+    out += "{\"size\":" + std::to_string(report.moduleSize);
+    if (!indexNote.empty()) {
+        out += ",\"index\":\"" + jsonEscape(indexPath) + "\",\"index_status\":\""
+             + std::string(indexNote) + "\"";
+    }
+    out += ",\"sections\":[";
+    for (size_t i = 0; i < report.sections.size(); i++) {
+        const InspectSection& section = report.sections[i];
+        if (i > 0) out += ",";
+        out += "{\"id\":" + std::to_string(section.id) + ",\"name\":\"";
+        out += section.id == 0 ? jsonEscape(section.name) : std::string(SECTION_NAMES[section.id]);
+        out += "\",\"offset\":" + std::to_string(section.offset)
+             + ",\"size\":" + std::to_string(section.size) + "}";
+    }
+    out += "],\"functions\":{\"imported\":" + std::to_string(report.importedFunctions)
+         + ",\"defined\":" + std::to_string(report.definedFunctions) + "}";
+    if (!report.lookups.empty()) {
+        out += ",\"lookups\":[";
+        for (size_t i = 0; i < report.lookups.size(); i++) {
+            const InspectLookup& lookup = report.lookups[i];
+            if (i > 0) out += ",";
+            out += "{\"index\":" + std::to_string(lookup.index);
+            if (lookup.imported) {
+                out += ",\"imported\":true";
+                if (const InspectItem* item = importedFunction(report, lookup.index)) {
+                    out += ",\"module\":\"" + jsonEscape(item->module)
+                         + "\",\"name\":\"" + jsonEscape(item->name) + "\"";
+                }
+            } else {
+                out += ",\"imported\":false,\"type\":" + std::to_string(lookup.function.typeIndex)
+                     + ",\"offset\":" + std::to_string(lookup.function.offset)
+                     + ",\"size\":" + std::to_string(lookup.function.size);
+            }
+            out += "}";
+        }
+        out += "]";
+    }
+    for (const auto& [key, list] : {std::pair{"imports", &report.imports},
+                                    std::pair{"exports", &report.exports}}) {
+        out += ",\"" + std::string(key) + "\":[";
+        for (size_t i = 0; i < list->size(); i++) {
+            const InspectItem& item = (*list)[i];
+            if (i > 0) out += ",";
+            out += "{";
+            if (list == &report.imports) out += "\"module\":\"" + jsonEscape(item.module) + "\",";
+            out += "\"name\":\"" + jsonEscape(item.name) + "\",\"kind\":\"" + std::string(item.kind)
+                 + "\",\"type\":\"" + jsonEscape(item.type) + "\"}";
+        }
+        out += "]";
+    }
+    out += "}";
+    return out;
+}
+
+/**
+ * Inspect sub-command implementation using WasmEdge C API
+ * 
+ * Pipeline: Index lookup -> (Map -> Scan -> Parse -> List imports/exports)
+ * Reports section offsets and sizes, function counts, and imports/exports
+ * with their types. A current <module>.wmidx index next to the module
+ * answers without mapping or parsing the module; --index writes one. An
+ * index is current when it records the module's present size and
+ * modification time. --lookup functions are read from the index's function
+ * table when it is used, else from the code section.
+ * 
+ * @param session  Session owning the reusable parser context
+ * @param filename Path to the .wasm file to inspect
+ * @return Result record (EXIT_OK or EXIT_RUNTIME_ERROR)
+ */
+ModuleResult cmdInspect(Session& session, const std::string& filename) {
+    printVerbose("Processing file: ", filename);
+    TeardownTimer teardown(session.phases());
+
+    // Step 1: Use the index when it is current
+    std::string indexPath = indexPathFor(filename);
+    int64_t mtime = 0;
+    std::error_code ec;
+    bool onDisk = !session.hasInlineModule() && fileMtime(filename, mtime);
+    if (onDisk) {
+        uint64_t moduleSize = fs::file_size(filename, ec);
+        InspectReport indexed;
+        bool loaded;
+        {
+            PhaseTimer timer(session.phases(), "index_load");
+            loaded = !ec && loadInspectIndex(indexPath, moduleSize, mtime, indexed);
+        }
+        if (loaded && !lookupsInRange(indexed)) {
+            return makeInputError("INSPECT", filename,
+                                  "A '--lookup' index is past the last function");
+        }
+        if (loaded) {
+            printVerbose("Using index: ", indexPath);
+            ModuleResult record = makeSuccess("INSPECT", filename, "SUCCESS");
+            record.extra = renderInspectReport(indexed, "used", indexPath);
+            return record;
+        }
+    }
+
+    // Step 2: Map and scan the module for its section layout
+    MappedModule module;
+    if (!session.openModule(module, filename)) {
+        return makeInputError("INSPECT", filename, "Cannot read file");
+    }
+    std::vector<SectionSpan> spans;
+    ScanResult scan;
+    {
+        PhaseTimer timer(session.phases(), "scan");
+        scan = scanModule(module.data(), module.size(), &spans);
+    }
+    if (!scan.ok) {
+        return makeScanError("INSPECT", filename, scan);
+    }
+
+    // Step 3: Parse for imports and exports
+    WasmEdge_ParserContext* parserCtx = session.parser();
+    if (!parserCtx) {
+        return makeContextError("INSPECT", filename, "parser context");
+    }
+    ASTModulePtr astModuleCtx;
+    TeardownStart teardownStart(teardown);
+    WasmEdge_Result result;
+    {
+        PhaseTimer timer(session.phases(), "parse");
+        WasmEdge_ASTModuleContext* rawAstModule = nullptr;
+        result = WasmEdge_ParserParseFromBytes(parserCtx, &rawAstModule, module.bytes());
+        astModuleCtx.reset(rawAstModule);
+    }
+    if (!WasmEdge_ResultOK(result)) {
+        return makeWasmEdgeError("INSPECT", filename, "parse", "FAILED", result);
+    }
+
+    InspectReport report;
+    report.moduleSize = module.size();
+    {
+        PhaseTimer timer(session.phases(), "inspect");
+        scan = buildInspectReport(module.data(), spans, astModuleCtx.get(), report);
+    }
+    if (!scan.ok) {
+        return makeScanError("INSPECT", filename, scan);
+    }
+    if (!lookupsInRange(report)) {
+        return makeInputError("INSPECT", filename, "A '--lookup' index is past the last function");
+    }
+    resolveLookups(report, [&report](uint32_t defined) { return report.functions[defined]; });
+
+    // Step 4: Write the index on request
+    std::string_view indexNote;
+    if (g_writeIndex && onDisk) {
+        PhaseTimer timer(session.phases(), "index_write");
+        if (!writeInspectIndex(indexPath, report, mtime)) {
+            return makeInputError("INSPECT", filename, "Cannot write index file");
+        }
+        printVerbose("Index written: ", indexPath);
+        indexNote = "written";
+    }
+
+    ModuleResult record = makeSuccess("INSPECT", filename, "SUCCESS");
+    record.extra = renderInspectReport(report, indexNote, indexPath);
+    return record;
+}
+
+/**
+ * Map a module command name to its handler and record label
+ *
+ * @param name    Command name as typed (parse, validate, ...)
+ * @param handler Receives the per-module handler
+ * @param label   Receives the command label (PARSE, VALIDATE, ...)
+ * @return false if the name is not a per-module command
+ */
+bool resolveModuleCommand(std::string_view name, ModuleHandler& handler, std::string_view& label) {
+    static const struct {
+        std::string_view name;
+        ModuleHandler handler;
+        std::string_view label;
+    } COMMANDS[] = {
+        {"parse", cmdParse, "PARSE"},
+        {"validate", cmdValidate, "VALIDATE"},
+        {"instantiate", cmdInstantiate, "INSTANTIATE"},
+        {"compile", cmdCompile, "COMPILE"},
+        {"check-all", cmdCheckAll, "CHECK-ALL"},
+        {"inspect", cmdInspect, "INSPECT"},
+    };
+    for (const auto& command : COMMANDS) {
+        if (command.name == name) {
+            handler = command.handler == cmdValidate && g_lazy ? cmdValidateLazy : command.handler;
+            label = command.label;
+            return true;
+        }
+    }
+    return false;
+}
+
+// ============================================================================
+// Parallel Scheduler - Work-stealing pool for batch runs
+// ============================================================================
+
+/**
+ * Lock-free task range owned by one worker.
+ * The range [front, back) is packed into a single 64-bit atomic so the owner
+ * and thieves race on one CAS. The owner pops from the front (input order,
+ * which keeps the ordered printer fed); thieves steal from the back.
+ * Aligned to a cache line so neighbouring ranges never share one.
+ */
+class alignas(64) TaskRange {
+public:
+    /**
+     * Reset the range (only before workers start)
+     *
+     * @param begin First task index
+     * @param end   One past the last task index
+     */
+    void assign(uint32_t begin, uint32_t end) {
+        bounds_.store(pack(begin, end));
+    }
+
+    /**
+     * Take the next task from the front (owner side)
+     *
+     * @param task Receives the task index
+     * @return true if a task was taken, false if the range is empty
+     */
+    bool popFront(uint32_t& task) {
+        uint64_t current = bounds_.load(std::memory_order_relaxed);
+        while (front(current) < back(current)) {
+            if (bounds_.compare_exchange_weak(current, pack(front(current) + 1, back(current)))) {
+                task = front(current);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Take the last task from the back (thief side)
+     *
+     * @param task Receives the task index
+     * @return true if a task was stolen, false if the range is empty
+     */
+    bool stealBack(uint32_t& task) {
+        uint64_t current = bounds_.load(std::memory_order_relaxed);
+        while (front(current) < back(current)) {
+            if (bounds_.compare_exchange_weak(current, pack(front(current), back(current) - 1))) {
+                task = back(current) - 1;
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    static uint64_t pack(uint32_t front, uint32_t back) {
+        return (static_cast<uint64_t>(front) << 32) | back;
+    }
+    static uint32_t front(uint64_t bounds) { return static_cast<uint32_t>(bounds >> 32); }
+    static uint32_t back(uint64_t bounds) { return static_cast<uint32_t>(bounds); }
+
+    std::atomic<uint64_t> bounds_{0};
+};
+
+/**
+ * Fixed-size thread pool running a known set of tasks with work stealing.
+ * Tasks are split into contiguous per-worker ranges; a worker that drains
+ * its own range steals from the back of the others, so a few large modules
+ * do not leave the remaining cores idle.
+ */
+class WorkStealingPool {
+public:
+    using TaskBody = std::function<void(size_t worker, size_t task)>;
+
+    /**
+     * Start the workers
+     *
+     * @param workerCount Number of worker threads (>= 1)
+     * @param taskCount   Number of tasks to run
+     * @param body        Called as body(workerIndex, taskIndex) on a worker thread
+     */
+    WorkStealingPool(size_t workerCount, size_t taskCount, TaskBody body)
+        : ranges_(workerCount), body_(std::move(body)) {
+        for (size_t w = 0; w < workerCount; w++) {
+            ranges_[w].assign(static_cast<uint32_t>(taskCount * w / workerCount),
+                              static_cast<uint32_t>(taskCount * (w + 1) / workerCount));
+        }
+        threads_.reserve(workerCount);
+        for (size_t w = 0; w < workerCount; w++) {
+            threads_.emplace_back([this, w] { workerLoop(w); });
+        }
+    }
+
+    ~WorkStealingPool() { join(); }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    /**
+     * Wait for every task to finish
+     */
+    void join() {
+        for (std::thread& thread : threads_) {
+            if (thread.joinable()) thread.join();
+        }
+    }
+
+private:
+    void workerLoop(size_t self) {
+        uint32_t task = 0;
+        for (;;) {
+            if (ranges_[self].popFront(task)) {
+                body_(self, task);
+                continue;
+            }
+            // Own range drained: sweep the other ranges once for work to steal.
+            // No tasks are ever added, so an empty sweep means we are done.
+            bool stole = false;
+            for (size_t offset = 1; offset < ranges_.size() && !stole; offset++) {
+                stole = ranges_[(self + offset) % ranges_.size()].stealBack(task);
+            }
+            if (!stole) {
+                return;
+            }
+            body_(self, task);
+        }
+    }
+
+    std::vector<TaskRange> ranges_;
+    TaskBody body_;
+    std::vector<std::thread> threads_;
+};
+
+/**
+ * Estimate the memory a module needs while a command processes it, from
+ * its file size. The decoded AST is several times the binary (instruction
+ * vectors, types, names); instantiation adds the VM's instances and store,
+ * and AOT compilation adds LLVM's IR. The factors are deliberately rough
+ * upper-end figures: they only have to rank modules and keep a mixed batch
+ * under --max-memory.
+ *
+ * @param command  Command name
+ * @param fileSize Module size in bytes
+ * @return Estimated peak footprint in bytes
+ */
+uint64_t estimateModuleFootprint(std::string_view command, uint64_t fileSize) {
+    constexpr uint64_t MODULE_BASE_FOOTPRINT = 1 << 20;  // Contexts, tables, per-module bookkeeping
+    uint64_t factor = 8;                                  // parse, validate, inspect: AST only
+    if (command == "INSTANTIATE" || command == "CHECK-ALL") {
+        factor = 12;
+    } else if (command == "COMPILE") {
+        factor = 32;
+    }
+    return MODULE_BASE_FOOTPRINT + fileSize * factor;
+}
+
+/**
+ * Memory-bounded task source for batch runs (--max-memory).
+ *
+ * Modules are handed out largest estimate first, so a huge file starts
+ * early instead of stalling the end of the run, and a task only starts if
+ * the estimated in-flight total stays within the limit. When the largest
+ * pending module does not fit yet, workers backfill with modules that
+ * fit in the free memory, up to 1/16 of its estimate in total. Small
+ * modules keep cores busy, and once that budget is spent nothing else
+ * starts, so in-flight work drains and the large module cannot be
+ * starved. A module estimated above the whole limit runs once nothing
+ * else is in flight.
+ */
+class MemoryScheduler {
+public:
+    /**
+     * Estimate every input (one stat each)
+     *
+     * @param command Command name
+     * @param inputs  Batch input list
+     * @param limit   In-flight limit in bytes
+     */
+    MemoryScheduler(std::string_view command, const std::vector<std::string>& inputs,
+                    uint64_t limit)
+        : limit_(limit) {
+        for (size_t task = 0; task < inputs.size(); task++) {
+            uint64_t size = 0;
+#if defined(__unix__) || defined(__APPLE__)
+            struct stat info {};
+            if (::stat(inputs[task].c_str(), &info) == 0 && S_ISREG(info.st_mode)) {
+                size = static_cast<uint64_t>(info.st_size);
+            }
+#else
+            std::error_code ec;
+            size = fs::is_regular_file(inputs[task], ec) ? fs::file_size(inputs[task], ec) : 0;
+            size = ec ? 0 : size;
+#endif
+            pending_.emplace(estimateModuleFootprint(command, size), task);
+        }
+    }
+
+    /**
+     * Take the next task, waiting while it would exceed the limit
+     *
+     * @param task   Receives the input index
+     * @param charge Receives the estimate to pass back to release()
+     * @return false once every task has been handed out
+     */
+    bool next(size_t& task, uint64_t& charge) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            if (pending_.empty()) {
+                return false;
+            }
+            uint64_t head = std::prev(pending_.end())->first;
+            auto headTask = pending_.lower_bound(head);  // Equal estimates keep input order
+            auto chosen = pending_.end();
+            bool backfill = false;
+            if (inFlight_ == 0 || inFlight_ + head <= limit_) {
+                chosen = headTask;
+            } else {
+                if (headTask->second != blockedTask_) {  // A new head is blocked: fresh budget
+                    blockedTask_ = headTask->second;
+                    backfilled_ = 0;
+                }
+                uint64_t budget = head / 16 - std::min(backfilled_, head / 16);
+                uint64_t room = std::min(limit_ > inFlight_ ? limit_ - inFlight_ : 0, budget);
+                auto fit = pending_.upper_bound(room);
+                if (fit != pending_.begin()) {
+                    chosen = pending_.lower_bound(std::prev(fit)->first);
+                    backfill = true;
+                }
+            }
+            if (chosen != pending_.end()) {
+                charge = chosen->first;
+                backfilled_ += backfill ? charge : 0;
+                task = chosen->second;
+                pending_.erase(chosen);
+                inFlight_ += charge;
+                peakInFlight_ = std::max(peakInFlight_, inFlight_);
+                return true;
+            }
+            auto start = std::chrono::steady_clock::now();
+            releasedCv_.wait(lock);
+            waitNs_ += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count());
+        }
+    }
+
+    /**
+     * Return a finished task's estimate to the limit
+     *
+     * @param charge Estimate received from next()
+     */
+    void release(uint64_t charge) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        inFlight_ -= charge;
+        releasedCv_.notify_all();
+    }
+
+    /**
+     * Describe the run for --verbose
+     *
+     * @return One-line summary
+     */
+    std::string describe() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return "Memory scheduler: peak estimate " + std::to_string(peakInFlight_) + " of "
+            + std::to_string(limit_) + " byte(s) in flight, workers waited "
+            + std::to_string(waitNs_ / 1000000) + " ms for memory";
+    }
+
+private:
+    uint64_t limit_;
+    std::mutex mutex_;
+    std::condition_variable releasedCv_;
+    std::multimap<uint64_t, size_t> pending_;  // Estimate -> input index
+    size_t blockedTask_ = SIZE_MAX;            // Head task that backfilled_ is charged against
+    uint64_t backfilled_ = 0;                  // Estimates started while that head was blocked
+    uint64_t inFlight_ = 0;
+    uint64_t peakInFlight_ = 0;
+    uint64_t waitNs_ = 0;
+};
+
+/**
+ * Per-module output slot filled by a worker and drained by the printer
+ */
+struct ResultSlot {
+    ModuleResult record;
+    std::string rendered;  // JSON text rendered by the worker (--format json/ndjson)
+    std::string verbose;   // --verbose lines the worker printed for the module
+    std::atomic<bool> ready{false};
+};
+
+/**
+ * Resolve the effective worker count for a batch run
+ *
+ * @param taskCount Number of modules in the run
+ * @return Worker count: --jobs (0 = one per hardware thread), capped at taskCount
+ */
+size_t resolveJobs(size_t taskCount) {
+    size_t jobs = g_jobs;
+    if (jobs == 0) {
+        jobs = std::max(1u, std::thread::hardware_concurrency());
+    }
+    return std::max<size_t>(1, std::min(jobs, taskCount));
+}
+
+// ============================================================================
+// Prefetch - Reader stage overlapping module reads with parsing (--prefetch)
+// ============================================================================
+
+/**
+ * A module read ahead of the workers
+ */
+struct PrefetchedModule {
+    size_t task = 0;                   // Index into the batch input list
+    uint64_t charge = 0;               // MemoryScheduler estimate, released after processing
+    std::unique_ptr<uint8_t[]> bytes;  // Module bytes; empty if the worker opens the input itself
+    size_t size = 0;                   // Bytes read (charged to the in-flight budget)
+
+    std::string_view view() const {
+        return std::string_view(reinterpret_cast<const char*>(bytes.get()), size);
+    }
+};
+
+/**
+ * Pipelined reader stage for batch runs (--prefetch N).
+ *
+ * N reader threads claim inputs in order and read each file into its own
+ * buffer; workers take whichever module is ready first, so a slow read
+ * never holds up a worker while other modules are loaded. Readers block
+ * while the bytes read but not yet released by a worker would exceed the
+ * budget (--prefetch-budget), which bounds memory to roughly the budget
+ * plus one module. Inputs the reader cannot load as a regular file
+ * (missing, streams, oversized, read errors) are handed over empty, and
+ * the worker opens them itself so the usual error is reported. With
+ * --max-memory the readers take inputs from the MemoryScheduler instead,
+ * so reads follow its largest-first order and memory limit.
+ */
+class ModulePrefetcher {
+public:
+    /**
+     * Start the readers
+     *
+     * @param inputs    Batch input list (must outlive the prefetcher)
+     * @param readers   Reader thread count (>= 1)
+     * @param budget    Maximum bytes read ahead and not yet released
+     * @param scheduler Task source (nullptr = input order); charges are
+     *                  returned by the workers
+     */
+    ModulePrefetcher(const std::vector<std::string>& inputs, size_t readers, uint64_t budget,
+                     MemoryScheduler* scheduler)
+        : inputs_(inputs), budget_(std::max<uint64_t>(budget, 1)), scheduler_(scheduler),
+          pendingReaders_(readers) {
+        threads_.reserve(readers);
+        for (size_t i = 0; i < readers; i++) {
+            threads_.emplace_back([this] { readerLoop(); });
+        }
+    }
+
+    ~ModulePrefetcher() {
+        for (std::thread& thread : threads_) {
+            if (thread.joinable()) thread.join();
+        }
+    }
+
+    ModulePrefetcher(const ModulePrefetcher&) = delete;
+    ModulePrefetcher& operator=(const ModulePrefetcher&) = delete;
+
+    /**
+     * Take the next ready module, waiting for a reader if none is ready
+     *
+     * @param module Receives the module
+     * @return false once every input has been handed out
+     */
+    bool next(PrefetchedModule& module) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (ready_.empty() && pendingReaders_ > 0) {
+            auto start = std::chrono::steady_clock::now();
+            readyCv_.wait(lock, [&] { return !ready_.empty() || pendingReaders_ == 0; });
+            auto waited = std::chrono::steady_clock::now() - start;
+            workerWaitNs_ += static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(waited).count());
+        }
+        if (ready_.empty()) {
+            return false;
+        }
+        module = std::move(ready_.front());
+        ready_.pop_front();
+        return true;
+    }
+
+    /**
+     * Release a module's buffer and return its bytes to the budget
+     *
+     * @param module Module taken with next()
+     */
+    void release(PrefetchedModule& module) {
+        module.bytes.reset();
+        std::lock_guard<std::mutex> lock(mutex_);
+        inFlight_ -= module.size;
+        module.size = 0;
+        budgetCv_.notify_all();
+    }
+
+    /**
+     * Describe the run for --verbose: peak bytes in flight and the time
+     * readers spent blocked on the budget versus workers waiting for data
+     *
+     * @return One-line summary
+     */
+    std::string describe() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return "Prefetch: peak " + std::to_string(peakInFlight_) + " byte(s) in flight, "
+            + "readers waited " + std::to_string(readerWaitNs_ / 1000000) + " ms on the budget, "
+            + "workers waited "
+            + std::to_string(workerWaitNs_ / 1000000) + " ms for data";
+    }
+
+private:
+    void readerLoop() {
+        for (;;) {
+            PrefetchedModule module;
+            if (scheduler_) {
+                if (!scheduler_->next(module.task, module.charge)) {
+                    break;
+                }
+            } else if ((module.task = nextTask_.fetch_add(1)) >= inputs_.size()) {
+                break;
+            }
+            readModule(inputs_[module.task], module);
+            std::lock_guard<std::mutex> lock(mutex_);
+            ready_.push_back(std::move(module));
+            readyCv_.notify_one();
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--pendingReaders_ == 0) {
+            readyCv_.notify_all();
+        }
+    }
+
+    /**
+     * Reserve budget for a module, blocking while the budget is exhausted.
+     * A module larger than the whole budget proceeds once nothing else is
+     * in flight.
+     *
+     * @param size Module size in bytes
+     */
+    void reserve(size_t size) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (inFlight_ > 0 && inFlight_ + size > budget_) {
+            auto start = std::chrono::steady_clock::now();
+            budgetCv_.wait(lock, [&] { return inFlight_ == 0 || inFlight_ + size <= budget_; });
+            auto waited = std::chrono::steady_clock::now() - start;
+            readerWaitNs_ += static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(waited).count());
+        }
+        inFlight_ += size;
+        peakInFlight_ = std::max(peakInFlight_, inFlight_);
+    }
+
+    /**
+     * Undo a reservation for a read that failed
+     *
+     * @param size Reserved size in bytes
+     */
+    void unreserve(size_t size) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        inFlight_ -= size;
+        budgetCv_.notify_all();
+    }
+
+    /**
+     * Read a regular file into a new buffer charged to the budget
+     *
+     * @param path   Module path
+     * @param module Receives the bytes; left empty if the worker should
+     *               open the input itself
+     */
+    void readModule(const std::string& path, PrefetchedModule& module) {
+        uint64_t limit = g_maxModuleSize > 0 ? std::min<uint64_t>(g_maxModuleSize, UINT32_MAX)
+                                             : UINT32_MAX;
+#if defined(__unix__) || defined(__APPLE__)
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return;
+        }
+        struct stat info {};
+        if (::fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)
+            || static_cast<uint64_t>(info.st_size) > limit) {
+            ::close(fd);
+            return;
+        }
+        size_t size = static_cast<size_t>(info.st_size);
+        reserve(size);
+        std::unique_ptr<uint8_t[]> bytes(new (std::nothrow) uint8_t[std::max<size_t>(size, 1)]);
+        size_t done = 0;
+        while (bytes && done < size) {
+            ssize_t count = ::pread(fd, bytes.get() + done, size - done, static_cast<off_t>(done));
+            if (count < 0 && errno == EINTR) {
+                continue;
+            }
+            if (count <= 0) {
+                break;  // Read error, or the file shrank under us
+            }
+            done += static_cast<size_t>(count);
+        }
+        ::close(fd);
+#else
+        std::error_code ec;
+        if (!fs::is_regular_file(path, ec)) {
+            return;
+        }
+        uint64_t fileSize = fs::file_size(path, ec);
+        if (ec || fileSize > limit) {
+            return;
+        }
+        size_t size = static_cast<size_t>(fileSize);
+        reserve(size);
+        std::unique_ptr<uint8_t[]> bytes(new (std::nothrow) uint8_t[std::max<size_t>(size, 1)]);
+        std::ifstream file(path, std::ios::binary);
+        size_t done = 0;
+        if (bytes && file.read(reinterpret_cast<char*>(bytes.get()),
+                               static_cast<std::streamsize>(size))) {
+            done = size;
+        }
+#endif
+        if (!bytes || done != size) {
+            unreserve(size);
+            return;
+        }
+        module.bytes = std::move(bytes);
+        module.size = size;
+    }
+
+    const std::vector<std::string>& inputs_;
+    uint64_t budget_;
+    MemoryScheduler* scheduler_;
+    std::atomic<size_t> nextTask_{0};
+    std::mutex mutex_;
+    std::condition_variable readyCv_;    // A module became ready, or the readers finished
+    std::condition_variable budgetCv_;   // Bytes were released
+    std::deque<PrefetchedModule> ready_;
+    size_t pendingReaders_;
+    uint64_t inFlight_ = 0;
+    uint64_t peakInFlight_ = 0;
+    uint64_t readerWaitNs_ = 0;
+    uint64_t workerWaitNs_ = 0;
+    std::vector<std::thread> threads_;
+};
+
+// ============================================================================
+// Batch Mode - Input expansion and per-run summary
+// ============================================================================
+
+/**
+ * Read a list file (one path per line; blank lines and '#' comments skipped)
+ * 
+ * @param listPath Path to the list file
+ * @param inputs   Output vector receiving the listed paths
+ * @return true if the list file was read, false otherwise
+ */
+bool readListFile(const std::string& listPath, std::vector<std::string>& inputs) {
+    std::ifstream listFile(listPath);
+    if (!listFile) {
+        std::cerr << "Error: Cannot read list file: " << listPath << "\n";
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(listFile, line)) {
+        // Trim trailing CR (lists produced on Windows) and surrounding blanks
+        size_t begin = line.find_first_not_of(" \t");
+        size_t end = line.find_last_not_of(" \t\r");
+        if (begin == std::string::npos || line[begin] == '#') {
+            continue;
+        }
+        inputs.push_back(line.substr(begin, end - begin + 1));
+    }
+    return true;
+}
+
+/**
+ * Expand command-line inputs into a flat list of module paths.
+ * Plain paths are kept as-is, directories are searched recursively for
+ * .wasm files (sorted for stable output), and '@file' reads a list file.
+ * 
+ * @param args   Positional arguments following the command
+ * @param inputs Output vector receiving the module paths
+ * @return true on success, false if a list file could not be read
+ */
+bool collectInputs(const std::vector<std::string>& args, std::vector<std::string>& inputs) {
+    for (const std::string& arg : args) {
+        if (arg.size() > 1 && arg[0] == '@') {
+            if (!readListFile(arg.substr(1), inputs)) {
+                return false;
+            }
+            continue;
+        }
+
+        std::error_code ec;
+        if (fs::is_directory(arg, ec)) {
+            std::vector<std::string> found;
+            for (fs::recursive_directory_iterator it(arg, ec), end; !ec && it != end;
+                 it.increment(ec)) {
+                if (it->is_regular_file(ec)) {
+                    std::string path = it->path().string();
+                    if (hasWasmExtension(path)) {
+                        found.push_back(std::move(path));
+                    }
+                }
+            }
+            std::sort(found.begin(), found.end());
+            inputs.insert(inputs.end(), found.begin(), found.end());
+            continue;
+        }
+
+        inputs.push_back(arg);
+    }
+    return true;
+}
+
+/**
+ * Print the summary record closing a batch run
+ * 
+ * @param command  Command name
+ * @param total    Number of modules processed
+ * @param passed   Number of modules that passed
+ * @param failed   Number of modules rejected by WasmEdge
+ * @param missing  Number of modules that could not be read
+ */
+void printSummary(std::string_view command, size_t total, size_t passed,
+                  size_t failed, size_t missing) {
+    std::cout << "[SUMMARY]\n"
+              << "Command: " << command << "\n"
+              << "Files  : " << total << "\n"
+              << "Passed : " << passed << "\n"
+              << "Failed : " << failed << "\n"
+              << "Missing: " << missing << "\n";
+}
+
+/**
+ * Running pass/fail counts for a batch run
+ */
+struct BatchTally {
+    size_t passed = 0;
+    size_t failed = 0;
+    size_t missing = 0;
+    std::vector<PhaseSample> phaseTotals;  // Per-phase sums (--profile)
+    std::vector<size_t> phaseCounts;
+
+    /**
+     * Count one module result
+     *
+     * @param record Result record to count
+     */
+    void add(const ModuleResult& record) {
+        for (const PhaseSample& sample : record.phases) {
+            size_t i = 0;
+            while (i < phaseTotals.size() && phaseTotals[i].phase != sample.phase) {
+                i++;
+            }
+            if (i == phaseTotals.size()) {
+                phaseTotals.push_back(PhaseSample{sample.phase});
+                phaseCounts.push_back(0);
+            }
+            phaseTotals[i].wallNs += sample.wallNs;
+            phaseTotals[i].cpuNs += sample.cpuNs;
+            phaseTotals[i].rssDeltaKb += sample.rssDeltaKb;
+            phaseTotals[i].allocs += sample.allocs;
+            phaseCounts[i]++;
+        }
+
+        if (record.exitCode == EXIT_OK) {
+            passed++;
+        } else if (record.exitCode == EXIT_CLI_ERROR) {
+            missing++;
+        } else {
+            failed++;
+        }
+    }
+
+    /**
+     * Exit code summarizing the whole run:
+     *   EXIT_OK            - every module passed
+     *   EXIT_RUNTIME_ERROR - at least one module was rejected by WasmEdge
+     *   EXIT_CLI_ERROR     - no WasmEdge failures, but some inputs were unreadable
+     *
+     * @return Exit code for the run
+     */
+    int exitCode() const {
+        if (failed > 0) {
+            return EXIT_RUNTIME_ERROR;
+        }
+        return missing > 0 ? EXIT_CLI_ERROR : EXIT_OK;
+    }
+};
+
+/**
+ * Render the summary of a batch run as one JSON object
+ *
+ * @param command Command name
+ * @param total   Number of modules processed
+ * @param tally   Tally of module outcomes
+ * @return JSON text (phase totals included when --profile is enabled)
+ */
+std::string renderSummaryJson(std::string_view command, size_t total, const BatchTally& tally) {
+    std::string json = "{\"type\":\"summary\",\"command\":\"";
+    json += command;
+    json += "\",\"files\":" + std::to_string(total);
+    json += ",\"passed\":" + std::to_string(tally.passed);
+    json += ",\"failed\":" + std::to_string(tally.failed);
+    json += ",\"missing\":" + std::to_string(tally.missing);
+    json += ",\"exit_code\":" + std::to_string(tally.exitCode());
+    if (!tally.phaseTotals.empty()) {
+        json += ",\"phase_totals\":[";
+        for (size_t i = 0; i < tally.phaseTotals.size(); i++) {
+            const PhaseSample& sample = tally.phaseTotals[i];
+            if (i > 0) json += ",";
+            json += "{\"phase\":\"";
+            json += sample.phase;
+            json += "\",\"count\":" + std::to_string(tally.phaseCounts[i]);
+            json += ",\"wall_ns\":" + std::to_string(sample.wallNs);
+            json += ",\"cpu_ns\":" + std::to_string(sample.cpuNs);
+            json += ",\"process_rss_delta_kb\":" + std::to_string(sample.rssDeltaKb);
+            json += ",\"allocs\":" + std::to_string(sample.allocs);
+            json += "}";
+        }
+        json += "]";
+        json += ",\"peak_rss_kb\":" + std::to_string(peakRssKb());
+    }
+    json += "}";
+    return json;
+}
+
+/**
+ * Run one module through the scanner, the verdict cache and a handler,
+ * reporting unreadable inputs as records
+ *
+ * @param session  Session owning the reusable contexts
+ * @param handler  Per-module handler
+ * @param command  Command name
+ * @param filename Path to the .wasm file
+ * @return Result record for the module
+ */
+ModuleResult processModule(Session& session, ModuleHandler handler,
+                           std::string_view command, const std::string& filename) {
+    bool stream = !session.hasInlineModule() && isStreamInput(filename);
+    if (!session.hasInlineModule() && !stream && !fileExists(filename)) {
+        return makeInputError(command, filename, "File not found");
+    }
+    session.phases().clear();
+    auto start = std::chrono::steady_clock::now();
+    ModuleResult record;
+
+    // Streams are read to EOF once; every later stage reads the arena
+    std::optional<std::string_view> streamBytes;
+    if (stream) {
+        std::string_view error;
+        streamBytes = readStreamInput(session, filename, error);
+        if (!streamBytes) {
+            record = makeInputError(command, filename, error);
+            record.phases = std::move(session.phases());
+            return record;
+        }
+    }
+    std::optional<InlineModuleScope> streamed;
+    if (streamBytes) {
+        streamed.emplace(session, *streamBytes);
+    }
+    MappedModule module;
+    // inspect scans the module itself to record its section layout
+    if (command == "INSPECT" || scanModuleInput(session, command, filename, module, record)) {
+        InlineModuleScope shared(session, module);  // Later stages reuse the scanned mapping
+        record = runWithVerdictCache(session, handler, command, filename);
+    }
+    record.wallNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+    record.phases = std::move(session.phases());
+    return record;
+}
+
+/**
+ * Run a sub-command over many modules on the calling thread
+ * 
+ * @param command Command name (PARSE, VALIDATE, INSTANTIATE)
+ * @param handler Per-module handler
+ * @param inputs  Module paths to process
+ * @return Tally of module outcomes
+ */
+BatchTally runSequential(std::string_view command, ModuleHandler handler,
+                         const std::vector<std::string>& inputs, RecordWriter& writer) {
+    VMPool vmPool(1);
+    Session session;
+    session.setVMPool(&vmPool);
+    BatchTally tally;
+
+    std::string rendered;  // Reused: after the first few records it stops reallocating
+    for (const std::string& filename : inputs) {
+        ModuleResult record = processModule(session, handler, command, filename);
+        rendered.clear();
+        if (g_format == OutputFormat::Json || g_format == OutputFormat::Ndjson) {
+            appendRecordJson(rendered, record);
+        }
+        writer.write(record, rendered);
+        tally.add(record);
+    }
+    return tally;
+}
+
+/**
+ * Run a sub-command over many modules on a work-stealing pool.
+ * 
+ * Every worker owns its own Session, so parser and validator contexts are
+ * never shared between threads; VM contexts come from one pool sized by
+ * the worker count. Workers publish records (and, for JSON
+ * formats, their rendered text) into per-module slots, capturing their
+ * --verbose lines into the slot as well; the calling thread is the only
+ * writer of records and emits each slot's verbose lines and record in
+ * input order as they become ready. With --prefetch, a ModulePrefetcher feeds the
+ * workers instead of the work-stealing pool; with --max-memory, a
+ * MemoryScheduler picks the order (through the prefetcher, if any).
+ * 
+ * @param command Command name (PARSE, VALIDATE, INSTANTIATE)
+ * @param handler Per-module handler
+ * @param inputs  Module paths to process
+ * @param jobs    Number of worker threads
+ * @param writer  Record writer (used only by the calling thread)
+ * @return Tally of module outcomes
+ */
+BatchTally runParallel(std::string_view command, ModuleHandler handler,
+                       const std::vector<std::string>& inputs, size_t jobs,
+                       RecordWriter& writer) {
+    VMPool vmPool(jobs);
+    std::vector<Session> sessions(jobs);
+    for (Session& session : sessions) {
+        session.setVMPool(&vmPool);
+    }
+    std::vector<ResultSlot> slots(inputs.size());
+    std::atomic<size_t> awaited{0};
+    std::mutex wakeMutex;
+    std::condition_variable wakeCv;
+
+    auto publish = [&](size_t task) {
+        ResultSlot& slot = slots[task];
+        if (g_format == OutputFormat::Json || g_format == OutputFormat::Ndjson) {
+            slot.rendered = renderRecordJson(slot.record);
+        }
+        slot.ready.store(true);
+
+        // Only the worker finishing the slot the printer waits on wakes it
+        if (awaited.load() == task) {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            wakeCv.notify_one();
+        }
+    };
+
+    // With --prefetch, workers take modules in the order the readers finish
+    // them; with --max-memory alone they ask the memory scheduler; otherwise
+    // they split the input list and steal from each other
+    std::optional<MemoryScheduler> scheduler;
+    if (g_maxMemory > 0) {
+        scheduler.emplace(command, inputs, g_maxMemory);
+    }
+    std::optional<ModulePrefetcher> prefetcher;
+    std::optional<WorkStealingPool> pool;
+    std::vector<std::thread> workers;
+    if (g_prefetchReaders > 0) {
+        prefetcher.emplace(inputs, g_prefetchReaders, g_prefetchBudget,
+                           scheduler ? &*scheduler : nullptr);
+        workers.reserve(jobs);
+        for (size_t worker = 0; worker < jobs; worker++) {
+            workers.emplace_back([&, worker] {
+                PrefetchedModule module;
+                while (prefetcher->next(module)) {
+                    {
+                        VerboseCapture capture(slots[module.task].verbose);
+                        std::optional<InlineModuleScope> prefetched;
+                        if (module.bytes) {
+                            prefetched.emplace(sessions[worker], module.view());
+                        }
+                        slots[module.task].record =
+                            processModule(sessions[worker], handler, command, inputs[module.task]);
+                    }
+                    prefetcher->release(module);
+                    if (scheduler) {
+                        scheduler->release(module.charge);
+                    }
+                    publish(module.task);
+                }
+            });
+        }
+    } else if (scheduler) {
+        workers.reserve(jobs);
+        for (size_t worker = 0; worker < jobs; worker++) {
+            workers.emplace_back([&, worker] {
+                size_t task = 0;
+                uint64_t charge = 0;
+                while (scheduler->next(task, charge)) {
+                    {
+                        VerboseCapture capture(slots[task].verbose);
+                        slots[task].record =
+                            processModule(sessions[worker], handler, command, inputs[task]);
+                    }
+                    scheduler->release(charge);
+                    publish(task);
+                }
+            });
+        }
+    } else {
+        pool.emplace(jobs, inputs.size(), [&](size_t worker, size_t task) {
+            {
+                VerboseCapture capture(slots[task].verbose);
+                slots[task].record =
+                    processModule(sessions[worker], handler, command, inputs[task]);
+            }
+            publish(task);
+        });
+    }
+
+    BatchTally tally;
+    for (size_t i = 0; i < slots.size(); i++) {
+        awaited.store(i);
+        if (!slots[i].ready.load()) {
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wakeCv.wait(lock, [&] { return slots[i].ready.load(); });
+        }
+        if (!slots[i].verbose.empty()) {
+            writeVerbose(slots[i].verbose);
+        }
+        writer.write(slots[i].record, slots[i].rendered);
+        tally.add(slots[i].record);
+        slots[i].record = ModuleResult{};  // Release the record once printed
+        slots[i].rendered = std::string();
+        slots[i].verbose = std::string();
+    }
+
+    if (pool) {
+        pool->join();
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    if (prefetcher) {
+        printVerbose(prefetcher->describe());
+    }
+    if (scheduler) {
+        printVerbose(scheduler->describe());
+    }
+    return tally;
+}
+
+/**
+ * Run a sub-command over many modules and print the closing summary
+ * 
+ * @param command Command name (PARSE, VALIDATE, INSTANTIATE)
+ * @param handler Per-module handler
+ * @param inputs  Module paths to process
+ * @return Exit code for the whole run (see BatchTally::exitCode)
+ */
+int runBatch(std::string_view command, ModuleHandler handler,
+             const std::vector<std::string>& inputs) {
+    size_t jobs = resolveJobs(inputs.size());
+    printVerbose("WasmEdge version: ", WasmEdge_VersionGet());
+    printVerbose("Batch mode: ", inputs.size(), " module(s), ", jobs, " job(s)");
+
+    RecordWriter writer;
+    BatchTally tally = jobs > 1 || g_prefetchReaders > 0 || g_maxMemory > 0
+        ? runParallel(command, handler, inputs, jobs, writer)
+        : runSequential(command, handler, inputs, writer);
+
+    if (g_format == OutputFormat::Text) {
+        printSummary(command, inputs.size(), tally.passed, tally.failed, tally.missing);
+    }
+    writer.finish(renderSummaryJson(command, inputs.size(), tally));
+    if (g_profile && (g_format == OutputFormat::Text || !g_profileOut.empty())) {
+        printProfileTotals(command, tally.phaseTotals, tally.phaseCounts);
+    }
+    return tally.exitCode();
+}
+
+/**
+ * Run a sub-command against a single module, preserving the original
+ * single-file output and exit codes
+ * 
+ * @param command  Command name (PARSE, VALIDATE, INSTANTIATE, COMPILE)
+ * @param handler  Per-module handler
+ * @param filename Path to the .wasm file
+ * @return Exit code (EXIT_OK, EXIT_CLI_ERROR or EXIT_RUNTIME_ERROR)
+ */
+int runSingle(std::string_view command, ModuleHandler handler, const std::string& filename) {
+    // Validate file before processing
+    if (!validateFile(filename)) {
+        return EXIT_CLI_ERROR;
+    }
+    
+    printVerbose("File validation passed.");
+    printVerbose("WasmEdge version: ", WasmEdge_VersionGet());
+
+    Session session;
+    ModuleResult record = processModule(session, handler, command, filename);
+    RecordWriter writer;
+    bool json = g_format == OutputFormat::Json || g_format == OutputFormat::Ndjson;
+    writer.write(record, json ? renderRecordJson(record) : std::string());
+    writer.finish(std::string_view());
+    return record.exitCode;
+}
+
+// ============================================================================
+// Sampling Profiler - Guest function samples for run (--sample-profile)
+// ============================================================================
+
+constexpr std::string_view SAMPLE_HOOK_MODULE = "wasm-mini:sample";  // Host module of the hook
+constexpr std::string_view SAMPLE_HOOK_FUNCTION = "enter";          // Hook import: (i32) -> ()
+constexpr int32_t SAMPLE_NONE = -1;  // Published index outside instrumented functions
+
+/**
+ * Index of a function once the hook import is added. The hook is imported
+ * after the module's own function imports, so every defined function
+ * moves up by one.
+ *
+ * @param index             Function index in the original module
+ * @param importedFunctions Function imports of the original module
+ * @return Function index in the instrumented module
+ */
+uint32_t shiftFunctionIndex(uint32_t index, uint32_t importedFunctions) {
+    return index < importedFunctions ? index : index + 1;
+}
+
+/**
+ * Copy a constant expression up to and including its end, renumbering
+ * ref.func operands (see shiftFunctionIndex)
+ *
+ * @param in                Reader positioned at the first instruction
+ * @param out               Receives the copy
+ * @param importedFunctions Function imports of the original module
+ * @return false on a truncated expression or a non-constant opcode
+ */
+bool rewriteConstExpr(WasmReader& in, std::string& out, uint32_t importedFunctions) {
+    const uint8_t* copied = in.position();
+    auto flush = [&] {
+        out.append(reinterpret_cast<const char*>(copied),
+                   static_cast<size_t>(in.position() - copied));
+        copied = in.position();
+    };
+    while (in.ok()) {
+        switch (in.byte()) {
+        case 0x0B:  // end
+            flush();
+            return in.ok();
+        case 0x41: case 0x42: case 0xD0:  // i32.const, i64.const, ref.null
+            in.skipLeb();
+            break;
+        case 0x43:
+            in.skip(4);
+            break;
+        case 0x44:
+            in.skip(8);
+            break;
+        case 0x23:  // global.get
+            in.u32();
+            break;
+        case 0xD2:  // ref.func
+            flush();
+            appendVarU32(out, shiftFunctionIndex(in.u32(), importedFunctions));
+            copied = in.position();
+            break;
+        case 0x6A: case 0x6B: case 0x6C: case 0x7C: case 0x7D: case 0x7E:  // Extended constants
+            break;
+        case 0xFD:  // v128.const
+            if (in.u32() != 0x0C) return false;
+            in.skip(16);
+            break;
+        default:
+            return false;
+        }
+    }
+    return false;
+}
+
+/**
+ * Copy one function body's instructions up to and including its closing
+ * end, inserting the sampler's restore sequence (publish the function's
+ * own index through the hook) wherever control comes back to the function
+ * from another one: after call, call_indirect and call_ref, at the start
+ * of a legacy catch or catch_all handler, and where a try_table catch
+ * lands (after the end of the target block, or at the top of a target
+ * loop). Tail calls need nothing, because the callee sets the global
+ * itself and never returns here. Covers the instruction set WasmEdge
+ * enables (MVP, sign extension, saturating conversions, bulk memory,
+ * reference types, SIMD, tail calls, threads, legacy and new exception
+ * handling, typed function references). The operands of call,
+ * return_call and ref.func are renumbered for the hook import (see
+ * shiftFunctionIndex).
+ *
+ * @param in                Reader positioned at the first instruction
+ * @param out               Receives the copy
+ * @param restore           Restore sequence to insert
+ * @param importedFunctions Function imports of the original module
+ * @return false on a truncated sequence or an unknown opcode (GC)
+ */
+bool rewriteInstructions(WasmReader& in, std::string& out, std::string_view restore,
+                         uint32_t importedFunctions) {
+    const uint8_t* copied = in.position();
+    auto flush = [&](const uint8_t* upto) {
+        out.append(reinterpret_cast<const char*>(copied), static_cast<size_t>(upto - copied));
+        copied = upto;
+    };
+    auto restoreHere = [&] {
+        flush(in.position());
+        out += restore;
+    };
+    auto shiftFunction = [&] {
+        flush(in.position());
+        appendVarU32(out, shiftFunctionIndex(in.u32(), importedFunctions));
+        copied = in.position();
+    };
+    struct Block {
+        size_t loopBody = SIZE_MAX;  // Output offset of a loop's first instruction
+        bool caught = false;         // A try_table catch branches to this block
+    };
+    std::vector<Block> blocks;
+    while (in.ok()) {
+        uint8_t opcode = in.byte();
+        switch (opcode) {
+        case 0x02: case 0x04: case 0x06:  // block, if, try
+            in.skipBlockType();
+            blocks.emplace_back();
+            break;
+        case 0x03:  // loop
+            in.skipBlockType();
+            flush(in.position());
+            blocks.push_back(Block{out.size(), false});
+            break;
+        case 0x1F: {  // try_table: catch labels count from the enclosing block
+            in.skipBlockType();
+            for (uint32_t n = in.u32(); n > 0 && in.ok(); n--) {
+                if (in.byte() < 2) in.u32();  // catch / catch_ref: tag
+                uint32_t label = in.u32();
+                if (label >= blocks.size()) continue;  // Leaves the function: the caller restores
+                size_t target = blocks.size() - 1 - label;
+                if (blocks[target].caught) continue;
+                blocks[target].caught = true;
+                if (blocks[target].loopBody != SIZE_MAX) {
+                    flush(in.position());
+                    out.insert(blocks[target].loopBody, restore);
+                    for (size_t inner = target + 1; inner < blocks.size(); inner++) {
+                        if (blocks[inner].loopBody != SIZE_MAX) {
+                            blocks[inner].loopBody += restore.size();
+                        }
+                    }
+                }
+            }
+            blocks.emplace_back();
+            break;
+        }
+        case 0x0B: {  // end
+            if (blocks.empty()) {
+                flush(in.position());
+                return in.ok();
+            }
+            Block block = blocks.back();
+            blocks.pop_back();
+            if (block.caught && block.loopBody == SIZE_MAX) restoreHere();
+            break;
+        }
+        case 0x18:  // delegate: ends a legacy try block
+            in.u32();
+            if (blocks.empty()) return false;
+            blocks.pop_back();
+            break;
+        case 0x10:  // call
+            shiftFunction();
+            restoreHere();
+            break;
+        case 0x14:  // call_ref
+            in.u32();
+            restoreHere();
+            break;
+        case 0x11:  // call_indirect
+            in.u32();
+            in.u32();
+            restoreHere();
+            break;
+        case 0x07:  // catch
+            in.u32();
+            restoreHere();
+            break;
+        case 0x19:  // catch_all
+            restoreHere();
+            break;
+        case 0x12: case 0xD2:  // return_call, ref.func
+            shiftFunction();
+            break;
+        case 0x08: case 0x09: case 0x15:  // throw, rethrow, return_call_ref
+        case 0x0C: case 0x0D:  // br, br_if
+        case 0x20: case 0x21: case 0x22: case 0x23: case 0x24:  // local.*, global.*
+        case 0x25: case 0x26: case 0x3F: case 0x40:  // table.get/set, memory.size/grow
+        case 0xD5: case 0xD6:  // br_on_null, br_on_non_null
+            in.u32();
+            break;
+        case 0x0E:  // br_table
+            for (uint32_t n = in.u32(); n > 0 && in.ok(); n--) in.u32();
+            in.u32();
+            break;
+        case 0x13:  // return_call_indirect
+            in.u32();
+            in.u32();
+            break;
+        case 0x1C:  // select t*
+            for (uint32_t n = in.u32(); n > 0 && in.ok(); n--) in.skipValType();
+            break;
+        case 0x41: case 0x42: case 0xD0:  // i32.const, i64.const, ref.null
+            in.skipLeb();
+            break;
+        case 0x43:
+            in.skip(4);
+            break;
+        case 0x44:
+            in.skip(8);
+            break;
+        case 0xFC: {  // Saturating conversions, bulk memory, tables
+            uint32_t op = in.u32();
+            if (op <= 7) break;
+            if (op > 17) return false;
+            in.u32();
+            if (op == 8 || op == 10 || op == 12 || op == 14) in.u32();
+            break;
+        }
+        case 0xFD: {  // SIMD
+            uint32_t op = in.u32();
+            if (op <= 0x0B || op == 0x5C || op == 0x5D) {
+                in.skipMemArg();
+            } else if (op == 0x0C || op == 0x0D) {
+                in.skip(16);  // v128.const, i8x16.shuffle
+            } else if (op >= 0x15 && op <= 0x22) {
+                in.skip(1);   // Lane index
+            } else if (op >= 0x54 && op <= 0x5B) {
+                in.skipMemArg();
+                in.skip(1);
+            }
+            break;
+        }
+        case 0xFE: {  // Threads
+            uint32_t op = in.u32();
+            if (op == 0x03) {
+                in.skip(1);  // atomic.fence
+            } else if (op <= 0x02 || (op >= 0x10 && op <= 0x4E)) {
+                in.skipMemArg();
+            } else {
+                return false;
+            }
+            break;
+        }
+        default:
+            if (opcode >= 0x28 && opcode <= 0x3E) {
+                in.skipMemArg();  // Loads and stores
+            } else if (!(opcode <= 0x01 || opcode == 0x05 || opcode == 0x0A || opcode == 0x0F
+                         || opcode == 0x1A || opcode == 0x1B
+                         || (opcode >= 0x45 && opcode <= 0xC4) || opcode == 0xD1
+                         || opcode == 0xD3 || opcode == 0xD4)) {
+                return false;
+            }
+            break;
+        }
+    }
+    return false;
+}
+
+/**
+ * A module rewritten for --sample-profile, with what the sampler needs to
+ * name its samples
+ */
+struct SamplingModule {
+    std::string bytes;               // Instrumented module
+    std::vector<std::string> names;  // Function names, by function index
+    std::vector<std::pair<std::string, uint32_t>> exports;  // Exported functions
+    uint32_t instrumented = 0;       // Defined functions instrumented
+};
+
+/**
+ * Instrument a module for sampling. The module gains a function import,
+ * SAMPLE_HOOK_MODULE.SAMPLE_HOOK_FUNCTION of type (i32) -> (), after its
+ * own function imports. Every defined function f calls the hook with its
+ * original index on entry, and again wherever control returns to it from
+ * another function (see rewriteInstructions), so the hook always hears of
+ * the innermost running guest function, across tail calls and caught
+ * exceptions too. Each exported function also gets a wrapper with the same
+ * type that calls it and then calls the hook with SAMPLE_NONE, so time back
+ * in the host is not charged to the guest; only exports are redirected to
+ * the wrappers. Defined functions move up one index for the import, so
+ * every function reference (calls, ref.func, exports, the start function,
+ * element segments, table and global initializers) is renumbered, and the
+ * name section, whose indices would be stale, is dropped after its names
+ * are read. Samples keep the original indices.
+ *
+ * @param data   Module bytes
+ * @param spans  Section layout from scanModule
+ * @param module Receives the instrumented module and function names
+ * @return Static description of the first problem, empty on success
+ */
+std::string_view instrumentForSampling(const uint8_t* data, const std::vector<SectionSpan>& spans,
+                                       SamplingModule& module) {
+    constexpr uint8_t TYPE_SECTION = 1;
+    constexpr uint8_t IMPORT_SECTION = 2;
+    std::vector<uint32_t> paramCounts;    // By type index
+    std::vector<uint32_t> functionTypes;  // By defined function
+    std::vector<std::string> importNames;
+    std::map<uint32_t, std::string> debugNames;  // Name section
+    uint32_t importedFunctions = 0;
+    std::vector<uint32_t> wrapperOf;       // By defined function: wrapper index, or UINT32_MAX
+    std::vector<uint32_t> wrapperTargets;  // By wrapper: defined function index it calls
+    uint32_t hookType = 0;
+    bool emittedType = false;
+    bool emittedImport = false;
+    std::string& out = module.bytes;
+    out.assign(reinterpret_cast<const char*>(data), 8);  // Magic and version
+
+    auto emitSection = [&out](uint8_t id, const std::string& payload) {
+        appendSectionHeader(out, id, payload.size());
+        out += payload;
+    };
+    auto appendHookImport = [&](std::string& payload) {
+        appendVarU32(payload, SAMPLE_HOOK_MODULE.size());
+        payload += SAMPLE_HOOK_MODULE;
+        appendVarU32(payload, SAMPLE_HOOK_FUNCTION.size());
+        payload += SAMPLE_HOOK_FUNCTION;
+        payload += '\x00';
+        appendVarU32(payload, hookType);
+    };
+    // Sections the hook needs, emitted at their place in the section order when absent
+    auto emitMissing = [&](int beforeRank) {
+        if (!emittedType && beforeRank > sectionRank(TYPE_SECTION)) {
+            emitSection(TYPE_SECTION, std::string("\x01\x60\x01\x7F\x00", 5));  // (i32) -> ()
+            hookType = 0;
+            emittedType = true;
+        }
+        if (!emittedImport && beforeRank > sectionRank(IMPORT_SECTION)) {
+            std::string payload(1, '\x01');
+            appendHookImport(payload);
+            emitSection(IMPORT_SECTION, payload);
+            emittedImport = true;
+        }
+    };
+
+    for (const SectionSpan& span : spans) {
+        const uint8_t* begin = data + span.offset;
+        const uint8_t* end = begin + span.size;
+        WasmReader in(begin, end);
+        auto copyFrom = [&](std::string& payload, const uint8_t* from) {
+            payload.append(reinterpret_cast<const char*>(from),
+                           static_cast<size_t>(in.position() - from));
+        };
+        auto shift = [&importedFunctions](uint32_t index) {
+            return shiftFunctionIndex(index, importedFunctions);
+        };
+        std::string payload;
+        if (span.id != 0) {
+            emitMissing(sectionRank(span.id));
+        }
+        switch (span.id) {
+        case 0: {  // Custom: function names from the "name" section (a malformed one is ignored)
+            WasmReader names(begin, end);
+            if (names.name() != "name") {
+                payload.assign(reinterpret_cast<const char*>(begin), span.size);
+                break;
+            }
+            while (names.ok() && !names.atEnd()) {
+                uint8_t id = names.byte();
+                uint32_t size = names.u32();
+                if (id != 1) {
+                    names.skip(size);
+                    continue;
+                }
+                for (uint32_t n = names.u32(); n > 0 && names.ok(); n--) {
+                    uint32_t index = names.u32();
+                    std::string_view text = names.name();
+                    if (names.ok()) debugNames[index] = std::string(text);
+                }
+            }
+            continue;  // Dropped: its function indices no longer match
+        }
+        case TYPE_SECTION: {  // Type: parameter counts for the wrappers, then the hook type
+            uint32_t count = in.u32();
+            const uint8_t* types = in.position();
+            for (uint32_t n = count; n > 0 && in.ok(); n--) {
+                if (in.byte() != 0x60) {
+                    return "Module uses GC type definitions";
+                }
+                uint32_t params = in.u32();
+                for (uint32_t i = 0; i < params; i++) in.skipValType();
+                for (uint32_t results = in.u32(); results > 0 && in.ok(); results--) {
+                    in.skipValType();
+                }
+                paramCounts.push_back(params);
+            }
+            appendVarU32(payload, uint64_t{count} + 1);
+            copyFrom(payload, types);
+            payload += std::string("\x60\x01\x7F\x00", 4);  // (i32) -> ()
+            hookType = count;
+            emittedType = true;
+            break;
+        }
+        case IMPORT_SECTION: {  // Import: function import count, then the hook import
+            uint32_t count = in.u32();
+            const uint8_t* imports = in.position();
+            for (uint32_t n = count; n > 0 && in.ok(); n--) {
+                std::string name(in.name());
+                name += '.';
+                name += in.name();
+                switch (in.byte()) {
+                case 0: in.u32(); importNames.push_back(std::move(name)); break;
+                case 1: in.skipValType(); in.skipLimits(); break;
+                case 2: in.skipLimits(); break;
+                case 3: in.skipValType(); in.byte(); break;
+                case 4: in.byte(); in.u32(); break;
+                default: return "Malformed import section";
+                }
+            }
+            importedFunctions = static_cast<uint32_t>(importNames.size());
+            appendVarU32(payload, uint64_t{count} + 1);
+            copyFrom(payload, imports);
+            appendHookImport(payload);
+            emittedImport = true;
+            break;
+        }
+        case 3: {  // Function: declare a wrapper per exported defined function
+            for (uint32_t n = in.u32(); n > 0 && in.ok(); n--) {
+                uint32_t type = in.u32();
+                if (type >= paramCounts.size()) {
+                    return "Malformed function section";
+                }
+                functionTypes.push_back(type);
+            }
+            uint32_t defined = static_cast<uint32_t>(functionTypes.size());
+            wrapperOf.assign(defined, UINT32_MAX);
+            for (const SectionSpan& exportSpan : spans) {
+                if (exportSpan.id != 7) continue;
+                const uint8_t* exportsBegin = data + exportSpan.offset;
+                WasmReader exports(exportsBegin, exportsBegin + exportSpan.size);
+                for (uint32_t n = exports.u32(); n > 0 && exports.ok(); n--) {
+                    exports.name();
+                    uint8_t kind = exports.byte();
+                    uint32_t index = exports.u32() - importedFunctions;
+                    if (kind == 0 && index < defined && wrapperOf[index] == UINT32_MAX) {
+                        // Wrappers follow the defined functions, after the hook import
+                        wrapperOf[index] = importedFunctions + 1 + defined
+                                         + static_cast<uint32_t>(wrapperTargets.size());
+                        wrapperTargets.push_back(index);
+                    }
+                }
+            }
+            appendVarU32(payload, uint64_t{defined} + wrapperTargets.size());
+            for (uint32_t type : functionTypes) appendVarU32(payload, type);
+            for (uint32_t target : wrapperTargets) appendVarU32(payload, functionTypes[target]);
+            break;
+        }
+        case 4: {  // Table: renumber ref.func in initializers
+            uint32_t count = in.u32();
+            appendVarU32(payload, count);
+            for (uint32_t i = 0; i < count && in.ok(); i++) {
+                const uint8_t* from = in.position();
+                bool initialized = from < end && *from == 0x40;
+                if (initialized) {
+                    in.byte();
+                    in.byte();
+                }
+                in.skipValType();
+                in.skipLimits();
+                copyFrom(payload, from);
+                if (initialized && !rewriteConstExpr(in, payload, importedFunctions)) {
+                    return "Malformed table section";
+                }
+            }
+            break;
+        }
+        case 6: {  // Global: renumber ref.func in initializers
+            uint32_t count = in.u32();
+            appendVarU32(payload, count);
+            for (uint32_t i = 0; i < count && in.ok(); i++) {
+                const uint8_t* from = in.position();
+                in.skipValType();
+                in.byte();
+                copyFrom(payload, from);
+                if (!rewriteConstExpr(in, payload, importedFunctions)) {
+                    return "Malformed global section";
+                }
+            }
+            break;
+        }
+        case 7: {  // Export: redirect defined functions to their wrappers
+            uint32_t count = in.u32();
+            appendVarU32(payload, count);
+            for (uint32_t i = 0; i < count && in.ok(); i++) {
+                const uint8_t* from = in.position();
+                std::string_view name = in.name();
+                uint8_t kind = in.byte();
+                copyFrom(payload, from);
+                uint32_t index = in.u32();
+                if (kind == 0) {
+                    module.exports.emplace_back(name, index);
+                    if (index >= importedFunctions
+                        && index - importedFunctions < wrapperOf.size()) {
+                        index = wrapperOf[index - importedFunctions];
+                    } else {
+                        index = shift(index);
+                    }
+                }
+                appendVarU32(payload, index);
+            }
+            break;
+        }
+        case 8:  // Start: renumber
+            appendVarU32(payload, shift(in.u32()));
+            break;
+        case 9: {  // Element: renumber function indices and ref.func in expressions
+            uint32_t count = in.u32();
+            appendVarU32(payload, count);
+            for (uint32_t i = 0; i < count && in.ok(); i++) {
+                const uint8_t* from = in.position();
+                uint32_t flags = in.u32();
+                if (flags > 7) {
+                    return "Malformed element section";
+                }
+                if (flags == 2 || flags == 6) in.u32();  // Table index
+                copyFrom(payload, from);
+                if ((flags & 1) == 0 && !rewriteConstExpr(in, payload, importedFunctions)) {
+                    return "Malformed element section";  // Active segment offset
+                }
+                from = in.position();
+                if (flags & 3) {
+                    if (flags & 4) {
+                        in.skipValType();  // Reference type
+                    } else {
+                        in.byte();         // Element kind
+                    }
+                }
+                uint32_t items = in.u32();
+                copyFrom(payload, from);
+                for (uint32_t item = 0; item < items && in.ok(); item++) {
+                    if ((flags & 4) == 0) {
+                        appendVarU32(payload, shift(in.u32()));
+                    } else if (!rewriteConstExpr(in, payload, importedFunctions)) {
+                        return "Malformed element section";
+                    }
+                }
+            }
+            break;
+        }
+        case 10: {  // Code: instrumented bodies, then the export wrappers
+            uint32_t count = in.u32();
+            if (count != functionTypes.size()) {
+                return "Function and code section counts differ";
+            }
+            uint32_t hook = importedFunctions;  // The hook import follows the module's own
+            appendVarU32(payload, uint64_t{count} + wrapperTargets.size());
+            for (uint32_t i = 0; i < count && in.ok(); i++) {
+                uint32_t size = in.u32();
+                const uint8_t* bodyStart = in.position();
+                in.skip(size);
+                if (!in.ok()) break;
+                WasmReader body(bodyStart, bodyStart + size);
+                for (uint32_t groups = body.u32(); groups > 0 && body.ok(); groups--) {
+                    body.u32();
+                    body.skipValType();
+                }
+                // i32.const f  call $hook: on entry, then wherever control comes back
+                std::string restore(1, '\x41');
+                appendVarS32(restore, static_cast<int32_t>(importedFunctions + i));
+                restore += '\x10';
+                appendVarU32(restore, hook);
+                std::string code(reinterpret_cast<const char*>(bodyStart),
+                                 static_cast<size_t>(body.position() - bodyStart));
+                code += restore;
+                if (!rewriteInstructions(body, code, restore, importedFunctions) || !body.atEnd()) {
+                    return "Cannot decode a function body";
+                }
+                appendVarU32(payload, code.size());
+                payload += code;
+            }
+            for (uint32_t target : wrapperTargets) {
+                // local.get 0..n-1  call f  i32.const -1  call $hook
+                uint32_t params = paramCounts[functionTypes[target]];
+                std::string code(1, '\x00');
+                for (uint32_t param = 0; param < params; param++) {
+                    code += '\x20';
+                    appendVarU32(code, param);
+                }
+                code += '\x10'; appendVarU32(code, shift(importedFunctions + target));
+                code += '\x41'; appendVarS32(code, SAMPLE_NONE);
+                code += '\x10'; appendVarU32(code, hook);
+                code += '\x0B';
+                appendVarU32(payload, code.size());
+                payload += code;
+            }
+            module.instrumented = count;
+            break;
+        }
+        default:  // Memory, tag, data count, data: unchanged
+            payload.assign(reinterpret_cast<const char*>(begin), span.size);
+            break;
+        }
+        if (!in.ok()) {
+            return "Malformed section";
+        }
+        emitSection(span.id, payload);
+    }
+    emitMissing(sectionRank(11) + 1);  // After every known section
+
+    // Names: name section, then export names, then import names
+    size_t total = importNames.size() + functionTypes.size();
+    module.names.resize(total);
+    for (auto it = module.exports.rbegin(); it != module.exports.rend(); ++it) {
+        if (it->second < total) module.names[it->second] = it->first;
+    }
+    for (size_t i = 0; i < importNames.size(); i++) {
+        module.names[i] = importNames[i];
+    }
+    for (auto& [index, name] : debugNames) {
+        if (index < total) module.names[index] = std::move(name);
+    }
+    for (size_t i = 0; i < total; i++) {
+        if (module.names[i].empty()) {
+            module.names[i] = "func[" + std::to_string(i) + "]";
+        }
+        // Frames are ';'-separated in folded stacks
+        std::replace(module.names[i].begin(), module.names[i].end(), ';', ':');
+    }
+    return std::string_view();
+}
+
+/**
+ * Host module answering the instrumentation's hook import. The guest calls
+ * the hook with the index of the function it enters or returns to, and the
+ * hook publishes it in an atomic, so the sampler thread never touches
+ * WasmEdge state while the guest runs.
+ */
+class SampleHook {
+public:
+    SampleHook() = default;
+
+    SampleHook(const SampleHook&) = delete;
+    SampleHook& operator=(const SampleHook&) = delete;
+
+    /**
+     * Create the host module with its one function
+     *
+     * @return false if WasmEdge cannot create the module or function
+     */
+    bool create() {
+        module_.reset(WasmEdge_ModuleInstanceCreate(WasmEdge_StringWrap(
+            SAMPLE_HOOK_MODULE.data(), static_cast<uint32_t>(SAMPLE_HOOK_MODULE.size()))));
+        if (!module_) {
+            return false;
+        }
+        WasmEdge_ValType param = WasmEdge_ValTypeGenI32();
+        WasmEdge_FunctionTypeContext* type = WasmEdge_FunctionTypeCreate(&param, 1, nullptr, 0);
+        if (!type) {
+            return false;
+        }
+        // Cost 0: the hook is not charged against --gas-limit
+        WasmEdge_FunctionInstanceContext* function =
+            WasmEdge_FunctionInstanceCreate(type, enter, &current_, 0);
+        WasmEdge_FunctionTypeDelete(type);
+        if (!function) {
+            return false;
+        }
+        WasmEdge_String name = WasmEdge_StringWrap(
+            SAMPLE_HOOK_FUNCTION.data(), static_cast<uint32_t>(SAMPLE_HOOK_FUNCTION.size()));
+        WasmEdge_ModuleInstanceAddFunction(module_.get(), name, function);  // The module owns it
+        return true;
+    }
+
+    const WasmEdge_ModuleInstanceContext* module() const { return module_.get(); }
+    const std::atomic<int32_t>& current() const { return current_; }
+
+private:
+    static WasmEdge_Result enter(void* data, const WasmEdge_CallingFrameContext*,
+                                 const WasmEdge_Value* params, WasmEdge_Value*) {
+        static_cast<std::atomic<int32_t>*>(data)->store(WasmEdge_ValueGetI32(params[0]),
+                                                         std::memory_order_relaxed);
+        return WasmEdge_Result_Success;
+    }
+
+    std::atomic<int32_t> current_{SAMPLE_NONE};
+    ModuleInstancePtr module_;
+};
+
+/**
+ * Samples the function index published by a SampleHook from a background
+ * thread at --sample-rate. The index is read with a relaxed atomic load;
+ * ordering against other guest state does not matter, because a sample
+ * only needs some recent value.
+ */
+class GuestSampler {
+public:
+    /**
+     * @param current   Index published by the hook
+     * @param functions Function count (imported + defined)
+     */
+    GuestSampler(const std::atomic<int32_t>& current, size_t functions)
+        : current_(current), counts_(functions, 0) {}
+    ~GuestSampler() { stop(); }
+
+    GuestSampler(const GuestSampler&) = delete;
+    GuestSampler& operator=(const GuestSampler&) = delete;
+
+    void start() {
+        stopping_ = false;
+        thread_ = std::thread([this] { loop(); });
+    }
+    void stop() {
+        stopping_ = true;
+        if (thread_.joinable()) thread_.join();
+    }
+
+    const std::vector<uint64_t>& counts() const { return counts_; }
+
+private:
+    void loop() {
+        using Clock = std::chrono::steady_clock;
+        const auto period =
+            std::chrono::nanoseconds(1000000000ull / std::max<size_t>(g_sampleRate, 1));
+        Clock::time_point next = Clock::now() + period;
+        while (!stopping_) {
+            std::this_thread::sleep_until(next);
+            next += period;
+            int32_t current = current_.load(std::memory_order_relaxed);
+            if (current >= 0 && static_cast<size_t>(current) < counts_.size()) {
+                counts_[static_cast<size_t>(current)]++;
+            }
+        }
+    }
+
+    const std::atomic<int32_t>& current_;
+    std::vector<uint64_t> counts_;  // Written by the sampling thread only until stop()
+    std::atomic<bool> stopping_{false};
+    std::thread thread_;
+};
+
+/**
+ * Write the samples of one export as folded stacks ("export;function
+ * count" lines, hottest first), the input format of flamegraph.pl and
+ * compatible viewers. Samples of the export's own function fold into the
+ * single frame "export".
+ *
+ * @param module     Instrumented module (names)
+ * @param exportName Export the samples were taken under
+ * @param counts     Samples by function index
+ * @param path       Output file
+ * @return false if the file cannot be written
+ */
+bool writeFoldedStacks(const SamplingModule& module, const std::string& exportName,
+                       const std::vector<uint64_t>& counts, const std::string& path) {
+    uint32_t root = UINT32_MAX;
+    for (const auto& [name, index] : module.exports) {
+        if (name == exportName) root = index;
+    }
+    std::vector<size_t> order;
+    for (size_t i = 0; i < counts.size(); i++) {
+        if (counts[i] > 0) order.push_back(i);
+    }
+    std::sort(order.begin(), order.end(),
+              [&counts](size_t a, size_t b) { return counts[a] > counts[b]; });
+
+    std::ofstream out(path, std::ios::out | std::ios::trunc);
+    std::string frame = exportName;
+    std::replace(frame.begin(), frame.end(), ';', ':');
+    for (size_t index : order) {
+        out << frame;
+        if (index != root) out << ';' << module.names[index];
+        out << ' ' << counts[index] << '\n';
+    }
+    return static_cast<bool>(out.flush());
+}
+
+/**
+ * Print the sample count and the hottest guest function of a run
+ *
+ * @param module Instrumented module (names)
+ * @param counts Samples by function index
+ */
+void printSampleReport(const SamplingModule& module, const std::vector<uint64_t>& counts) {
+    uint64_t total = std::accumulate(counts.begin(), counts.end(), uint64_t{0});
+    std::cout << "Sample : " << total << " at " << g_sampleRate << " Hz -> " << g_sampleProfile
+              << "\n";
+    if (total > 0) {
+        size_t hottest =
+            static_cast<size_t>(std::max_element(counts.begin(), counts.end()) - counts.begin());
+        char share[16];
+        std::snprintf(share, sizeof(share), "%.1f",
+                      static_cast<double>(counts[hottest]) * 100.0 / static_cast<double>(total));
+        std::cout << "Hot    : " << module.names[hottest] << " (" << share << "%)\n";
+    }
+}
+
+/**
+ * Instrument the run module for --sample-profile
+ *
+ * @param session  Session supplying the module bytes (inline or mapped)
+ * @param filename Path to the .wasm file
+ * @param source   Module mapping from the scan (opened here if empty)
+ * @param module   Receives the instrumented module
+ * @return Static description of the problem, empty on success
+ */
+std::string_view prepareSampling(Session& session, const std::string& filename,
+                                 MappedModule& source, SamplingModule& module) {
+    if (!source.data() && !session.openModule(source, filename)) {
+        return "Cannot read file";
+    }
+    PhaseTimer timer(session.phases(), "instrument");
+    std::vector<SectionSpan> spans;
+    ScanResult scan = scanModule(source.data(), source.size(), &spans);
+    if (!scan.ok) {
+        return scan.reason;
+    }
+    std::string_view error = instrumentForSampling(source.data(), spans, module);
+    if (error.empty() && module.bytes.size() > UINT32_MAX) {
+        error = "Instrumented module exceeds 4 GiB";
+    }
+    if (error.empty()) {
+        printVerbose("Instrumented ", module.instrumented, " functions for sampling");
+    }
+    return error;
+}
+
+// ============================================================================
+// Run Sub-command - Export invocation and call-latency benchmark
+// ============================================================================
+
+/**
+ * Convert a command-line argument into a WasmEdge_Value of the given type
+ * 
+ * @param text  Argument text
+ * @param type  Parameter type from the export's function type
+ * @param value Receives the converted value
+ * @return true on success, false if the text does not fit the type
+ */
+bool parseWasmValue(const std::string& text, WasmEdge_ValType type, WasmEdge_Value& value) {
+    const char* begin = text.c_str();
+    const char* end = begin + text.size();
+    if (WasmEdge_ValTypeIsI32(type)) {
+        // Accept both signed and unsigned 32-bit spellings
+        int64_t parsed = 0;
+        auto [ptr, ec] = std::from_chars(begin, end, parsed);
+        if (ec != std::errc() || ptr != end || parsed < INT32_MIN || parsed > UINT32_MAX) {
+            return false;
+        }
+        value = WasmEdge_ValueGenI32(static_cast<int32_t>(static_cast<uint32_t>(parsed)));
+        return true;
+    }
+    if (WasmEdge_ValTypeIsI64(type)) {
+        int64_t parsed = 0;
+        auto [ptr, ec] = std::from_chars(begin, end, parsed);
+        if (ec != std::errc() || ptr != end) {
+            return false;
+        }
+        value = WasmEdge_ValueGenI64(parsed);
+        return true;
+    }
+    if (WasmEdge_ValTypeIsF32(type) || WasmEdge_ValTypeIsF64(type)) {
+        char* parsedEnd = nullptr;
+        double parsed = std::strtod(begin, &parsedEnd);
+        if (text.empty() || parsedEnd != end) {
+            return false;
+        }
+        value = WasmEdge_ValTypeIsF32(type)
+            ? WasmEdge_ValueGenF32(static_cast<float>(parsed))
+            : WasmEdge_ValueGenF64(parsed);
+        return true;
+    }
+    return false;  // v128 and reference parameters are not supported from the CLI
+}
+
+/**
+ * Format a WasmEdge_Value returned by an export
+ * 
+ * @param value Returned value
+ * @return Human-readable value text
+ */
+std::string formatWasmValue(const WasmEdge_Value& value) {
+    std::ostringstream text;
+    if (WasmEdge_ValTypeIsI32(value.Type)) {
+        text << WasmEdge_ValueGetI32(value);
+    } else if (WasmEdge_ValTypeIsI64(value.Type)) {
+        text << WasmEdge_ValueGetI64(value);
+    } else if (WasmEdge_ValTypeIsF32(value.Type)) {
+        text << WasmEdge_ValueGetF32(value);
+    } else if (WasmEdge_ValTypeIsF64(value.Type)) {
+        text << WasmEdge_ValueGetF64(value);
+    } else if (WasmEdge_ValTypeIsRef(value.Type)) {
+        text << (WasmEdge_ValueIsNullRef(value) ? "ref.null" : "ref");
+    } else {
+        text << "<v128>";
+    }
+    return text.str();
+}
+
+/**
+ * Nearest-rank percentile of sorted samples
+ * 
+ * @param sorted     Samples in ascending order (non-empty)
+ * @param percentile Percentile in (0, 100]
+ * @return Sample at the requested rank
+ */
+uint64_t percentileOf(const std::vector<uint64_t>& sorted, double percentile) {
+    double scaled = percentile / 100.0 * static_cast<double>(sorted.size());
+    size_t rank = static_cast<size_t>(std::ceil(scaled));
+    return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+}
+
+/**
+ * Print the call-latency report of a benchmark run
+ * 
+ * @param samples Per-call latencies in nanoseconds
+ * @param totalNs Wall time of the timed loop in nanoseconds
+ */
+void printLatencyReport(std::vector<uint64_t>& samples, uint64_t totalNs) {
+    std::sort(samples.begin(), samples.end());
+    double mean = static_cast<double>(std::accumulate(samples.begin(), samples.end(), uint64_t{0}))
+                  / static_cast<double>(samples.size());
+    double callsPerSec = totalNs > 0
+        ? static_cast<double>(samples.size()) * 1e9 / static_cast<double>(totalNs) : 0.0;
+
+    std::cout << "Calls  : " << samples.size() << "\n"
+              << "Warmup : " << g_warmup << "\n"
+              << "Rate   : " << static_cast<uint64_t>(callsPerSec) << " calls/s\n"
+              << "Mean   : " << static_cast<uint64_t>(mean) << " ns\n"
+              << "Min    : " << samples.front() << " ns\n"
+              << "p50    : " << percentileOf(samples, 50.0) << " ns\n"
+              << "p99    : " << percentileOf(samples, 99.0) << " ns\n"
+              << "p999   : " << percentileOf(samples, 99.9) << " ns\n"
+              << "Max    : " << samples.back() << " ns\n";
+}
+
+/**
+ * Load an instruction cost table.
+ *
+ * The file has one "<opcode> <cost>" pair per line; opcodes are WasmEdge
+ * opcode values (decimal or 0x hex: single-byte opcodes are their byte,
+ * prefixed ones 0xFC00 | sub-opcode and so on). '#' starts a comment.
+ * Opcodes not listed cost 1, matching WasmEdge's default table.
+ *
+ * @param path  Cost table file
+ * @param table Receives the table
+ * @param error Receives a message when loading fails
+ * @return true on success
+ */
+bool loadCostTable(const std::string& path, std::vector<uint64_t>& table, std::string& error) {
+    std::ifstream in(path);
+    if (!in) {
+        error = "Cannot read cost table: " + path;
+        return false;
+    }
+    std::vector<std::pair<uint32_t, uint64_t>> entries;
+    std::string line;
+    for (size_t lineNo = 1; std::getline(in, line); lineNo++) {
+        std::string_view text(line);
+        text = text.substr(0, text.find('#'));
+        std::istringstream fields{std::string(text)};
+        std::string opcodeText;
+        std::string costText;
+        if (!(fields >> opcodeText)) {
+            continue;  // Blank or comment-only line
+        }
+        std::string rest;
+        std::string_view opcodeDigits(opcodeText);
+        int base = 10;
+        if (opcodeDigits.size() > 2
+            && (opcodeDigits.substr(0, 2) == "0x" || opcodeDigits.substr(0, 2) == "0X")) {
+            opcodeDigits.remove_prefix(2);
+            base = 16;
+        }
+        uint32_t opcode = 0;
+        uint64_t cost = 0;
+        const char* opcodeEnd = opcodeDigits.data() + opcodeDigits.size();
+        auto opcodeParse = std::from_chars(opcodeDigits.data(), opcodeEnd, opcode, base);
+        bool ok = static_cast<bool>(fields >> costText) && !(fields >> rest)
+                  && opcodeParse.ec == std::errc() && opcodeParse.ptr == opcodeEnd
+                  && opcode <= 0xFFFF;
+        if (ok) {
+            auto costParse =
+                std::from_chars(costText.data(), costText.data() + costText.size(), cost);
+            ok = costParse.ec == std::errc() && costParse.ptr == costText.data() + costText.size();
+        }
+        if (!ok) {
+            error = path + ":" + std::to_string(lineNo) + ": expected '<opcode> <cost>'";
+            return false;
+        }
+        entries.emplace_back(opcode, cost);
+    }
+    if (entries.empty()) {
+        error = "Cost table is empty: " + path;
+        return false;
+    }
+    table.assign(65536, 1);  // Covers every opcode value, so the VM never reads past the table
+    for (const auto& [opcode, cost] : entries) {
+        table[opcode] = cost;
+    }
+    return true;
+}
+
+/**
+ * Whether any statistics option is enabled
+ *
+ * @return true if run should report execution statistics
+ */
+bool statisticsEnabled() {
+    return g_countInstructions || g_measureCost || g_measureTime;
+}
+
+/**
+ * Install the cost table (--cost-table) on a VM's statistics context.
+ * Must run before instantiation so the start function is costed too.
+ *
+ * @param vmCtx VM context
+ */
+void applyCostTable(WasmEdge_VMContext* vmCtx) {
+    WasmEdge_StatisticsContext* stats = WasmEdge_VMGetStatisticsContext(vmCtx);
+    if (stats && !g_costTable.empty()) {
+        WasmEdge_StatisticsSetCostTable(stats, g_costTable.data(),
+                                        static_cast<uint32_t>(g_costTable.size()));
+    }
+}
+
+/**
+ * Allow the next call --gas-limit more cost units.
+ * WasmEdge checks the limit against the VM's accumulated cost, so raising
+ * it from the current total before every call makes the limit per call
+ * without clearing the counters.
+ *
+ * @param stats Statistics context of the VM (may be null)
+ */
+void armGasLimit(WasmEdge_StatisticsContext* stats) {
+    if (stats && g_gasLimit > 0) {
+        uint64_t spent = WasmEdge_StatisticsGetTotalCost(stats);
+        WasmEdge_StatisticsSetCostLimit(
+            stats, spent > UINT64_MAX - g_gasLimit ? UINT64_MAX : spent + g_gasLimit);
+    }
+}
+
+/**
+ * Counter values of a statistics context
+ */
+struct ExecutionStats {
+    uint64_t instructions = 0;
+    uint64_t cost = 0;
+};
+
+/**
+ * Read the counters of a statistics context
+ *
+ * @param stats Statistics context (may be null)
+ * @return Current instruction count and total cost
+ */
+ExecutionStats readStatistics(const WasmEdge_StatisticsContext* stats) {
+    if (!stats) {
+        return {};
+    }
+    return ExecutionStats{WasmEdge_StatisticsGetInstrCount(stats),
+                          WasmEdge_StatisticsGetTotalCost(stats)};
+}
+
+/**
+ * Print the execution statistics of the measured calls
+ *
+ * @param calls   Number of measured calls
+ * @param delta   Counter increase over the measured calls
+ * @param wallNs  Wall time of the measured calls in nanoseconds
+ * @param stats   Statistics context (for the VM-measured instruction rate)
+ */
+void printStatisticsReport(size_t calls, const ExecutionStats& delta, uint64_t wallNs,
+                           const WasmEdge_StatisticsContext* stats) {
+    double perCall = 1.0 / static_cast<double>(std::max<size_t>(calls, 1));
+    if (g_countInstructions) {
+        // --enable-time-measuring: WasmEdge's own execution timer; otherwise the wall clock
+        double instructions = static_cast<double>(delta.instructions);
+        double rate = g_measureTime && stats
+            ? WasmEdge_StatisticsGetInstrPerSecond(stats)
+            : (wallNs > 0 ? instructions * 1e9 / static_cast<double>(wallNs) : 0.0);
+        std::cout << "Instrs : " << static_cast<uint64_t>(instructions * perCall)
+                  << " per call (" << delta.instructions << " total)\n"
+                  << "IPS    : " << static_cast<uint64_t>(rate) << " instr/s\n";
+    }
+    if (g_measureCost) {
+        std::cout << "Cost   : " << static_cast<uint64_t>(static_cast<double>(delta.cost) * perCall)
+                  << " per call (" << delta.cost << " total)\n";
+    }
+}
+
+/**
+ * An export call with its arguments converted to the export's signature
+ */
+struct ExportCall {
+    WasmEdge_String name{};               // Non-owning view of the export name
+    std::vector<WasmEdge_Value> params;
+    std::vector<WasmEdge_Value> returns;  // Sized to the export's result count
+};
+
+/**
+ * Resolve an exported function of the instantiated module and convert the
+ * textual arguments to its parameter types
+ *
+ * @param vmCtx      VM holding the instantiated module
+ * @param exportName Export name (must outlive the call)
+ * @param args       Arguments as text
+ * @param call       Receives the prepared call
+ * @param error      Receives a message when preparation fails
+ * @return true on success, false if the export is missing or the arguments do not fit
+ */
+bool prepareExportCall(WasmEdge_VMContext* vmCtx, const std::string& exportName,
+                       const std::vector<std::string>& args, ExportCall& call,
+                       std::string& error) {
+    call.name = WasmEdge_StringWrap(exportName.data(), static_cast<uint32_t>(exportName.size()));
+    const WasmEdge_FunctionTypeContext* funcType = WasmEdge_VMGetFunctionType(vmCtx, call.name);
+    if (!funcType) {
+        error = "Module does not export a function named '" + exportName + "'.";
+        return false;
+    }
+
+    std::vector<WasmEdge_ValType> paramTypes(WasmEdge_FunctionTypeGetParametersLength(funcType));
+    WasmEdge_FunctionTypeGetParameters(funcType, paramTypes.data(),
+                                       static_cast<uint32_t>(paramTypes.size()));
+    if (args.size() != paramTypes.size()) {
+        error = "Export '" + exportName + "' expects " + std::to_string(paramTypes.size())
+                + " argument(s), got " + std::to_string(args.size()) + ".";
+        return false;
+    }
+
+    call.params.resize(paramTypes.size());
+    for (size_t i = 0; i < call.params.size(); i++) {
+        if (!parseWasmValue(args[i], paramTypes[i], call.params[i])) {
+            error = "Argument " + std::to_string(i + 1) + " ('" + args[i]
+                    + "') does not match the parameter type of '" + exportName + "'.";
+            return false;
+        }
+    }
+    call.returns.resize(WasmEdge_FunctionTypeGetReturnsLength(funcType));
+    return true;
+}
+
+constexpr size_t RUN_INSTANCE_CALLS = 10000;  // Calls per thread per scaling step without --repeat
+constexpr double RUN_KNEE_GAIN = 0.25;        // Least share of the ideal speedup that still scales
+
+/**
+ * Log-linear latency histogram: 16 sub-buckets per power of two, so a
+ * percentile is reported within 1/16 of the true sample. Recording is one
+ * increment; histograms of different threads merge by addition.
+ */
+class LatencyHistogram {
+public:
+    /**
+     * Add one sample
+     *
+     * @param ns Latency in nanoseconds
+     */
+    void record(uint64_t ns) {
+        counts_[bucketOf(ns)]++;
+        count_++;
+        sum_ += ns;
+        min_ = std::min(min_, ns);
+        max_ = std::max(max_, ns);
+    }
+
+    /**
+     * Add the samples of another histogram
+     *
+     * @param other Histogram to merge
+     */
+    void merge(const LatencyHistogram& other) {
+        for (size_t i = 0; i < BUCKET_COUNT; i++) {
+            counts_[i] += other.counts_[i];
+        }
+        count_ += other.count_;
+        sum_ += other.sum_;
+        min_ = std::min(min_, other.min_);
+        max_ = std::max(max_, other.max_);
+    }
+
+    uint64_t count() const { return count_; }
+    uint64_t min() const { return count_ > 0 ? min_ : 0; }
+    uint64_t max() const { return max_; }
+    double mean() const {
+        return count_ > 0 ? static_cast<double>(sum_) / static_cast<double>(count_) : 0.0;
+    }
+
+    /**
+     * Nearest-rank percentile (upper bound of the bucket holding the rank)
+     *
+     * @param percentile Percentile in (0, 100]
+     * @return Latency in nanoseconds (0 without samples)
+     */
+    uint64_t percentile(double percentile) const {
+        uint64_t rank = std::max<uint64_t>(
+            1, static_cast<uint64_t>(std::ceil(percentile / 100.0 * static_cast<double>(count_))));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKET_COUNT; i++) {
+            seen += counts_[i];
+            if (seen >= rank) {
+                return std::min(max_, upperBound(i));
+            }
+        }
+        return max_;
+    }
+
+private:
+    static constexpr unsigned SUB_BITS = 4;
+    static constexpr uint64_t SUB_COUNT = uint64_t{1} << SUB_BITS;
+    static constexpr size_t BUCKET_COUNT = (64 - SUB_BITS + 1) << SUB_BITS;
+
+    static size_t bucketOf(uint64_t ns) {
+        if (ns < SUB_COUNT) {
+            return static_cast<size_t>(ns);
+        }
+        unsigned shift = 0;
+        while ((ns >> shift) >= 2 * SUB_COUNT) {
+            shift++;
+        }
+        return ((shift + 1) << SUB_BITS) + static_cast<size_t>((ns >> shift) - SUB_COUNT);
+    }
+
+    static uint64_t upperBound(size_t bucket) {
+        if (bucket < SUB_COUNT) {
+            return bucket;
+        }
+        unsigned shift = static_cast<unsigned>(bucket >> SUB_BITS) - 1;
+        uint64_t lower = (SUB_COUNT + (bucket & (SUB_COUNT - 1))) << shift;
+        return lower + ((uint64_t{1} << shift) - 1);
+    }
+
+    std::array<uint64_t, BUCKET_COUNT> counts_{};
+    uint64_t count_ = 0;
+    uint64_t sum_ = 0;
+    uint64_t min_ = UINT64_MAX;
+    uint64_t max_ = 0;
+};
+
+/**
+ * Print the call-latency report of merged histograms
+ *
+ * @param histogram Samples of all threads
+ * @param totalNs   Wall time of the timed calls in nanoseconds
+ */
+void printHistogramReport(const LatencyHistogram& histogram, uint64_t totalNs) {
+    double callsPerSec = totalNs > 0
+        ? static_cast<double>(histogram.count()) * 1e9 / static_cast<double>(totalNs) : 0.0;
+    std::cout << "Calls  : " << histogram.count() << "\n"
+              << "Warmup : " << g_warmup << " per instance\n"
+              << "Rate   : " << static_cast<uint64_t>(callsPerSec) << " calls/s\n"
+              << "Mean   : " << static_cast<uint64_t>(histogram.mean()) << " ns\n"
+              << "Min    : " << histogram.min() << " ns\n"
+              << "p50    : " << histogram.percentile(50.0) << " ns\n"
+              << "p99    : " << histogram.percentile(99.0) << " ns\n"
+              << "p999   : " << histogram.percentile(99.9) << " ns\n"
+              << "Max    : " << histogram.max() << " ns\n";
+}
+
+/**
+ * Multi-instance throughput harness (run --instances K --threads T).
+ *
+ * The module is parsed once (or its AOT artifact found once) and K
+ * independent instances are created from that, each in its own VM with its
+ * own WASI environment and --link libraries. Calls are then driven from 1,
+ * 2, 4, ... up to T threads: thread t owns instances t, t+n, t+2n, ... so
+ * no VM is shared between threads, and every thread makes the same number
+ * of calls round-robin over its instances. Each thread records into its own
+ * histogram; the histograms of a step are merged afterwards. The report
+ * gives calls/s, speedup and efficiency per step, the thread count where
+ * scaling flattens, and the merged latencies of the largest step.
+ *
+ * @param session    Session of the run (supplies the parser, collects phases)
+ * @param filename   Path to the .wasm file
+ * @param exportName Exported function to call
+ * @param args       Call arguments (one per parameter)
+ * @return Exit code (EXIT_OK, EXIT_CLI_ERROR or EXIT_RUNTIME_ERROR)
+ */
+int runInstances(Session& session, const std::string& filename, const std::string& exportName,
+                 const std::vector<std::string>& args) {
+    using Clock = std::chrono::steady_clock;
+    std::vector<PhaseSample>& phases = session.phases();
+    size_t instanceCount = g_instances;
+    size_t maxThreads = g_runThreads > 0
+        ? g_runThreads
+        : std::min<size_t>(instanceCount, std::max(1u, std::thread::hardware_concurrency()));
+
+    // Step 1: Parse once (or find the AOT artifact) for every instance
+    PreparedModule prepared;
+    ModuleResult failure;
+    if (!prepareModule(session, "RUN", filename, prepared, failure)) {
+        printResult(failure);
+        return failure.exitCode;
+    }
+
+    // Step 2: Instantiate K independent instances
+    struct Instance {
+        Session session;  // Own link set: library state is per instance too
+        VMPool::Lease vm;
+        WasmEdge_StatisticsContext* stats = nullptr;
+        std::vector<WasmEdge_Value> returns;
+    };
+    std::vector<Instance> instances(instanceCount);
+    printVerbose("Instantiating ", instanceCount, " instance(s)...");
+    int64_t rssBefore = peakRssKb();
+    Clock::time_point setupStart = Clock::now();
+    for (Instance& instance : instances) {
+        instance.vm = instance.session.acquireVM();
+        if (!instance.vm) {
+            printContextError("RUN", filename, "VM context");
+            return EXIT_RUNTIME_ERROR;
+        }
+        instance.stats = WasmEdge_VMGetStatisticsContext(instance.vm.get());
+        applyCostTable(instance.vm.get());
+        armGasLimit(instance.stats);
+        ModuleResult record = loadAndInstantiate(instance.session, instance.vm.get(), "RUN",
+                                                 filename, &prepared);
+        const std::vector<PhaseSample>& instancePhases = instance.session.phases();
+        phases.insert(phases.end(), instancePhases.begin(), instancePhases.end());
+        if (record.exitCode != EXIT_OK) {
+            printResult(record);
+            return record.exitCode;
+        }
+    }
+    uint64_t setupNs = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - setupStart).count());
+    int64_t rssGrowth = std::max<int64_t>(peakRssKb() - rssBefore, 0);
+    prepared.ast.reset();  // Every VM holds its own copy
+
+    // Step 3: Resolve the export once; each instance gets its own return slots
+    ExportCall call;
+    std::string callError;
+    if (!prepareExportCall(instances[0].vm.get(), exportName, args, call, callError)) {
+        printCliError(callError);
+        return EXIT_CLI_ERROR;
+    }
+    auto callOnce = [&call](Instance& instance) {
+        armGasLimit(instance.stats);
+        return WasmEdge_VMExecute(instance.vm.get(), call.name, call.params.data(),
+                                  static_cast<uint32_t>(call.params.size()),
+                                  instance.returns.data(),
+                                  static_cast<uint32_t>(instance.returns.size()));
+    };
+    WasmEdge_Result result = WasmEdge_Result_Success;
+    for (Instance& instance : instances) {
+        instance.returns = call.returns;
+        for (size_t i = 0; i < g_warmup && WasmEdge_ResultOK(result); i++) {
+            result = callOnce(instance);
+        }
+    }
+
+    // Step 4: Scaling sweep over 1, 2, 4, ... maxThreads threads
+    printVerbose("Executing '", exportName, "'...");
+    PhaseTimer executeTimer(phases, "execute");
+    struct ScalingStep {
+        size_t threads = 0;
+        uint64_t wallNs = 0;
+        LatencyHistogram histogram;
+    };
+    std::vector<ScalingStep> steps;
+    for (size_t threads = 1; threads < maxThreads; threads *= 2) {
+        steps.push_back(ScalingStep{threads, 0, {}});
+    }
+    steps.push_back(ScalingStep{maxThreads, 0, {}});
+    size_t callsPerThread = g_repeat > 0 ? g_repeat : RUN_INSTANCE_CALLS;
+    ExecutionStats before;
+    ExecutionStats after;
+
+    for (ScalingStep& step : steps) {
+        if (!WasmEdge_ResultOK(result)) {
+            break;
+        }
+        bool last = &step == &steps.back();
+        for (const Instance& instance : instances) {
+            ExecutionStats counters = readStatistics(instance.stats);
+            before.instructions += last ? counters.instructions : 0;
+            before.cost += last ? counters.cost : 0;
+        }
+
+        std::vector<LatencyHistogram> histograms(step.threads);
+        std::vector<WasmEdge_Result> results(step.threads, WasmEdge_Result_Success);
+        std::atomic<size_t> ready{0};
+        std::atomic<bool> go{false};
+        std::atomic<bool> stop{false};
+        std::vector<std::thread> workers;
+        workers.reserve(step.threads);
+        for (size_t t = 0; t < step.threads; t++) {
+            workers.emplace_back([&, t, threads = step.threads] {
+                size_t owned = (instanceCount - t + threads - 1) / threads;
+                ready.fetch_add(1);
+                while (!go.load(std::memory_order_acquire)) {
+                    std::this_thread::yield();
+                }
+                for (size_t i = 0; i < callsPerThread && !stop.load(std::memory_order_relaxed);
+                     i++) {
+                    Instance& instance = instances[t + (i % owned) * threads];
+                    Clock::time_point callStart = Clock::now();
+                    WasmEdge_Result callResult = callOnce(instance);
+                    Clock::time_point callEnd = Clock::now();
+                    if (!WasmEdge_ResultOK(callResult)) {
+                        results[t] = callResult;
+                        stop.store(true, std::memory_order_relaxed);
+                        break;
+                    }
+                    histograms[t].record(static_cast<uint64_t>(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(callEnd - callStart)
+                            .count()));
+                }
+            });
+        }
+        while (ready.load() < step.threads) {
+            std::this_thread::yield();
+        }
+        Clock::time_point stepStart = Clock::now();
+        go.store(true, std::memory_order_release);
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+        step.wallNs = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - stepStart).count());
+        for (size_t t = 0; t < step.threads; t++) {
+            step.histogram.merge(histograms[t]);
+            if (!WasmEdge_ResultOK(results[t]) && WasmEdge_ResultOK(result)) {
+                result = results[t];
+            }
+        }
+        for (const Instance& instance : instances) {
+            ExecutionStats counters = readStatistics(instance.stats);
+            after.instructions += last ? counters.instructions : 0;
+            after.cost += last ? counters.cost : 0;
+        }
+    }
+    executeTimer.stop();
+
+    if (!WasmEdge_ResultOK(result)) {
+        printWasmEdgeError("RUN", filename, "FAILED (Execution Error)", result);
+        return EXIT_RUNTIME_ERROR;
+    }
 
     // Success
-    printVerbose("Instantiation completed successfully.");
-    printSuccess("INSTANTIATE", filename, "READY");
+    printVerbose("Execution completed successfully.");
+    uint32_t exitStatus = 0;
+    for (const Instance& instance : instances) {
+        exitStatus = exitStatus != 0 ? exitStatus : wasiExitCode(instance.session.wasi());
+    }
+    printSuccess("RUN", filename, "SUCCESS");
+    std::cout << "Export : " << exportName << "\n";
+    for (const WasmEdge_Value& value : instances[0].returns) {
+        std::cout << "Result : " << formatWasmValue(value) << "\n";
+    }
+    if (g_wasi) {
+        std::cout << "Exit   : " << exitStatus << "\n";
+    }
+    std::cout << "Setup  : " << instanceCount << " instance(s) from one "
+              << (prepared.artifact.empty() ? "parse" : "AOT artifact") << " in "
+              << setupNs / 1000000 << "." << (setupNs / 100000) % 10 << " ms\n"
+              << "Memory : +" << rssGrowth << " KiB peak RSS ("
+              << rssGrowth / static_cast<int64_t>(instanceCount) << " KiB per instance)\n";
+
+    auto rateOf = [](const ScalingStep& step) {
+        return step.wallNs > 0
+            ? static_cast<double>(step.histogram.count()) * 1e9 / static_cast<double>(step.wallNs)
+            : 0.0;
+    };
+    double baseRate = rateOf(steps.front());
+    const ScalingStep* knee = nullptr;
+    for (size_t i = 0; i < steps.size(); i++) {
+        double rate = rateOf(steps[i]);
+        double speedup = baseRate > 0 ? rate / baseRate : 0.0;
+        uint64_t hundredths = static_cast<uint64_t>(speedup * 100.0 + 0.5);
+        double threads = static_cast<double>(steps[i].threads);
+        std::cout << "Scale  : " << steps[i].threads << " thread(s), "
+                  << static_cast<uint64_t>(rate) << " calls/s, "
+                  << hundredths / 100 << "." << (hundredths % 100) / 10 << hundredths % 10 << "x, "
+                  << static_cast<uint64_t>(speedup * 100.0 / threads + 0.5)
+                  << "% efficient, p99 " << steps[i].histogram.percentile(99.0) << " ns\n";
+        // Flattened: this step's extra threads bought under RUN_KNEE_GAIN of their ideal gain
+        if (i > 0 && !knee) {
+            double previous = rateOf(steps[i - 1]);
+            double ideal = threads / static_cast<double>(steps[i - 1].threads);
+            if (previous > 0 && (rate / previous - 1.0) < RUN_KNEE_GAIN * (ideal - 1.0)) {
+                knee = &steps[i - 1];
+            }
+        }
+    }
+    if (steps.size() > 1) {
+        if (knee) {
+            std::cout << "Knee   : " << knee->threads << " thread(s) (more threads add under "
+                      << static_cast<int>(RUN_KNEE_GAIN * 100) << "% of the ideal gain)\n";
+        } else {
+            std::cout << "Knee   : not reached up to " << maxThreads << " thread(s)\n";
+        }
+    }
+    const ScalingStep& widest = steps.back();
+    if (statisticsEnabled()) {
+        printStatisticsReport(static_cast<size_t>(widest.histogram.count()),
+                              ExecutionStats{after.instructions - before.instructions,
+                                             after.cost - before.cost},
+                              widest.wallNs, nullptr);
+    }
+    printHistogramReport(widest.histogram, widest.wallNs);
+    return exitStatus == 0 ? EXIT_OK : EXIT_RUNTIME_ERROR;
+    // RAII: every instance's VM deleted with its lease
+}
+
+/**
+ * Run sub-command implementation using WasmEdge C API
+ * 
+ * Pipeline: VM Create -> Load -> Validate -> Instantiate -> Execute
+ * Arguments are converted to WasmEdge_Value once and the param/return
+ * arrays are reused for every call. With --repeat N the export is called
+ * --warmup M times untimed, then N times timed individually with a
+ * monotonic clock, and latency percentiles are reported. With statistics
+ * enabled, instruction counts, instruction rate and cost of the measured
+ * calls are reported; --gas-limit stops any call whose cost exceeds it.
+ * With --instances the call goes to the multi-instance throughput harness.
+ * With --sample-profile an instrumented copy of the module runs, and a
+ * sampler thread records the running guest function during the measured
+ * calls.
+ * 
+ * @param filename   Path to the .wasm file
+ * @param exportName Exported function to call
+ * @param args       Call arguments (one per parameter)
+ * @return Exit code (EXIT_OK, EXIT_CLI_ERROR or EXIT_RUNTIME_ERROR)
+ */
+int cmdRun(const std::string& filename, const std::string& exportName,
+           const std::vector<std::string>& args) {
+    if (!validateFile(filename)) {
+        return EXIT_CLI_ERROR;
+    }
+    printVerbose("File validation passed.");
+    printVerbose("WasmEdge version: ", WasmEdge_VersionGet());
+    printVerbose("Processing file: ", filename);
+
+    // Phase samples are printed after teardown, once vmCtx is gone
+    Session session;
+    std::vector<PhaseSample>& phases = session.phases();
+    struct ProfileAtExit {
+        std::string_view filename;
+        std::vector<PhaseSample>& phases;
+        ~ProfileAtExit() {
+            if (g_profile) printProfile("RUN", filename, phases);
+        }
+    } profileAtExit{filename, phases};
+    TeardownTimer teardown(phases);
+
+    // Step 1: Read a stream input, scan the binary, then create the VM context (RAII managed)
+    std::optional<InlineModuleScope> streamed;
+    if (isStreamInput(filename)) {
+        std::string_view error;
+        std::optional<std::string_view> bytes = readStreamInput(session, filename, error);
+        if (!bytes) {
+            printResult(makeInputError("RUN", filename, error));
+            return EXIT_CLI_ERROR;
+        }
+        streamed.emplace(session, *bytes);
+    }
+    MappedModule module;
+    ModuleResult rejection;
+    if (!scanModuleInput(session, "RUN", filename, module, rejection)) {
+        printResult(rejection);
+        return rejection.exitCode;
+    }
+
+    // --sample-profile: run an instrumented copy of the module instead
+    SamplingModule sampling;
+    std::optional<InlineModuleScope> instrumented;
+    if (!g_sampleProfile.empty()) {
+        std::string_view error = prepareSampling(session, filename, module, sampling);
+        if (!error.empty()) {
+            ModuleResult failure = makeInputError("RUN", filename, error);
+            failure.phase = "instrument";
+            printResult(failure);
+            return failure.exitCode;
+        }
+        streamed.reset();  // Stream bytes stay in the session arena
+        instrumented.emplace(session, std::string_view(sampling.bytes));
+    }
+    InlineModuleScope shared(session, module);
+    if (g_instances > 0) {
+        return runInstances(session, filename, exportName, args);
+    }
+    VMPool::Lease vmCtx = session.acquireVM();
+    TeardownStart teardownStart(teardown);
+    if (!vmCtx) {
+        printContextError("RUN", filename, "VM context");
+        return EXIT_RUNTIME_ERROR;
+    }
+
+    // --sample-profile: the instrumented module imports the sampler's hook
+    std::optional<SampleHook> sampleHook;
+    if (!g_sampleProfile.empty()) {
+        sampleHook.emplace();
+        if (!sampleHook->create()) {
+            printContextError("RUN", filename, "sample hook module");
+            return EXIT_RUNTIME_ERROR;
+        }
+        WasmEdge_Result registered =
+            WasmEdge_VMRegisterModuleFromImport(vmCtx.get(), sampleHook->module());
+        if (!WasmEdge_ResultOK(registered)) {
+            printWasmEdgeError("RUN", filename, "FAILED (Instantiation Error)", registered);
+            return EXIT_RUNTIME_ERROR;
+        }
+    }
+
+    // Steps 2-4: Load -> Validate -> Instantiate (start function costed and limited too)
+    WasmEdge_StatisticsContext* stats = WasmEdge_VMGetStatisticsContext(vmCtx.get());
+    applyCostTable(vmCtx.get());
+    armGasLimit(stats);
+    ModuleResult record = loadAndInstantiate(session, vmCtx.get(), "RUN", filename);
+    if (record.exitCode != EXIT_OK) {
+        printResult(record);
+        return record.exitCode;
+    }
+
+    // Step 5: Resolve the export and convert arguments once
+    ExportCall call;
+    std::string callError;
+    if (!prepareExportCall(vmCtx.get(), exportName, args, call, callError)) {
+        printCliError(callError);
+        return EXIT_CLI_ERROR;
+    }
+    std::vector<WasmEdge_Value>& params = call.params;
+    std::vector<WasmEdge_Value>& returns = call.returns;
+    WasmEdge_String funcName = call.name;
+    std::optional<GuestSampler> sampler;
+    if (sampleHook) {
+        sampler.emplace(sampleHook->current(), sampling.names.size());
+    }
+
+    auto callOnce = [&]() {
+        armGasLimit(stats);
+        return WasmEdge_VMExecute(vmCtx.get(), funcName,
+                                  params.data(), static_cast<uint32_t>(params.size()),
+                                  returns.data(), static_cast<uint32_t>(returns.size()));
+    };
+
+    // Step 6: Warm up, then execute (timed when benchmarking)
+    printVerbose("Executing '", exportName, "'...");
+    WasmEdge_Result result = WasmEdge_Result_Success;
+    for (size_t i = 0; i < g_warmup && WasmEdge_ResultOK(result); i++) {
+        result = callOnce();
+    }
+    PhaseTimer executeTimer(phases, "execute");  // Measured calls only, not warm-up
+
+    std::vector<uint64_t> samples;
+    uint64_t totalNs = 0;
+    ExecutionStats before = readStatistics(stats);  // Measured calls only, not warm-up
+    if (sampler) sampler->start();
+    if (WasmEdge_ResultOK(result) && g_repeat > 0) {
+        samples.reserve(g_repeat);
+        using Clock = std::chrono::steady_clock;
+        Clock::time_point loopStart = Clock::now();
+        for (size_t i = 0; i < g_repeat && WasmEdge_ResultOK(result); i++) {
+            Clock::time_point callStart = Clock::now();
+            result = callOnce();
+            Clock::time_point callEnd = Clock::now();
+            samples.push_back(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(callEnd - callStart).count()));
+        }
+        totalNs = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - loopStart).count());
+    } else if (WasmEdge_ResultOK(result)) {
+        auto callStart = std::chrono::steady_clock::now();
+        result = callOnce();
+        totalNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - callStart).count());
+    }
+    if (sampler) sampler->stop();
+    executeTimer.stop();
+    ExecutionStats after = readStatistics(stats);
+
+    // Folded stacks are written for failed calls too (where did it trap or run out of gas?)
+    if (sampler && !writeFoldedStacks(sampling, exportName, sampler->counts(), g_sampleProfile)) {
+        printCliError("Cannot write sample profile: " + g_sampleProfile);
+        return EXIT_CLI_ERROR;
+    }
+
+    if (!WasmEdge_ResultOK(result)) {
+        printWasmEdgeError("RUN", filename, "FAILED (Execution Error)", result);
+        return EXIT_RUNTIME_ERROR;
+    }
+
+    // Success
+    printVerbose("Execution completed successfully.");
+    uint32_t exitStatus = wasiExitCode(session.wasi());
+    printSuccess("RUN", filename, "SUCCESS");
+    std::cout << "Export : " << exportName << "\n";
+    for (const WasmEdge_Value& value : returns) {
+        std::cout << "Result : " << formatWasmValue(value) << "\n";
+    }
+    if (g_wasi) {
+        std::cout << "Exit   : " << exitStatus << "\n";
+    }
+    if (statisticsEnabled()) {
+        printStatisticsReport(samples.empty() ? 1 : samples.size(),
+                              ExecutionStats{after.instructions - before.instructions,
+                                             after.cost - before.cost},
+                              totalNs, stats);
+    }
+    if (!samples.empty()) {
+        printLatencyReport(samples, totalNs);
+    }
+    if (sampler) {
+        printSampleReport(sampling, sampler->counts());
+    }
+    return exitStatus == 0 ? EXIT_OK : EXIT_RUNTIME_ERROR;
+    // RAII: vmCtx automatically cleaned up
+}
+
+// ============================================================================
+// Generate Sub-command - Synthetic module corpus for scaling tests
+// ============================================================================
+
+/**
+ * Deliberately invalid variants the generator can emit
+ */
+enum class InvalidKind {
+    None,          // Valid module
+    Magic,         // Wrong magic number (parse error)
+    Truncated,     // Last byte missing (parse error)
+    SectionOrder,  // Export section after the code section (parse error)
+    TypeMismatch,  // Last function returns i64 instead of i32 (validation error)
+    BadLocal,      // Last function reads a local that does not exist (validation error)
+};
+
+/**
+ * Shape of a generated module (generate sub-command options)
+ */
+struct GeneratorSpec {
+    size_t functions = 16;      // Defined functions (--functions)
+    size_t bodyOps = 64;        // Add operations per body (--body-ops)
+    size_t locals = 0;          // i32 locals per function (--locals)
+    size_t dataSegments = 0;    // Active data segments (--data-segments)
+    uint64_t dataSize = 1024;   // Bytes per data segment (--data-size)
+    size_t imports = 0;         // Imported functions (--imports)
+    size_t exports = 1;         // Exported functions, from the first (--exports)
+    InvalidKind invalid = InvalidKind::None;  // --invalid
+};
+GeneratorSpec g_generator;
+
+/**
+ * Parse an --invalid variant name
+ *
+ * @param text Variant name
+ * @param kind Receives the variant
+ * @return false if the name is unknown
+ */
+bool parseInvalidKind(std::string_view text, InvalidKind& kind) {
+    static constexpr std::pair<std::string_view, InvalidKind> KINDS[] = {
+        {"magic", InvalidKind::Magic},
+        {"truncated", InvalidKind::Truncated},
+        {"section-order", InvalidKind::SectionOrder},
+        {"type-mismatch", InvalidKind::TypeMismatch},
+        {"bad-local", InvalidKind::BadLocal},
+    };
+    for (const auto& [name, value] : KINDS) {
+        if (text == name) {
+            kind = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Append raw bytes (string literals would stop at the first 0x00)
+ *
+ * @param out   Output bytes
+ * @param bytes Bytes to append
+ */
+void appendBytes(std::string& out, std::initializer_list<uint8_t> bytes) {
+    for (uint8_t byte : bytes) {
+        out.push_back(static_cast<char>(byte));
+    }
+}
+
+/**
+ * Encoded length of an unsigned LEB128 value
+ *
+ * @param value Value
+ * @return Byte count
+ */
+uint64_t varU32Length(uint64_t value) {
+    uint64_t length = 1;
+    while (value >>= 7) length++;
+    return length;
+}
+
+/**
+ * Build one function body of a generated module
+ *
+ * @param spec  Module shape
+ * @param last  Whether this is the last function (carries the invalid construct)
+ * @return Body bytes, without the size prefix
+ */
+std::string generateBody(const GeneratorSpec& spec, bool last) {
+    std::string body;
+    if (spec.locals > 0) {
+        appendBytes(body, {0x01});            // One local group...
+        appendVarU32(body, spec.locals);
+        appendBytes(body, {0x7F});            // ...of i32
+    } else {
+        appendBytes(body, {0x00});
+    }
+    appendBytes(body, {0x41, 0x00});          // i32.const 0
+    for (size_t op = 0; op < spec.bodyOps; op++) {
+        if (spec.locals > 0) {
+            appendBytes(body, {0x20});        // local.get op % locals
+            appendVarU32(body, op % spec.locals);
+        } else {
+            appendBytes(body, {0x41, 0x01});  // i32.const 1
+        }
+        appendBytes(body, {0x6A});            // i32.add
+    }
+    if (last && spec.invalid == InvalidKind::TypeMismatch) {
+        appendBytes(body, {0x1A, 0x42, 0x00});  // drop; i64.const 0 (result should be i32)
+    } else if (last && spec.invalid == InvalidKind::BadLocal) {
+        appendBytes(body, {0x20});            // local.get <one past the last local>
+        appendVarU32(body, spec.locals);
+        appendBytes(body, {0x6A});
+    }
+    appendBytes(body, {0x0B});                // end
+    return body;
+}
+
+/**
+ * Write a generated module. Sections are sized up front and written in
+ * order, with the code and data sections streamed from one body template
+ * and one fill chunk, so memory use stays flat up to multi-GB modules.
+ *
+ * @param out   Destination buffer
+ * @param spec  Module shape
+ * @param error Receives a message when the shape cannot be encoded
+ * @return Bytes written, or 0 on error
+ */
+uint64_t writeGeneratedModule(OutputBuffer& out, const GeneratorSpec& spec, std::string& error) {
+    uint64_t functionBase = spec.imports;
+    std::string head;
+    uint8_t magicA = spec.invalid == InvalidKind::Magic ? uint8_t{'w'} : uint8_t{'a'};
+    appendBytes(head, {0x00, magicA, 's', 'm', 0x01, 0x00, 0x00, 0x00});
+
+    // Type section: 0 = () -> i32 (defined functions), 1 = (i32) -> () (imports)
+    std::string types;
+    appendBytes(types, {0x02, 0x60, 0x00, 0x01, 0x7F, 0x60, 0x01, 0x7F, 0x00});
+    appendSectionHeader(head, 1, types.size());
+    head += types;
+
+    if (spec.imports > 0) {
+        std::string imports;
+        appendVarU32(imports, spec.imports);
+        for (size_t i = 0; i < spec.imports; i++) {
+            std::string name = "f" + std::to_string(i);
+            imports += "\x03" "env";
+            appendVarU32(imports, name.size());
+            imports += name;
+            appendBytes(imports, {0x00, 0x01});  // func, type 1
+        }
+        appendSectionHeader(head, 2, imports.size());
+        head += imports;
+    }
+
+    std::string functions;
+    appendVarU32(functions, spec.functions);
+    functions.append(spec.functions, '\x00');
+    appendSectionHeader(head, 3, functions.size());
+    head += functions;
+
+    uint64_t dataBytes = spec.dataSegments * spec.dataSize;
+    if (spec.dataSegments > 0) {
+        uint64_t pages = std::max<uint64_t>(1, (dataBytes + 65535) / 65536);
+        if (pages > 65536) {
+            error = "Data segments do not fit in a 4 GiB memory.";
+            return 0;
+        }
+        std::string memory;
+        appendBytes(memory, {0x01, 0x00});  // One memory, no maximum
+        appendVarU32(memory, pages);
+        appendSectionHeader(head, 5, memory.size());
+        head += memory;
+    }
+
+    std::string exports;
+    appendVarU32(exports, spec.exports);
+    for (size_t i = 0; i < spec.exports; i++) {
+        std::string name = "f" + std::to_string(i);
+        appendVarU32(exports, name.size());
+        exports += name;
+        appendBytes(exports, {0x00});  // func
+        appendVarU32(exports, functionBase + i);
+    }
+    std::string exportSection;
+    appendSectionHeader(exportSection, 7, exports.size());
+    exportSection += exports;
+    if (spec.invalid != InvalidKind::SectionOrder) {
+        head += exportSection;
+    }
+
+    // Code section: every body but the last shares one template
+    std::string body = generateBody(spec, false);
+    std::string lastBody = generateBody(spec, true);
+    std::string bodyPrefix;
+    appendVarU32(bodyPrefix, body.size());
+    std::string lastPrefix;
+    appendVarU32(lastPrefix, lastBody.size());
+    uint64_t codeSize = varU32Length(spec.functions)
+                      + (spec.functions - 1) * (bodyPrefix.size() + body.size())
+                      + lastPrefix.size() + lastBody.size();
+
+    // Data section: segment i is placed at offset i * dataSize
+    uint64_t dataSectionSize = 0;
+    if (spec.dataSegments > 0) {
+        dataSectionSize = varU32Length(spec.dataSegments);
+        for (size_t i = 0; i < spec.dataSegments; i++) {
+            std::string offset;
+            appendVarS32(offset, static_cast<int64_t>(static_cast<int32_t>(i * spec.dataSize)));
+            dataSectionSize += 3 + offset.size() + varU32Length(spec.dataSize) + spec.dataSize;
+        }
+    }
+    if (codeSize > UINT32_MAX || dataSectionSize > UINT32_MAX) {
+        error = "A section would exceed the 4 GiB section size limit.";
+        return 0;
+    }
+
+    uint64_t written = 0;
+    auto emit = [&](std::string_view bytes) {
+        out.append(bytes);
+        written += bytes.size();
+    };
+    emit(head);
+    std::string header;
+    appendSectionHeader(header, 10, codeSize);
+    appendVarU32(header, spec.functions);
+    emit(header);
+    std::string templ = bodyPrefix + body;
+    for (size_t i = 0; i + 1 < spec.functions; i++) {
+        emit(templ);
+    }
+    emit(lastPrefix);
+    emit(lastBody);
+    if (spec.invalid == InvalidKind::SectionOrder) {
+        emit(exportSection);
+    }
+
+    if (spec.dataSegments > 0) {
+        header.clear();
+        appendSectionHeader(header, 11, dataSectionSize);
+        appendVarU32(header, spec.dataSegments);
+        emit(header);
+        std::string fill(static_cast<size_t>(std::min<uint64_t>(spec.dataSize, 64 * 1024)), '\0');
+        for (size_t i = 0; i < fill.size(); i++) {
+            fill[i] = static_cast<char>('a' + i % 26);
+        }
+        for (size_t i = 0; i < spec.dataSegments; i++) {
+            std::string segment;
+            appendBytes(segment, {0x00, 0x41});  // Active, memory 0, i32.const offset
+            appendVarS32(segment, static_cast<int64_t>(static_cast<int32_t>(i * spec.dataSize)));
+            appendBytes(segment, {0x0B});
+            appendVarU32(segment, spec.dataSize);
+            emit(segment);
+            for (uint64_t left = spec.dataSize; left > 0;) {
+                size_t chunk = static_cast<size_t>(std::min<uint64_t>(left, fill.size()));
+                emit(std::string_view(fill.data(), chunk));
+                left -= chunk;
+            }
+        }
+    }
+    return written;
+}
+
+/**
+ * Generate sub-command implementation
+ *
+ * Writes one synthetic module shaped by the generator options, valid or in
+ * the --invalid variant, to a file or to stdout ('-', for piping into
+ * another wasm-mini command). The report goes to stdout, or to stderr when
+ * the module itself goes to stdout.
+ *
+ * @param output Output path or '-'
+ * @return Exit code (EXIT_OK, EXIT_CLI_ERROR)
+ */
+int cmdGenerate(const std::string& output) {
+    const GeneratorSpec& spec = g_generator;
+    if (spec.functions == 0 || spec.functions > UINT32_MAX) {
+        printCliError("Option '--functions' must be between 1 and 4294967295.");
+        return EXIT_CLI_ERROR;
+    }
+    if (spec.exports > spec.functions) {
+        printCliError("Option '--exports' cannot exceed '--functions'.");
+        return EXIT_CLI_ERROR;
+    }
+    bool toStdout = output == "-";
+    if (spec.invalid == InvalidKind::Truncated && toStdout) {
+        printCliError("The 'truncated' variant needs an output file.");
+        return EXIT_CLI_ERROR;
+    }
+
+    std::FILE* file = toStdout ? stdout : std::fopen(output.c_str(), "wb");
+    if (!file) {
+        printCliError("Cannot write output file: " + output);
+        return EXIT_CLI_ERROR;
+    }
+    printVerbose("Generating module: ", output);
+    auto start = std::chrono::steady_clock::now();
+    uint64_t size = 0;
+    std::string error;
+    {
+        OutputBuffer out(file, 4 << 20);
+        size = writeGeneratedModule(out, spec, error);
+    }
+    bool writeFailed = std::ferror(file) != 0;
+    if (!toStdout) {
+        writeFailed = std::fclose(file) != 0 || writeFailed;
+    }
+    if (size == 0 || writeFailed) {
+        printCliError(error.empty() ? "Cannot write output file: " + output : error);
+        if (!toStdout) std::remove(output.c_str());
+        return EXIT_CLI_ERROR;
+    }
+    if (spec.invalid == InvalidKind::Truncated) {
+        std::error_code ec;
+        fs::resize_file(output, --size, ec);
+    }
+    uint64_t wallNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+
+    std::ostream& report = toStdout ? std::cerr : std::cout;
+    report << "[GENERATE]\n"
+           << "File   : " << output << "\n"
+           << "Status : "
+           << (spec.invalid == InvalidKind::None ? "GENERATED" : "GENERATED (invalid)") << "\n"
+           << "Size   : " << size << " bytes\n"
+           << "Functions: " << spec.functions << " defined, " << spec.imports << " imported, "
+           << spec.exports << " exported\n"
+           << "Data   : " << spec.dataSegments << " segment(s), "
+           << spec.dataSegments * spec.dataSize << " bytes\n"
+           << "Time   : " << wallNs / 1000000 << " ms\n";
+    return EXIT_OK;
+}
+
+// ============================================================================
+// Serve Mode - Unix socket daemon answering requests with warm contexts
+// ============================================================================
+
+#if defined(__unix__) || defined(__APPLE__)
+
+volatile std::sig_atomic_t g_serveStop = 0;  // Set by SIGINT/SIGTERM in serve and watch mode
+
+extern "C" void onServeSignal(int) { g_serveStop = 1; }
+
+constexpr int SERVE_POLL_MS = 200;  // Accept/recv wake-up interval for noticing shutdown
+constexpr int SERVE_IDLE_MS = 5000;  // Idle connections are closed so they cannot hold a worker
+constexpr uint64_t SERVE_MAX_INLINE = uint64_t{256} << 20;  // bytes:N cap without --max-module-size
+
+/**
+ * Connections accepted by the listener, waiting for a free worker
+ */
+class ConnectionQueue {
+public:
+    void push(int fd) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            fds_.push_back(fd);
+        }
+        ready_.notify_one();
+    }
+
+    /**
+     * Wait for the next connection
+     *
+     * @param fd Receives the connection descriptor
+     * @return false once the queue is closed and drained
+     */
+    bool pop(int& fd) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        ready_.wait(lock, [this] { return closed_ || !fds_.empty(); });
+        if (fds_.empty()) {
+            return false;
+        }
+        fd = fds_.front();
+        fds_.erase(fds_.begin());
+        return true;
+    }
+
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        ready_.notify_all();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::vector<int> fds_;
+    bool closed_ = false;
+};
+
+/**
+ * Buffered reader over a client connection. Receives time out every
+ * SERVE_POLL_MS so idle connections notice a shutdown request, and a
+ * connection that sends nothing for SERVE_IDLE_MS is treated as closed.
+ */
+class ConnectionReader {
+public:
+    explicit ConnectionReader(int fd) : fd_(fd) {}
+
+    /**
+     * Read one request line (without the trailing newline)
+     *
+     * @param line Receives the line
+     * @return false on end of stream, error, shutdown, idle timeout, or an overlong line
+     */
+    bool readLine(std::string& line) {
+        size_t newline;
+        while ((newline = buffer_.find('\n', offset_)) == std::string::npos) {
+            if (buffer_.size() - offset_ > MAX_LINE || !fill()) {
+                return false;
+            }
+        }
+        line.assign(buffer_, offset_, newline - offset_);
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        offset_ = newline + 1;
+        return true;
+    }
+
+    /**
+     * Read exactly length payload bytes following a request line
+     *
+     * @param length Number of bytes
+     * @param out    Receives the bytes
+     * @return false if the stream ended or went idle first
+     */
+    bool readExact(size_t length, std::string& out) {
+        out.clear();
+        out.reserve(length);
+        while (out.size() < length) {
+            if (offset_ == buffer_.size() && !fill()) {
+                return false;
+            }
+            size_t take = std::min(length - out.size(), buffer_.size() - offset_);
+            out.append(buffer_, offset_, take);
+            offset_ += take;
+        }
+        return true;
+    }
+
+private:
+    static constexpr size_t MAX_LINE = 64 * 1024;
+    static constexpr size_t CHUNK = 64 * 1024;
+
+    bool fill() {
+        if (offset_ == buffer_.size()) {
+            buffer_.clear();
+            offset_ = 0;
+        }
+        size_t used = buffer_.size();
+        buffer_.resize(used + CHUNK);
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(SERVE_IDLE_MS);
+        while (true) {
+            ssize_t received = ::recv(fd_, buffer_.data() + used, CHUNK, 0);
+            if (received > 0) {
+                buffer_.resize(used + static_cast<size_t>(received));
+                return true;
+            }
+            if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+                && !g_serveStop && std::chrono::steady_clock::now() < deadline) {
+                continue;
+            }
+            buffer_.resize(used);
+            return false;
+        }
+    }
+
+    int fd_;
+    std::string buffer_;
+    size_t offset_ = 0;
+};
+
+/**
+ * Write a whole response to a client connection
+ *
+ * @param fd   Connection descriptor
+ * @param data Response bytes
+ * @return false if the client went away
+ */
+bool sendAll(int fd, std::string_view data) {
+    int flags = 0;
+#ifdef MSG_NOSIGNAL
+    flags |= MSG_NOSIGNAL;
+#endif
+    while (!data.empty()) {
+        ssize_t sent = ::send(fd, data.data(), data.size(), flags);
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent <= 0) {
+            return false;
+        }
+        data.remove_prefix(static_cast<size_t>(sent));
+    }
+    return true;
+}
+
+/**
+ * Split a request line into whitespace-separated fields
+ *
+ * @param line Request line
+ * @return Fields in order
+ */
+std::vector<std::string> splitFields(std::string_view line) {
+    std::vector<std::string> fields;
+    size_t pos = 0;
+    while (pos < line.size()) {
+        size_t start = line.find_first_not_of(" \t", pos);
+        if (start == std::string_view::npos) {
+            break;
+        }
+        size_t end = line.find_first_of(" \t", start);
+        if (end == std::string_view::npos) {
+            end = line.size();
+        }
+        fields.emplace_back(line.substr(start, end - start));
+        pos = end;
+    }
+    return fields;
+}
+
+/**
+ * Render a protocol-level error response
+ *
+ * @param message Error message
+ * @return JSON response line
+ */
+std::string serveError(std::string_view message) {
+    return "{\"type\":\"error\",\"error\":\"" + jsonEscape(message) + "\"}\n";
+}
+
+/**
+ * Answer a run request: instantiate the module in a pooled VM and call the
+ * export once
+ *
+ * @param session    Worker session (supplies inline bytes, collects phases)
+ * @param filename   Module path, or the inline module name
+ * @param exportName Exported function to call
+ * @param args       Call arguments as text
+ * @return JSON response line
+ */
+std::string serveRun(Session& session, const std::string& filename, const std::string& exportName,
+                     const std::vector<std::string>& args) {
+    auto start = std::chrono::steady_clock::now();
+    MappedModule module;
+    ModuleResult record;
+    if (!scanModuleInput(session, "RUN", filename, module, record)) {
+        record.phases = std::move(session.phases());
+        return renderRecordJson(record) + "\n";
+    }
+    InlineModuleScope shared(session, module);
+    VMPool::Lease vmCtx = session.acquireVM();
+
+    ExportCall call;
+    std::string callError;  // Backs record.detail until the record is rendered
+    WasmEdge_StatisticsContext* stats = nullptr;
+    ExecutionStats delta;
+    uint32_t exitStatus = 0;
+    if (!vmCtx) {
+        record = makeContextError("RUN", filename, "VM context");
+    } else {
+        stats = WasmEdge_VMGetStatisticsContext(vmCtx.get());
+        applyCostTable(vmCtx.get());
+        armGasLimit(stats);
+        record = loadAndInstantiate(session, vmCtx.get(), "RUN", filename);
+    }
+
+    if (record.exitCode == EXIT_OK) {
+        if (!prepareExportCall(vmCtx.get(), exportName, args, call, callError)) {
+            record = makeInputError("RUN", filename, callError);
+            record.phase = "execute";
+        } else {
+            WasmEdge_Result result;
+            ExecutionStats before = readStatistics(stats);
+            armGasLimit(stats);
+            {
+                PhaseTimer timer(session.phases(), "execute");
+                result = WasmEdge_VMExecute(vmCtx.get(), call.name, call.params.data(),
+                                            static_cast<uint32_t>(call.params.size()),
+                                            call.returns.data(),
+                                            static_cast<uint32_t>(call.returns.size()));
+            }
+            ExecutionStats after = readStatistics(stats);
+            delta = ExecutionStats{after.instructions - before.instructions,
+                                   after.cost - before.cost};
+            exitStatus = wasiExitCode(session.wasi());
+            record = WasmEdge_ResultOK(result)
+                ? makeSuccess("RUN", filename, "SUCCESS")
+                : makeWasmEdgeError("RUN", filename, "execute", "FAILED (Execution Error)", result);
+            record.phase = "execute";
+        }
+    }
+    {
+        PhaseTimer timer(session.phases(), "teardown");
+        vmCtx.reset();
+    }
+    record.wallNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+    record.phases = std::move(session.phases());
+
+    std::string json;
+    appendRecordJsonFields(json, record);
+    if (record.exitCode == EXIT_OK) {
+        json += ",\"results\":[";
+        for (size_t i = 0; i < call.returns.size(); i++) {
+            if (i > 0) json += ",";
+            json += "\"" + formatWasmValue(call.returns[i]) + "\"";
+        }
+        json += "]";
+        if (g_countInstructions) json += ",\"instructions\":" + std::to_string(delta.instructions);
+        if (g_measureCost) json += ",\"cost\":" + std::to_string(delta.cost);
+        if (g_wasi) json += ",\"wasi_exit_code\":" + std::to_string(exitStatus);
+    }
+    return json + "}\n";
+}
+
+/**
+ * Answer one request from a connection.
+ *
+ * Request line: `<command> <module> [<export> [args...]]`, where command is
+ * parse, validate, instantiate, check-all, compile, or run, and module is a path or
+ * `bytes:<N>` followed by exactly N raw module bytes after the newline.
+ * `ping` answers `{"type":"pong"}`.
+ *
+ * @param session Worker session
+ * @param reader  Connection reader (payload bytes are read from it)
+ * @param line    Request line
+ * @param keepOpen Cleared when the connection cannot continue
+ * @return JSON response line
+ */
+std::string serveRequest(Session& session, ConnectionReader& reader, const std::string& line,
+                         bool& keepOpen) {
+    std::vector<std::string> fields = splitFields(line);
+    if (fields.empty()) {
+        return serveError("Empty request.");
+    }
+    const std::string& command = fields[0];
+    if (command == "ping") {
+        return "{\"type\":\"pong\"}\n";
+    }
+
+    ModuleHandler handler = nullptr;
+    std::string_view commandLabel;
+    if (!resolveModuleCommand(command, handler, commandLabel) && command != "run") {
+        return serveError("Unknown command '" + command + "'.");
+    }
+    if (fields.size() < 2) {
+        return serveError("Missing module for '" + command + "'.");
+    }
+    if (command == "run" && fields.size() < 3) {
+        return serveError("Missing export name for 'run'.");
+    }
+
+    // Inline modules: read the payload before answering anything
+    std::string filename = fields[1];
+    std::string payload;
+    constexpr std::string_view BYTES_PREFIX = "bytes:";
+    bool inlineModule = filename.compare(0, BYTES_PREFIX.size(), BYTES_PREFIX) == 0;
+    if (inlineModule) {
+        size_t length = 0;
+        if (!parseCount(std::string_view(filename).substr(BYTES_PREFIX.size()), length)) {
+            keepOpen = false;  // The payload boundary is unknown; the stream cannot resync
+            return serveError("Invalid module length in '" + filename + "'.");
+        }
+        // Checked before readExact reserves the payload buffer
+        uint64_t limit = g_maxModuleSize > 0 ? std::min<uint64_t>(g_maxModuleSize, UINT32_MAX)
+                                             : SERVE_MAX_INLINE;
+        if (length > limit) {
+            keepOpen = false;  // Not reading the payload leaves the stream unsynchronized
+            return serveError(g_maxModuleSize > 0 ? "Inline module exceeds --max-module-size."
+                                                  : "Inline module exceeds 256 MiB.");
+        }
+        if (!reader.readExact(length, payload)) {
+            keepOpen = false;
+            return std::string();
+        }
+        filename = "<inline>";
+        session.setInlineModule(payload);
+    }
+
+    std::string response;
+    if (command == "run") {
+        std::vector<std::string> args(fields.begin() + 3, fields.end());
+        session.phases().clear();
+        response = serveRun(session, filename, fields[2], args);
+    } else {
+        ModuleResult record = processModule(session, handler, commandLabel, filename);
+        response = renderRecordJson(record) + "\n";
+    }
+    session.clearInlineModule();
+    return response;
+}
+
+/**
+ * Serve one client connection until it closes or goes idle
+ *
+ * @param session Worker session
+ * @param fd      Connection descriptor (closed on return)
+ */
+void serveConnection(Session& session, int fd) {
+    ConnectionReader reader(fd);
+    std::string line;
+    bool keepOpen = true;
+    while (keepOpen && !g_serveStop && reader.readLine(line)) {
+        std::string response = serveRequest(session, reader, line, keepOpen);
+        if (!response.empty() && !sendAll(fd, response)) {
+            break;
+        }
+    }
+    ::close(fd);
+}
+
+/**
+ * Serve sub-command: listen on a Unix domain socket and answer requests
+ * until SIGINT/SIGTERM.
+ *
+ * Each of the --jobs workers (one per hardware thread unless --jobs is
+ * given) owns a Session whose parser and validator are
+ * created before the socket starts listening, and the VM pool is filled
+ * with one VM per worker, so requests never pay for library or context
+ * initialization. A worker serves one connection at a
+ * time; requests on a connection are answered in order, one JSON line per
+ * request. A connection idle for SERVE_IDLE_MS is closed, so a quiet client
+ * gives its worker back to the accept queue.
+ *
+ * @param socketPath Socket path (a stale socket file is replaced)
+ * @return Exit code (EXIT_OK, or EXIT_CLI_ERROR if the socket cannot be bound)
+ */
+int cmdServe(const std::string& socketPath) {
+    sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        printCliError("Socket path is too long: " + socketPath);
+        return EXIT_CLI_ERROR;
+    }
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    // Replace a socket left behind by an earlier run, but never a regular file
+    struct stat info {};
+    if (::lstat(socketPath.c_str(), &info) == 0) {
+        if (!S_ISSOCK(info.st_mode)) {
+            printCliError("Refusing to replace non-socket file: " + socketPath);
+            return EXIT_CLI_ERROR;
+        }
+        ::unlink(socketPath.c_str());
+    }
+
+    int listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0
+        || ::fcntl(listenFd, F_SETFD, FD_CLOEXEC) != 0
+        || ::bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+        || ::listen(listenFd, SOMAXCONN) != 0) {
+        printCliError("Cannot listen on " + socketPath + ": " + std::strerror(errno));
+        if (listenFd >= 0) ::close(listenFd);
+        return EXIT_CLI_ERROR;
+    }
+
+    std::signal(SIGPIPE, SIG_IGN);
+    std::signal(SIGINT, onServeSignal);
+    std::signal(SIGTERM, onServeSignal);
+
+    // Prewarm one session and one pooled VM per worker before accepting connections.
+    // A connection holds its worker until it goes idle, so serve defaults to
+    // one worker per hardware thread rather than the batch default of one.
+    size_t workerCount = g_jobsSet ? resolveJobs(SIZE_MAX)
+                                   : std::max(1u, std::thread::hardware_concurrency());
+    VMPool vmPool(workerCount);
+    std::vector<Session> sessions(workerCount);
+    for (Session& session : sessions) {
+        session.parser();
+        session.validator();
+        session.setVMPool(&vmPool);
+        if (VMPtr vm = createVM()) {
+            vmPool.release(std::move(vm));
+        }
+        if (g_wasi) {
+            session.wasiModule();
+        }
+        WasmEdge_Result linkResult;
+        std::string_view failedLibrary;
+        session.linkModules(nullptr, linkResult, failedLibrary);
+        session.phases().clear();
+    }
+
+    ConnectionQueue queue;
+    std::vector<std::thread> workers;
+    workers.reserve(workerCount);
+    for (size_t i = 0; i < workerCount; i++) {
+        workers.emplace_back([&queue, &session = sessions[i]] {
+            int fd;
+            while (queue.pop(fd)) {
+                serveConnection(session, fd);
+            }
+        });
+    }
+
+    std::cout << "[SERVE]\n"
+              << "Socket : " << socketPath << "\n"
+              << "Workers: " << workerCount << "\n"
+              << "Status : LISTENING" << std::endl;
+
+    while (!g_serveStop) {
+        pollfd pending {listenFd, POLLIN, 0};
+        int ready = ::poll(&pending, 1, SERVE_POLL_MS);
+        if (ready <= 0) {
+            continue;  // Timeout or EINTR: re-check the stop flag
+        }
+        int clientFd = ::accept(listenFd, nullptr, nullptr);
+        if (clientFd < 0) {
+            continue;
+        }
+        ::fcntl(clientFd, F_SETFD, FD_CLOEXEC);
+        timeval timeout {0, SERVE_POLL_MS * 1000};
+        ::setsockopt(clientFd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        queue.push(clientFd);
+    }
+
+    // Stop accepting, let workers finish their current request, then clean up
+    ::close(listenFd);
+    queue.close();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    ::unlink(socketPath.c_str());
+    std::cout << "[SERVE]\n"
+              << "Socket : " << socketPath << "\n"
+              << "Status : STOPPED\n";
+    return EXIT_OK;
+}
+
+#else
+
+int cmdServe(const std::string&) {
+    printCliError("The 'serve' command requires Unix domain sockets.");
+    return EXIT_CLI_ERROR;
+}
+
+#endif
+
+// ============================================================================
+// Watch Mode - Re-run a command on modules whose content changed
+// ============================================================================
+
+#if defined(__unix__) || defined(__APPLE__)
+
+constexpr int WATCH_DEBOUNCE_MS = 50;  // Quiet time that ends a burst of file events
+constexpr int WATCH_POLL_MS = 500;     // Rescan interval where inotify is unavailable
+
+/**
+ * Last processed state of a watched module
+ */
+struct WatchEntry {
+    uint64_t digestHigh = 0;  // Content digest of the last processed bytes
+    uint64_t digestLow = 0;
+    int64_t mtime = 0;        // Modification time and size then (rescan pre-check)
+    uint64_t size = 0;
+};
+
+/**
+ * Watch mode state: one warm session for the whole run and the digest of
+ * every tracked module
+ */
+struct WatchState {
+    std::string_view command;
+    ModuleHandler handler = nullptr;
+    std::vector<std::string> args;              // Inputs as given (re-expanded on rescans)
+    std::vector<std::string> roots;             // Directory inputs, with a trailing '/'
+    std::vector<std::string> files;             // Plain file inputs
+    std::map<std::string, WatchEntry> modules;  // Tracked modules by path
+    VMPool vmPool{1};
+    Session session;
+};
+
+/**
+ * Print one watch-mode record (text, or one NDJSON line flushed at once)
+ *
+ * @param record Result record
+ */
+void emitWatchRecord(const ModuleResult& record) {
+    if (g_format == OutputFormat::Text) {
+        printResult(record);
+        std::cout.flush();
+        return;
+    }
+    std::cout << renderRecordJson(record) << std::endl;
+}
+
+/**
+ * Re-run the command on a module if its content changed since it was last
+ * processed. The digest is taken from the mapping the handler then uses,
+ * so an unchanged rewrite costs one read and one hash.
+ *
+ * @param state Watch state
+ * @param path  Module path
+ * @return true if a record was emitted
+ */
+bool watchRevalidate(WatchState& state, const std::string& path) {
+    MappedModule module;
+    if (!state.session.openModule(module, path)) {
+        if (state.modules.erase(path) > 0) {
+            printVerbose("No longer readable, dropped: ", path);
+            return false;
+        }
+        // Never seen: report it once (e.g. a missing file input)
+        emitWatchRecord(processModule(state.session, state.handler, state.command, path));
+        return true;
+    }
+    ContentHasher hasher;
+    hasher.update(module.data(), module.size());
+    uint64_t high = 0;
+    uint64_t low = 0;
+    hasher.digest(high, low);
+
+    auto [it, added] = state.modules.try_emplace(path);
+    WatchEntry& entry = it->second;
+    fileMtime(path, entry.mtime);
+    entry.size = module.size();
+    if (!added && entry.digestHigh == high && entry.digestLow == low) {
+        printVerbose("Unchanged: ", path);
+        return false;
+    }
+    entry.digestHigh = high;
+    entry.digestLow = low;
+
+    InlineModuleScope shared(state.session, module);
+    emitWatchRecord(processModule(state.session, state.handler, state.command, it->first));
+    return true;
+}
+
+/**
+ * Check whether a path lies below one of the directory inputs
+ *
+ * @param state Watch state
+ * @param path  File or directory path
+ * @return true if a directory input contains it
+ */
+bool underWatchRoot(const WatchState& state, const std::string& path) {
+    for (const std::string& root : state.roots) {
+        if (path.size() > root.size() && path.compare(0, root.size(), root) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Re-expand the inputs and revalidate every module whose modification time
+ * or size changed (all of them on the first pass)
+ *
+ * @param state Watch state
+ * @return Number of records emitted, or -1 if the inputs could not be expanded
+ */
+int watchRescan(WatchState& state) {
+    std::vector<std::string> inputs;
+    if (!collectInputs(state.args, inputs)) {
+        return -1;
+    }
+    int processed = 0;
+    for (const std::string& path : inputs) {
+        auto it = state.modules.find(path);
+        if (it != state.modules.end()) {
+            int64_t mtime = 0;
+            std::error_code ec;
+            uint64_t size = fs::file_size(path, ec);
+            if (!ec && fileMtime(path, mtime) && mtime == it->second.mtime
+                && size == it->second.size) {
+                continue;
+            }
+        }
+        processed += watchRevalidate(state, path) ? 1 : 0;
+    }
+
+    // Forget modules that disappeared since the last pass
+    std::sort(inputs.begin(), inputs.end());
+    for (auto it = state.modules.begin(); it != state.modules.end();) {
+        it = std::binary_search(inputs.begin(), inputs.end(), it->first) ? std::next(it)
+                                                                        : state.modules.erase(it);
+    }
+    return processed;
+}
+
+/**
+ * Report the end of a burst on stderr (text mode), keeping stdout for records
+ *
+ * @param state     Watch state
+ * @param processed Records emitted in the burst
+ * @param start     Start of processing (after the debounce)
+ */
+void reportWatchBurst(const WatchState& state, int processed,
+                      std::chrono::steady_clock::time_point start) {
+    if (g_format != OutputFormat::Text || processed == 0) {
+        return;
+    }
+    auto elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    std::cerr << "[WATCH] " << processed << " module(s) processed in " << elapsedUs / 1000 << "."
+              << (elapsedUs % 1000) / 100 << " ms, " << state.modules.size() << " watched\n";
+}
+
+#if defined(__linux__)
+
+/**
+ * Follow inotify events until SIGINT/SIGTERM.
+ * Directory inputs are watched recursively and file inputs through their
+ * parent directory, so modules replaced by rename (editors, build tools)
+ * are seen too. Events are coalesced until the tree has been quiet for
+ * WATCH_DEBOUNCE_MS; a queue overflow or a new sub-directory falls back to
+ * a rescan.
+ *
+ * @param state Watch state (after the initial pass)
+ * @return Exit code
+ */
+int watchLoop(WatchState& state) {
+    int fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) {
+        printCliError(std::string("Cannot start inotify: ") + std::strerror(errno));
+        return EXIT_CLI_ERROR;
+    }
+    constexpr uint32_t DIR_EVENTS =
+        IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE | IN_CREATE;
+
+    // Watch descriptor -> prefix joined with event names (matches collectInputs paths)
+    std::map<int, std::string> prefixes;
+    auto addWatch = [&](const std::string& dir, std::string prefix) {
+        int wd = ::inotify_add_watch(fd, dir.c_str(), DIR_EVENTS | IN_ONLYDIR);
+        if (wd >= 0) {
+            prefixes[wd] = std::move(prefix);
+        }
+    };
+    auto addTree = [&](const std::string& root) {
+        addWatch(root, (fs::path(root) / "").string());
+        std::error_code ec;
+        for (fs::recursive_directory_iterator it(root, ec), end; !ec && it != end;
+             it.increment(ec)) {
+            if (it->is_directory(ec)) {
+                addWatch(it->path().string(), (it->path() / "").string());
+            }
+        }
+    };
+    for (const std::string& root : state.roots) {
+        addTree(root);
+    }
+    for (const std::string& file : state.files) {
+        fs::path parent = fs::path(file).parent_path();
+        addWatch(parent.empty() ? "." : parent.string(),
+                 parent.empty() ? "" : (parent / "").string());
+    }
+
+    std::vector<std::string> pending;
+    bool rescan = false;
+    alignas(inotify_event) char buffer[16 * 1024];
+    while (!g_serveStop) {
+        bool idle = pending.empty() && !rescan;
+        pollfd events {fd, POLLIN, 0};
+        int ready = ::poll(&events, 1, idle ? SERVE_POLL_MS : WATCH_DEBOUNCE_MS);
+        if (ready > 0) {
+            ssize_t length;
+            while ((length = ::read(fd, buffer, sizeof(buffer))) > 0) {
+                for (char* cursor = buffer; cursor < buffer + length;) {
+                    const auto* event = reinterpret_cast<const inotify_event*>(cursor);
+                    cursor += sizeof(inotify_event) + event->len;
+                    if (event->mask & IN_Q_OVERFLOW) {
+                        rescan = true;
+                        continue;
+                    }
+                    auto prefix = prefixes.find(event->wd);
+                    if (prefix == prefixes.end() || event->len == 0) {
+                        continue;
+                    }
+                    std::string path = prefix->second + event->name;
+                    if (event->mask & IN_ISDIR) {
+                        if ((event->mask & (IN_CREATE | IN_MOVED_TO))
+                            && underWatchRoot(state, path)) {
+                            addTree(path);
+                            rescan = true;  // Modules may have landed before the watch existed
+                        }
+                        continue;
+                    }
+                    bool listed = std::find(state.files.begin(), state.files.end(), path)
+                               != state.files.end();
+                    bool tracked = state.modules.count(path) > 0 || listed
+                        || (hasWasmExtension(path) && underWatchRoot(state, path));
+                    if (!tracked || (event->mask & IN_CREATE)) {
+                        continue;  // Content of a new file arrives with IN_CLOSE_WRITE
+                    }
+                    if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                        state.modules.erase(path);
+                    } else if (std::find(pending.begin(), pending.end(), path) == pending.end()) {
+                        pending.push_back(std::move(path));
+                    }
+                }
+            }
+            continue;  // Keep coalescing until the tree is quiet
+        }
+        if (ready < 0 || idle) {
+            continue;  // EINTR or idle timeout: re-check the stop flag
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        int processed = 0;
+        if (rescan) {
+            processed = std::max(watchRescan(state), 0);
+        } else {
+            for (const std::string& path : pending) {
+                processed += watchRevalidate(state, path) ? 1 : 0;
+            }
+        }
+        pending.clear();
+        rescan = false;
+        reportWatchBurst(state, processed, start);
+    }
+    ::close(fd);
+    return EXIT_OK;
+}
+
+#else
+
+/**
+ * Rescan the inputs every WATCH_POLL_MS until SIGINT/SIGTERM, where
+ * inotify is unavailable. Modification time and size pre-filter the
+ * rescan, so only touched modules are read and hashed.
+ *
+ * @param state Watch state (after the initial pass)
+ * @return Exit code
+ */
+int watchLoop(WatchState& state) {
+    while (!g_serveStop) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(WATCH_POLL_MS));
+        auto start = std::chrono::steady_clock::now();
+        int processed = watchRescan(state);
+        if (processed < 0) {
+            return EXIT_CLI_ERROR;
+        }
+        reportWatchBurst(state, processed, start);
+    }
+    return EXIT_OK;
+}
+
+#endif
+
+/**
+ * Watch sub-command: run a command over the inputs once, then keep the
+ * session warm and re-run it on each module whose content changes, until
+ * SIGINT/SIGTERM
+ *
+ * @param command Command name (PARSE, VALIDATE, ...)
+ * @param handler Per-module handler
+ * @param args    Inputs: files, directories, @list files
+ * @return Exit code
+ */
+int cmdWatch(std::string_view command, ModuleHandler handler,
+             const std::vector<std::string>& args) {
+    WatchState state;
+    state.command = command;
+    state.handler = handler;
+    state.args = args;
+    state.session.setVMPool(&state.vmPool);
+    for (const std::string& arg : args) {
+        std::error_code ec;
+        if (arg[0] == '@') {
+            continue;  // List files are re-read on rescans only
+        }
+        if (fs::is_directory(arg, ec)) {
+            state.roots.push_back((fs::path(arg) / "").string());
+        } else {
+            state.files.push_back(arg);
+        }
+    }
+    std::signal(SIGINT, onServeSignal);
+    std::signal(SIGTERM, onServeSignal);
+
+    auto start = std::chrono::steady_clock::now();
+    int processed = watchRescan(state);
+    if (processed < 0) {
+        return EXIT_CLI_ERROR;
+    }
+    reportWatchBurst(state, processed, start);
+    if (g_format == OutputFormat::Text) {
+        std::cerr << "[WATCH] Waiting for changes (Ctrl-C to stop)\n";
+    }
+    return watchLoop(state);
+}
+
+#else
+
+int cmdWatch(std::string_view, ModuleHandler, const std::vector<std::string>&) {
+    printCliError("The 'watch' command requires a POSIX system.");
+    return EXIT_CLI_ERROR;
+}
+
+#endif
+
+// ============================================================================
+// Compare Sub-command - Regression gate over --profile and benchmark results
+// ============================================================================
+
+constexpr size_t COMPARE_RESAMPLES = 2000;      // Bootstrap resamples per row
+constexpr double COMPARE_CONFIDENCE = 0.95;     // Two-sided interval
+constexpr uint64_t COMPARE_SEED = 0x5EED5EED;   // Fixed, so a gate gives the same answer twice
+
+/**
+ * A parsed JSON value (the subset the compare inputs need: numbers are
+ * doubles, objects keep member order)
+ */
+struct JsonValue {
+    enum class Kind { Null, Bool, Number, String, Array, Object };
+    Kind kind = Kind::Null;
+    bool flag = false;
+    double number = 0.0;
+    std::string text;
+    std::vector<JsonValue> items;
+    std::vector<std::pair<std::string, JsonValue>> members;
+
+    /**
+     * Find an object member
+     *
+     * @param key Member name
+     * @return Member value, or nullptr if absent (or not an object)
+     */
+    const JsonValue* find(std::string_view key) const {
+        for (const auto& [name, value] : members) {
+            if (name == key) return &value;
+        }
+        return nullptr;
+    }
+    std::string_view textOf(std::string_view key) const {
+        const JsonValue* value = find(key);
+        return value && value->kind == Kind::String ? std::string_view(value->text)
+                                                    : std::string_view();
+    }
+    double numberOf(std::string_view key, double fallback) const {
+        const JsonValue* value = find(key);
+        return value && value->kind == Kind::Number ? value->number : fallback;
+    }
+};
+
+/**
+ * Recursive-descent JSON parser over one document or one NDJSON line
+ */
+class JsonParser {
+public:
+    explicit JsonParser(std::string_view text) : p_(text.data()), end_(text.data() + text.size()) {}
+
+    /**
+     * Parse one value
+     *
+     * @param out Receives the value
+     * @return false on malformed input
+     */
+    bool parse(JsonValue& out) { return value(out, 0); }
+
+    /** True when only whitespace remains */
+    bool atEnd() {
+        skipSpace();
+        return p_ == end_;
+    }
+
+private:
+    static constexpr int MAX_DEPTH = 64;
+
+    void skipSpace() {
+        while (p_ < end_ && (*p_ == ' ' || *p_ == '\t' || *p_ == '\n' || *p_ == '\r')) p_++;
+    }
+    bool literal(std::string_view word) {
+        if (static_cast<size_t>(end_ - p_) < word.size()
+            || std::string_view(p_, word.size()) != word) {
+            return false;
+        }
+        p_ += word.size();
+        return true;
+    }
+
+    bool value(JsonValue& out, int depth) {
+        skipSpace();
+        if (p_ == end_ || depth > MAX_DEPTH) return false;
+        switch (*p_) {
+        case '{': {
+            out.kind = JsonValue::Kind::Object;
+            p_++;
+            skipSpace();
+            if (p_ < end_ && *p_ == '}') {
+                p_++;
+                return true;
+            }
+            for (;;) {
+                std::string key;
+                skipSpace();
+                if (!string(key)) return false;
+                skipSpace();
+                if (p_ == end_ || *p_++ != ':') return false;
+                JsonValue member;
+                if (!value(member, depth + 1)) return false;
+                out.members.emplace_back(std::move(key), std::move(member));
+                skipSpace();
+                if (p_ == end_) return false;
+                char c = *p_++;
+                if (c == '}') return true;
+                if (c != ',') return false;
+            }
+        }
+        case '[': {
+            out.kind = JsonValue::Kind::Array;
+            p_++;
+            skipSpace();
+            if (p_ < end_ && *p_ == ']') {
+                p_++;
+                return true;
+            }
+            for (;;) {
+                JsonValue item;
+                if (!value(item, depth + 1)) return false;
+                out.items.push_back(std::move(item));
+                skipSpace();
+                if (p_ == end_) return false;
+                char c = *p_++;
+                if (c == ']') return true;
+                if (c != ',') return false;
+            }
+        }
+        case '"':
+            out.kind = JsonValue::Kind::String;
+            return string(out.text);
+        case 't':
+        case 'f':
+            out.kind = JsonValue::Kind::Bool;
+            out.flag = *p_ == 't';
+            return literal(out.flag ? "true" : "false");
+        case 'n':
+            return literal("null");
+        default: {
+            // strtod needs a terminated copy; numbers are short
+            const char* start = p_;
+            while (p_ < end_
+                   && (std::isdigit(static_cast<unsigned char>(*p_)) || *p_ == '-' || *p_ == '+'
+                       || *p_ == '.' || *p_ == 'e' || *p_ == 'E')) {
+                p_++;
+            }
+            std::string number(start, p_);
+            char* parsed = nullptr;
+            out.kind = JsonValue::Kind::Number;
+            out.number = std::strtod(number.c_str(), &parsed);
+            return !number.empty() && parsed == number.c_str() + number.size();
+        }
+        }
+    }
+
+    bool string(std::string& out) {
+        if (p_ == end_ || *p_++ != '"') return false;
+        while (p_ < end_) {
+            char c = *p_++;
+            if (c == '"') return true;
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (p_ == end_) return false;
+            switch (char escape = *p_++) {
+            case '"': case '\\': case '/': out += escape; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': {
+                uint32_t code = 0;
+                if (!hex4(code)) return false;
+                if (code >= 0xD800 && code < 0xDC00) {
+                    uint32_t low = 0;
+                    if (!literal("\\u") || !hex4(low) || low < 0xDC00 || low >= 0xE000) {
+                        return false;
+                    }
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                }
+                appendUtf8(out, code);
+                break;
+            }
+            default:
+                return false;
+            }
+        }
+        return false;
+    }
+    bool hex4(uint32_t& code) {
+        if (end_ - p_ < 4) return false;
+        auto [ptr, ec] = std::from_chars(p_, p_ + 4, code, 16);
+        if (ec != std::errc() || ptr != p_ + 4) return false;
+        p_ += 4;
+        return true;
+    }
+    static void appendUtf8(std::string& out, uint32_t code) {
+        if (code < 0x80) {
+            out += static_cast<char>(code);
+        } else if (code < 0x800) {
+            out += static_cast<char>(0xC0 | (code >> 6));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else if (code < 0x10000) {
+            out += static_cast<char>(0xE0 | (code >> 12));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (code >> 18));
+            out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+    }
+
+    const char* p_;
+    const char* end_;
+};
+
+/**
+ * Wall time per (phase, module) of one run, in nanoseconds
+ */
+using CompareRun = std::map<std::pair<std::string, std::string>, double>;
+
+/**
+ * Add the runs of a Google Benchmark JSON report (wasm-mini-bench
+ * --benchmark_out). Each repetition is one run. Benchmark names are
+ * "Phase/module", so "Validate/app.wasm" compares with the validate phase
+ * of app.wasm; aggregate and failed entries are skipped.
+ *
+ * @param report Parsed report
+ * @param runs   Runs of this side (appended to)
+ */
+void addBenchmarkRuns(const JsonValue& report, std::vector<CompareRun>& runs) {
+    size_t first = runs.size();
+    for (const JsonValue& entry : report.find("benchmarks")->items) {
+        const JsonValue* failed = entry.find("error_occurred");
+        if (entry.textOf("run_type") == "aggregate" || (failed && failed->flag)) {
+            continue;
+        }
+        std::string_view name = entry.textOf("run_name");
+        if (name.empty()) name = entry.textOf("name");
+        size_t slash = name.find('/');
+        std::string phase(name.substr(0, slash));
+        std::string module(slash == std::string_view::npos ? "-" : name.substr(slash + 1));
+        std::string_view unit = entry.textOf("time_unit");
+        double scale = unit == "s" ? 1e9 : unit == "ms" ? 1e6 : unit == "us" ? 1e3 : 1.0;
+        size_t repetition = static_cast<size_t>(entry.numberOf("repetition_index", 0.0));
+        if (runs.size() <= first + repetition) runs.resize(first + repetition + 1);
+        runs[first + repetition][{std::move(phase), std::move(module)}] =
+            entry.numberOf("real_time", 0.0) * scale;
+    }
+}
+
+/**
+ * Load one compare input file: a benchmark JSON report, or --profile
+ * NDJSON (one run per file; the "phase" records of a module are summed per
+ * phase, other record types are ignored)
+ *
+ * @param path  Input file
+ * @param runs  Runs of this side (appended to)
+ * @param error Receives a message on failure
+ * @return true on success
+ */
+bool loadCompareFile(const std::string& path, std::vector<CompareRun>& runs, std::string& error) {
+    std::ifstream in(path, std::ios::binary);
+    std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (!in && !in.eof()) {
+        error = "Cannot read compare input: " + path;
+        return false;
+    }
+    JsonParser document(text);
+    JsonValue report;
+    if (document.parse(report) && document.atEnd()) {
+        const JsonValue* benchmarks = report.find("benchmarks");
+        if (benchmarks && benchmarks->kind == JsonValue::Kind::Array) {
+            addBenchmarkRuns(report, runs);
+            return true;
+        }
+    }
+
+    CompareRun run;
+    std::istringstream lines(text);
+    std::string line;
+    for (size_t lineNo = 1; std::getline(lines, line); lineNo++) {
+        JsonParser parser(line);
+        JsonValue record;
+        if (parser.atEnd()) continue;
+        if (!parser.parse(record) || !parser.atEnd() || record.kind != JsonValue::Kind::Object) {
+            error = path + ":" + std::to_string(lineNo)
+                  + ": not a --profile record or benchmark report";
+            return false;
+        }
+        if (record.textOf("type") == "phase") {
+            std::pair<std::string, std::string> key{std::string(record.textOf("phase")),
+                                                    std::string(record.textOf("file"))};
+            run[key] += record.numberOf("wall_ns", 0.0);
+        }
+    }
+    if (run.empty()) {
+        error = "No phase records in compare input: " + path;
+        return false;
+    }
+    runs.push_back(std::move(run));
+    return true;
+}
+
+/**
+ * Load one side of a comparison: a file, or a directory whose .json,
+ * .jsonl and .ndjson files are one run (or benchmark report) each
+ *
+ * @param path  File or directory
+ * @param runs  Receives the runs
+ * @param error Receives a message on failure
+ * @return true on success
+ */
+bool loadCompareSide(const std::string& path, std::vector<CompareRun>& runs, std::string& error) {
+    std::error_code ec;
+    if (!fs::is_directory(path, ec)) {
+        return loadCompareFile(path, runs, error);
+    }
+    std::vector<std::string> files;
+    for (const fs::directory_entry& entry : fs::directory_iterator(path, ec)) {
+        std::string extension = entry.path().extension().string();
+        if (entry.is_regular_file(ec)
+            && (extension == ".json" || extension == ".jsonl" || extension == ".ndjson")) {
+            files.push_back(entry.path().string());
+        }
+    }
+    std::sort(files.begin(), files.end());
+    if (files.empty()) {
+        error = "No .json, .jsonl or .ndjson files in: " + path;
+        return false;
+    }
+    for (const std::string& file : files) {
+        if (!loadCompareFile(file, runs, error)) return false;
+    }
+    return true;
+}
+
+/**
+ * One compared (phase, module) pair; module "*" is the phase summed over
+ * the modules both sides have
+ */
+struct CompareRow {
+    std::string phase;
+    std::string module;
+    size_t baselineRuns = 0;
+    size_t candidateRuns = 0;
+    double baseline = 0.0;   // Mean wall time, ns
+    double candidate = 0.0;
+    double delta = 0.0;      // candidate / baseline - 1
+    double low = 0.0;        // Bootstrap interval of delta
+    double high = 0.0;
+    bool hasInterval = false;
+    bool regression = false;
+    bool improvement = false;
+};
+
+/**
+ * Mean of a sample
+ */
+double meanOf(const std::vector<double>& values) {
+    return std::accumulate(values.begin(), values.end(), 0.0) / static_cast<double>(values.size());
+}
+
+/**
+ * Compare two samples: relative change of the mean, with a percentile
+ * bootstrap interval when both sides have at least two runs. A row is a
+ * regression (or improvement) when the change exceeds the threshold and
+ * the interval excludes zero.
+ *
+ * @param baseline  Baseline sample
+ * @param candidate Candidate sample
+ * @param rng       Resampling generator
+ * @param row       Receives the statistics
+ */
+void compareSamples(const std::vector<double>& baseline, const std::vector<double>& candidate,
+                    std::mt19937_64& rng, CompareRow& row) {
+    row.baselineRuns = baseline.size();
+    row.candidateRuns = candidate.size();
+    row.baseline = meanOf(baseline);
+    row.candidate = meanOf(candidate);
+    row.delta = row.candidate / row.baseline - 1.0;
+    row.low = row.high = row.delta;
+    row.hasInterval = baseline.size() >= 2 && candidate.size() >= 2;
+    if (row.hasInterval) {
+        std::vector<double> deltas(COMPARE_RESAMPLES);
+        std::uniform_int_distribution<size_t> pickBaseline(0, baseline.size() - 1);
+        std::uniform_int_distribution<size_t> pickCandidate(0, candidate.size() - 1);
+        for (double& delta : deltas) {
+            double baseSum = 0.0;
+            double candSum = 0.0;
+            for (size_t i = 0; i < baseline.size(); i++) baseSum += baseline[pickBaseline(rng)];
+            for (size_t i = 0; i < candidate.size(); i++) candSum += candidate[pickCandidate(rng)];
+            double base = baseSum / static_cast<double>(baseline.size());
+            double cand = candSum / static_cast<double>(candidate.size());
+            delta = base > 0.0 ? cand / base - 1.0 : 0.0;
+        }
+        std::sort(deltas.begin(), deltas.end());
+        double tail = (1.0 - COMPARE_CONFIDENCE) / 2.0;
+        double last = static_cast<double>(deltas.size() - 1);
+        row.low = deltas[static_cast<size_t>(tail * last)];
+        row.high = deltas[static_cast<size_t>((1.0 - tail) * last)];
+    }
+    double threshold = g_threshold / 100.0;
+    row.regression = row.delta > threshold && row.low > 0.0;
+    row.improvement = row.delta < -threshold && row.high < 0.0;
+}
+
+/**
+ * Print one comparison row
+ *
+ * @param row Compared pair
+ */
+void printCompareRow(const CompareRow& row) {
+    char line[512];
+    char interval[48] = "(n/a)";
+    if (row.hasInterval) {
+        std::snprintf(interval, sizeof(interval), "[%+.1f%%, %+.1f%%]", row.low * 100.0,
+                      row.high * 100.0);
+    }
+    std::snprintf(line, sizeof(line), "  %-16s %-28s %10s -> %-10s %+7.1f%% %-18s %s",
+                  row.phase.c_str(), row.module.c_str(), formatDurationNs(row.baseline).c_str(),
+                  formatDurationNs(row.candidate).c_str(), row.delta * 100.0, interval,
+                  row.regression ? "REGRESSION" : row.improvement ? "improved" : "");
+    std::string_view text(line);
+    std::cout << text.substr(0, text.find_last_not_of(' ') + 1) << "\n";
+}
+
+/**
+ * Compare sub-command: per-module and per-phase wall time deltas between
+ * two sets of --profile or wasm-mini-bench results, with bootstrap
+ * confidence intervals over the repeated runs
+ *
+ * @param baselinePath  Baseline file or directory
+ * @param candidatePath Candidate file or directory
+ * @return EXIT_OK, EXIT_RUNTIME_ERROR if any row regressed past
+ *         --threshold, or EXIT_CLI_ERROR for unreadable inputs
+ */
+int cmdCompare(const std::string& baselinePath, const std::string& candidatePath) {
+    std::vector<CompareRun> baselineRuns;
+    std::vector<CompareRun> candidateRuns;
+    std::string error;
+    if (!loadCompareSide(baselinePath, baselineRuns, error)
+        || !loadCompareSide(candidatePath, candidateRuns, error)) {
+        printCliError(error);
+        return EXIT_CLI_ERROR;
+    }
+
+    // Samples per pair, over the runs that measured it
+    using Samples = std::map<std::pair<std::string, std::string>, std::vector<double>>;
+    auto collect = [](const std::vector<CompareRun>& runs) {
+        Samples samples;
+        for (const CompareRun& run : runs) {
+            for (const auto& [key, ns] : run) samples[key].push_back(ns);
+        }
+        return samples;
+    };
+    Samples baseline = collect(baselineRuns);
+    Samples candidate = collect(candidateRuns);
+
+    // Phase totals per run, summed over the modules both sides measured
+    auto phaseTotals = [&baseline, &candidate](const std::vector<CompareRun>& runs) {
+        std::map<std::string, std::vector<double>> totals;
+        for (const CompareRun& run : runs) {
+            std::map<std::string, double> sums;
+            for (const auto& [key, ns] : run) {
+                if (baseline.count(key) && candidate.count(key)) sums[key.first] += ns;
+            }
+            for (const auto& [phase, ns] : sums) totals[phase].push_back(ns);
+        }
+        return totals;
+    };
+    std::map<std::string, std::vector<double>> baselineTotals = phaseTotals(baselineRuns);
+    std::map<std::string, std::vector<double>> candidateTotals = phaseTotals(candidateRuns);
+
+    std::mt19937_64 rng(COMPARE_SEED);
+    std::vector<CompareRow> phaseRows;
+    std::vector<CompareRow> moduleRows;
+    size_t unmatched = 0;
+    for (const auto& [phase, values] : baselineTotals) {
+        auto other = candidateTotals.find(phase);
+        if (other == candidateTotals.end() || meanOf(values) <= 0.0) continue;
+        CompareRow& row = phaseRows.emplace_back();
+        row.phase = phase;
+        row.module = "*";
+        compareSamples(values, other->second, rng, row);
+    }
+    for (const auto& [key, values] : baseline) {
+        auto other = candidate.find(key);
+        if (other == candidate.end()) {
+            unmatched++;
+            continue;
+        }
+        if (meanOf(values) <= 0.0) continue;
+        CompareRow& row = moduleRows.emplace_back();
+        row.phase = key.first;
+        row.module = key.second;
+        compareSamples(values, other->second, rng, row);
+    }
+    unmatched += std::count_if(candidate.begin(), candidate.end(), [&baseline](const auto& entry) {
+        return baseline.count(entry.first) == 0;
+    });
+
+    size_t regressions = 0;
+    std::cout << "[COMPARE]\n"
+              << "Baseline : " << baselinePath << " (" << baselineRuns.size() << " run(s))\n"
+              << "Candidate: " << candidatePath << " (" << candidateRuns.size() << " run(s))\n";
+    char threshold[32];
+    std::snprintf(threshold, sizeof(threshold), "%.1f%%", g_threshold);
+    std::cout << "Threshold: " << threshold << " at "
+              << static_cast<int>(COMPARE_CONFIDENCE * 100) << "% confidence\n";
+    for (const CompareRow& row : phaseRows) {
+        printCompareRow(row);
+        regressions += row.regression;
+    }
+    for (const CompareRow& row : moduleRows) {
+        // Modules are listed when they changed significantly (all with --verbose)
+        if (row.regression || row.improvement || g_verbose) printCompareRow(row);
+        regressions += row.regression;
+    }
+    if (unmatched > 0) {
+        std::cout << "Skipped  : " << unmatched
+                  << " phase/module pair(s) measured on one side only\n";
+    }
+    if (regressions > 0) {
+        std::cout << "Status   : FAILED (" << regressions << " regression(s))\n";
+        return EXIT_RUNTIME_ERROR;
+    }
+    std::cout << "Status   : PASS\n";
     return EXIT_OK;
-    // RAII: vmCtx automatically cleaned up
+}
+
+// ============================================================================
+// Result Log Report - Aggregates over --format bin result logs
+// ============================================================================
+
+constexpr size_t REPORT_BUCKETS = 64;  // log2(wall ns) histogram buckets
+
+/**
+ * Totals gathered over every block of one or more result logs
+ */
+struct ReportTotals {
+    size_t records = 0;
+    size_t blocks = 0;
+    uint64_t wallNs = 0;
+    uint64_t maxWallNs = 0;
+    size_t cached = 0;
+    std::array<size_t, REPORT_BUCKETS> histogram{};
+    std::array<size_t, 256> exitCodes{};
+    std::map<std::string, size_t> statuses;                      // "COMMAND STATUS" -> records
+    std::map<std::pair<uint32_t, uint32_t>, size_t> errors;      // (ErrorKind, code) -> records
+    std::map<std::string, std::pair<uint64_t, size_t>> phases;   // Phase -> (wall ns, records)
+    std::vector<std::tuple<uint64_t, std::string, std::string>> slowest;  // Min-heap by wall ns
+};
+
+/**
+ * Column of a mapped result log block
+ *
+ * @param block  Block bytes (8-byte aligned)
+ * @param offset Column offset from ResultLogLayout
+ * @return Column values
+ */
+template <typename T>
+const T* resultLogColumn(const uint8_t* block, size_t offset) {
+    return reinterpret_cast<const T*>(block + offset);
+}
+
+/**
+ * Fold one result log block into the totals. The per-record loops run
+ * over contiguous columns without branches or calls, so the compiler
+ * vectorizes them; only the slowest-module heap looks at single records,
+ * and only those slower than the current top-N.
+ *
+ * @param block  Block bytes (header included, 8-byte aligned)
+ * @param header Block header
+ * @param layout Column offsets of the block
+ * @param totals Totals to update
+ * @return false if a symbol id or path points outside the block, or the
+ *         block has more symbols than its records can use
+ */
+bool foldReportBlock(const uint8_t* block, const ResultLogBlockHeader& header,
+                     const ResultLogLayout& layout, ReportTotals& totals) {
+    const size_t records = header.records;
+    // Each record interns its command, status and phase, and each phase column its name
+    if (header.symbols > 3 * records + header.phases) return false;
+    const uint64_t* wallNs = resultLogColumn<uint64_t>(block, layout.wallNs);
+    const uint32_t* symbolOffset = resultLogColumn<uint32_t>(block, layout.symbolOffset);
+    const char* symbolText = reinterpret_cast<const char*>(block + layout.symbolText);
+    for (uint32_t i = 0; i < header.symbols; i++) {
+        if (symbolOffset[i] > symbolOffset[i + 1] || symbolOffset[i + 1] > header.symbolBytes) {
+            return false;
+        }
+    }
+    auto symbol = [&](uint16_t id) {
+        return std::string_view(symbolText + symbolOffset[id],
+                                symbolOffset[id + 1] - symbolOffset[id]);
+    };
+
+    uint64_t wallSum = 0;
+    uint64_t wallMax = 0;
+    for (size_t i = 0; i < records; i++) {
+        wallSum += wallNs[i];
+        wallMax = std::max(wallMax, wallNs[i]);
+    }
+    totals.wallNs += wallSum;
+    totals.maxWallNs = std::max(totals.maxWallNs, wallMax);
+    for (size_t i = 0; i < records; i++) {
+        totals.histogram[floorLog2(wallNs[i] | 1)]++;
+    }
+
+    const uint8_t* cached = resultLogColumn<uint8_t>(block, layout.cached);
+    const uint8_t* exitCode = resultLogColumn<uint8_t>(block, layout.exitCode);
+    const uint8_t* errorKind = resultLogColumn<uint8_t>(block, layout.errorKind);
+    size_t cachedCount = 0;
+    size_t failedCount = 0;
+    for (size_t i = 0; i < records; i++) {
+        cachedCount += cached[i];
+        failedCount += errorKind[i] != 0;
+    }
+    totals.cached += cachedCount;
+    for (size_t i = 0; i < records; i++) {
+        totals.exitCodes[exitCode[i]]++;
+    }
+
+    // Statuses: count the (command, status) symbol pairs that occur, then
+    // name them once. Batches mostly repeat one pair, so runs of equal pairs
+    // are counted before touching the map.
+    const uint16_t* command = resultLogColumn<uint16_t>(block, layout.command);
+    const uint16_t* status = resultLogColumn<uint16_t>(block, layout.status);
+    uint16_t maxSymbol = 0;
+    for (size_t i = 0; i < records; i++) {
+        maxSymbol = std::max({maxSymbol, command[i], status[i]});
+    }
+    if (records > 0 && maxSymbol >= header.symbols) return false;
+    std::map<uint32_t, size_t> pairs;  // command << 16 | status -> records
+    for (size_t i = 0; i < records;) {
+        uint32_t pair = uint32_t{command[i]} << 16 | status[i];
+        size_t run = i + 1;
+        while (run < records && (uint32_t{command[run]} << 16 | status[run]) == pair) run++;
+        pairs[pair] += run - i;
+        i = run;
+    }
+    for (const auto& [pair, count] : pairs) {
+        std::string key(symbol(static_cast<uint16_t>(pair >> 16)));
+        key += ' ';
+        key += symbol(static_cast<uint16_t>(pair & 0xFFFF));
+        totals.statuses[key] += count;
+    }
+
+    // Failures are rare, so they are gathered record by record
+    const uint32_t* errorCode = resultLogColumn<uint32_t>(block, layout.errorCode);
+    for (size_t i = 0; failedCount > 0 && i < records; i++) {
+        if (errorKind[i] != 0) {
+            totals.errors[{errorKind[i], errorCode[i]}]++;
+            failedCount--;
+        }
+    }
+
+    const uint16_t* phaseSymbol = resultLogColumn<uint16_t>(block, layout.phaseSymbol);
+    for (uint32_t p = 0; p < header.phases; p++) {
+        if (phaseSymbol[p] >= header.symbols) return false;
+        const uint64_t* phaseNs =
+            resultLogColumn<uint64_t>(block, layout.phaseNs + 8 * records * p);
+        uint64_t sum = 0;
+        size_t ran = 0;
+        for (size_t i = 0; i < records; i++) {
+            sum += phaseNs[i];
+            ran += phaseNs[i] != 0;
+        }
+        auto& [phaseWall, phaseRecords] = totals.phases[std::string(symbol(phaseSymbol[p]))];
+        phaseWall += sum;
+        phaseRecords += ran;
+    }
+
+    const uint32_t* pathOffset = resultLogColumn<uint32_t>(block, layout.pathOffset);
+    const uint32_t* pathLength = resultLogColumn<uint32_t>(block, layout.pathLength);
+    const char* pathText = reinterpret_cast<const char*>(block + layout.pathText);
+    auto slower = [](const auto& a, const auto& b) { return std::get<0>(a) > std::get<0>(b); };
+    for (size_t i = 0; i < records && g_reportTop > 0; i++) {
+        if (totals.slowest.size() == g_reportTop
+            && wallNs[i] <= std::get<0>(totals.slowest.front())) {
+            continue;
+        }
+        if (uint64_t{pathOffset[i]} + pathLength[i] > header.pathBytes) return false;
+        if (totals.slowest.size() == g_reportTop) {
+            std::pop_heap(totals.slowest.begin(), totals.slowest.end(), slower);
+            totals.slowest.pop_back();
+        }
+        totals.slowest.emplace_back(wallNs[i], std::string(symbol(status[i])),
+                                    std::string(pathText + pathOffset[i], pathLength[i]));
+        std::push_heap(totals.slowest.begin(), totals.slowest.end(), slower);
+    }
+    totals.records += records;
+    totals.blocks++;
+    return true;
+}
+
+/**
+ * Fold every block of a result log into the totals
+ *
+ * @param path   Result log written with --format bin
+ * @param totals Totals to update
+ * @param error  Receives the reason the log could not be read
+ * @return true on success
+ */
+bool foldReportLog(const std::string& path, ReportTotals& totals, std::string& error) {
+    MappedModule log;  // A plain read-only mapping; the columns are read in place
+    if (!log.open(path)) {
+        error = "Cannot read result log '" + path + "'.";
+        return false;
+    }
+    ResultLogHeader header{};
+    if (log.size() < sizeof(header)) {
+        error = "'" + path + "' is not a wasm-mini result log.";
+        return false;
+    }
+    std::memcpy(&header, log.data(), sizeof(header));
+    if (header.magic != RESULT_LOG_MAGIC || header.version != RESULT_LOG_VERSION) {
+        error = "'" + path + "' is not a version " + std::to_string(RESULT_LOG_VERSION)
+              + " wasm-mini result log.";
+        return false;
+    }
+    size_t offset = sizeof(header);
+    while (offset < log.size()) {
+        ResultLogBlockHeader block{};
+        if (log.size() - offset < sizeof(block)) {
+            error = "Result log '" + path + "' is truncated.";
+            return false;
+        }
+        std::memcpy(&block, log.data() + offset, sizeof(block));
+        ResultLogLayout layout = resultLogLayout(block);
+        if (block.records > RESULT_LOG_BLOCK_RECORDS || block.symbols > UINT16_MAX
+            || block.size != layout.size || layout.size > log.size() - offset) {
+            error = "Result log '" + path + "' has a malformed block at offset "
+                  + std::to_string(offset) + ".";
+            return false;
+        }
+        // Blocks start 8-byte aligned in the file, and so in the page-aligned mapping
+        if (!foldReportBlock(log.data() + offset, block, layout, totals)) {
+            error = "Result log '" + path + "' has a corrupt block at offset "
+                  + std::to_string(offset) + ".";
+            return false;
+        }
+        offset += layout.size;
+    }
+    return true;
+}
+
+/**
+ * Report sub-command: counts by status and exit code, failure counts by
+ * error code, a wall time histogram, per-phase totals and the slowest
+ * modules of one or more --format bin result logs
+ *
+ * @param paths Result logs
+ * @return EXIT_OK, or EXIT_CLI_ERROR for unreadable logs
+ */
+int cmdReport(const std::vector<std::string>& paths) {
+    auto start = std::chrono::steady_clock::now();
+    ReportTotals totals;
+    std::string error;
+    for (const std::string& path : paths) {
+        if (!foldReportLog(path, totals, error)) {
+            printCliError(error);
+            return EXIT_CLI_ERROR;
+        }
+    }
+    auto aggregated = std::chrono::steady_clock::now() - start;
+    printVerbose("Aggregated ", totals.records, " record(s) in ",
+                 std::chrono::duration_cast<std::chrono::microseconds>(aggregated).count(), " us");
+
+    char line[256];
+    std::cout << "[REPORT]\n"
+              << "Logs     : " << paths.size() << " (" << totals.blocks << " block(s))\n"
+              << "Records  : " << totals.records << " (" << totals.cached << " cached)\n";
+    if (totals.records == 0) {
+        return EXIT_OK;
+    }
+    std::cout << "Wall     : total " << formatDurationNs(static_cast<double>(totals.wallNs))
+              << ", mean "
+              << formatDurationNs(static_cast<double>(totals.wallNs)
+                                  / static_cast<double>(totals.records))
+              << ", max " << formatDurationNs(static_cast<double>(totals.maxWallNs)) << "\n";
+    std::cout << "Status   :\n";
+    for (const auto& [status, count] : totals.statuses) {
+        std::snprintf(line, sizeof(line), "  %-28s %10zu\n", status.c_str(), count);
+        std::cout << line;
+    }
+    std::cout << "Exit     :";
+    for (size_t code = 0; code < totals.exitCodes.size(); code++) {
+        if (totals.exitCodes[code] > 0) std::cout << " " << code << "=" << totals.exitCodes[code];
+    }
+    std::cout << "\n";
+    if (!totals.errors.empty()) {
+        std::cout << "Errors   :\n";
+        static constexpr const char* KIND_NAMES[] = {"none", "wasmedge", "context", "input",
+                                                     "scan"};
+        for (const auto& [key, count] : totals.errors) {
+            auto [kind, code] = key;
+            std::string name = kind < std::size(KIND_NAMES) ? KIND_NAMES[kind] : "unknown";
+            if (kind == static_cast<uint32_t>(ErrorKind::WasmEdge)) {
+                const char* message = WasmEdge_ResultGetMessage(
+                    WasmEdge_ResultGen(WasmEdge_ErrCategory_WASM, code));
+                name += " " + std::to_string(code) + " ("
+                      + (message ? message : "Unknown error") + ")";
+            }
+            std::snprintf(line, sizeof(line), "  %-48s %10zu\n", name.c_str(), count);
+            std::cout << line;
+        }
+    }
+
+    std::cout << "Histogram:\n";
+    size_t peak = *std::max_element(totals.histogram.begin(), totals.histogram.end());
+    for (size_t bucket = 0; bucket < REPORT_BUCKETS; bucket++) {
+        size_t count = totals.histogram[bucket];
+        if (count == 0) continue;
+        std::string bar(std::max<size_t>(1, count * 40 / peak), '#');
+        double low = bucket ? std::ldexp(1.0, static_cast<int>(bucket)) : 0.0;
+        double high = std::ldexp(1.0, static_cast<int>(bucket) + 1);
+        std::snprintf(line, sizeof(line), "  %10s .. %-10s %10zu %s\n",
+                      formatDurationNs(low).c_str(), formatDurationNs(high).c_str(), count,
+                      bar.c_str());
+        std::cout << line;
+    }
+    if (!totals.phases.empty()) {
+        std::cout << "Phases   :\n";
+        for (const auto& [phase, sums] : totals.phases) {
+            auto [wallNs, ran] = sums;
+            double mean = ran ? static_cast<double>(wallNs) / static_cast<double>(ran) : 0.0;
+            std::snprintf(line, sizeof(line), "  %-16s %10zu  total %-10s mean %s\n",
+                          phase.c_str(), ran, formatDurationNs(static_cast<double>(wallNs)).c_str(),
+                          formatDurationNs(mean).c_str());
+            std::cout << line;
+        }
+    }
+    if (!totals.slowest.empty()) {
+        std::sort(totals.slowest.begin(), totals.slowest.end(),
+                  [](const auto& a, const auto& b) { return std::get<0>(a) > std::get<0>(b); });
+        std::cout << "Slowest  :\n";
+        for (const auto& [wallNs, status, path] : totals.slowest) {
+            std::snprintf(line, sizeof(line), "  %10s  %-8s ",
+                          formatDurationNs(static_cast<double>(wallNs)).c_str(), status.c_str());
+            std::cout << line << path << "\n";
+        }
+    }
+    return EXIT_OK;
+}
+
+// ============================================================================
+// Option Parsing
+// ============================================================================
+
+/**
+ * Outcome of parsing one command-line option
+ */
+enum class OptionStatus {
+    Consumed,   // Option recognized and applied; argIndex advanced
+    NotOption,  // Argument is not a known option (command or positional)
+    Exit        // Stop with the exit code stored by parseOption()
+};
+
+/**
+ * Parse one option at argv[argIndex].
+ * Options are accepted both before the command and between the command and
+ * its first positional argument.
+ * 
+ * @param argc     Argument count
+ * @param argv     Argument vector
+ * @param argIndex Index of the argument to parse; advanced past the option
+ * @param exitCode Receives the exit code when OptionStatus::Exit is returned
+ * @return Parse outcome
+ */
+OptionStatus parseOption(int argc, char* argv[], int& argIndex, int& exitCode) {
+    std::string_view arg = argv[argIndex];
+    const char* value = argIndex + 1 < argc ? argv[argIndex + 1] : nullptr;
+
+    if (arg == "-h" || arg == "--help") {
+        printUsage();
+        exitCode = EXIT_OK;
+        return OptionStatus::Exit;
+    }
+
+    if (arg == "-v" || arg == "--version") {
+        printVersion();
+        exitCode = EXIT_OK;
+        return OptionStatus::Exit;
+    }
+
+    // Flags
+    bool* flag = nullptr;
+    bool flagValue = true;
+    if (arg == "--verbose") {
+        flag = &g_verbose;
+    } else if (arg == "--no-mmap") {
+        flag = &g_useMmap;
+        flagValue = false;
+    } else if (arg == "--no-aot-cache") {
+        flag = &g_useAotCache;
+        flagValue = false;
+    } else if (arg == "--verdict-cache") {
+        flag = &g_useVerdictCache;
+    } else if (arg == "--no-scan") {
+        flag = &g_scan;
+        flagValue = false;
+    } else if (arg == "--index") {
+        flag = &g_writeIndex;
+    } else if (arg == "--lazy") {
+        flag = &g_lazy;
+    } else if (arg == "--wasi") {
+        flag = &g_wasi;
+    } else if (arg == "--profile") {
+        flag = &g_profile;
+    } else if (arg == "--enable-instruction-count") {
+        flag = &g_countInstructions;
+    } else if (arg == "--enable-gas-measuring") {
+        flag = &g_measureCost;
+    } else if (arg == "--enable-time-measuring") {
+        flag = &g_measureTime;
+    } else if (arg == "--enable-all-statistics") {
+        g_countInstructions = g_measureCost = g_measureTime = true;
+        argIndex++;
+        return OptionStatus::Consumed;
+    }
+    if (flag) {
+        *flag = flagValue;
+        argIndex++;
+        return OptionStatus::Consumed;
+    }
+
+    // Options taking a count
+    size_t* count = nullptr;
+    if (arg == "-j" || arg == "--jobs") {
+        count = &g_jobs;
+        g_jobsSet = true;
+    } else if (arg == "--repeat") {
+        count = &g_repeat;
+    } else if (arg == "--warmup") {
+        count = &g_warmup;
+    } else if (arg == "--instances") {
+        count = &g_instances;
+    } else if (arg == "--threads") {
+        count = &g_runThreads;
+    } else if (arg == "--sample-rate") {
+        count = &g_sampleRate;
+    } else if (arg == "--top") {
+        count = &g_reportTop;
+    } else if (arg == "--prefetch") {
+        count = &g_prefetchReaders;
+    } else if (arg == "--functions") {
+        count = &g_generator.functions;
+    } else if (arg == "--body-ops") {
+        count = &g_generator.bodyOps;
+    } else if (arg == "--locals") {
+        count = &g_generator.locals;
+    } else if (arg == "--data-segments") {
+        count = &g_generator.dataSegments;
+    } else if (arg == "--imports") {
+        count = &g_generator.imports;
+    } else if (arg == "--exports") {
+        count = &g_generator.exports;
+    }
+    if (count) {
+        if (!value || !parseCount(value, *count)) {
+            printCliError(std::string("Option '") + std::string(arg)
+                          + "' requires a non-negative integer.");
+            exitCode = EXIT_CLI_ERROR;
+            return OptionStatus::Exit;
+        }
+        argIndex += 2;
+        return OptionStatus::Consumed;
+    }
+
+    // Byte size limits
+    uint64_t* size = nullptr;
+    if (arg == "--max-module-size") {
+        size = &g_maxModuleSize;
+    } else if (arg == "--max-section-size") {
+        size = &g_maxSectionSize;
+    } else if (arg == "--data-size") {
+        size = &g_generator.dataSize;
+    } else if (arg == "--prefetch-budget") {
+        size = &g_prefetchBudget;
+    } else if (arg == "--max-memory") {
+        size = &g_maxMemory;
+    }
+    if (size) {
+        if (!value || !parseByteSize(value, *size)) {
+            printCliError(std::string("Option '") + std::string(arg)
+                          + "' requires a byte size (e.g. 1048576, 512K, 16M).");
+            exitCode = EXIT_CLI_ERROR;
+            return OptionStatus::Exit;
+        }
+        argIndex += 2;
+        return OptionStatus::Consumed;
+    }
+
+    if (arg == "--threshold") {
+        if (!value || !parsePercent(value, g_threshold)) {
+            printCliError("Option '--threshold' requires a non-negative percentage "
+                          "(e.g. 5 or 2.5%).");
+            exitCode = EXIT_CLI_ERROR;
+            return OptionStatus::Exit;
+        }
+        argIndex += 2;
+        return OptionStatus::Consumed;
+    }
+
+    if (arg == "--lookup") {
+        if (!value || !parseFunctionList(value, g_lookupFunctions)) {
+            printCliError("Option '--lookup' requires function indices or ranges "
+                          "(e.g. 0,7,100-199).");
+            exitCode = EXIT_CLI_ERROR;
+            return OptionStatus::Exit;
+        }
+        argIndex += 2;
+        return OptionStatus::Consumed;
+    }
+
+    if (arg == "--lazy-functions") {
+        if (!value || !parseFunctionList(value, g_lazyFunctions)) {
+            printCliError("Option '--lazy-functions' requires function indices or ranges "
+                          "(e.g. 0,7,100-199).");
+            exitCode = EXIT_CLI_ERROR;
+            return OptionStatus::Exit;
+        }
+        g_lazyFunctionList = value;
+        g_lazy = true;
+        argIndex += 2;
+        return OptionStatus::Consumed;
+    }
+
+    if (arg == "--opt-level") {
+        if (!value || !parseOptLevel(value, g_optLevel)) {
+            printCliError("Option '--opt-level' requires one of O0, O1, O2, O3, Os, Oz.");
+            exitCode = EXIT_CLI_ERROR;
+            return OptionStatus::Exit;
+        }
+        argIndex += 2;
+        return OptionStatus::Consumed;
+    }
+
+    if (arg == "--enable" || arg == "--disable") {
+        uint64_t mask = 0;
+        if (!value || !parseProposalList(value, mask)) {
+            printCliError(std::string("Option '") + std::string(arg)
+                          + "' requires a comma-separated proposal list "
+                          + "(e.g. simd,threads or all).");
+            exitCode = EXIT_CLI_ERROR;
+            return OptionStatus::Exit;
+        }
+        // A later option overrides an earlier one for the same proposal
+        uint64_t& set = arg == "--enable" ? g_enabledProposals : g_disabledProposals;
+        uint64_t& clear = arg == "--enable" ? g_disabledProposals : g_enabledProposals;
+        set |= mask;
+        clear &= ~mask;
+        argIndex += 2;
+        return OptionStatus::Consumed;
+    }
+
+    if (arg == "--memory-page-limit") {
+        size_t pages = 0;
+        if (!value || !parseCount(value, pages) || pages == 0 || pages > 65536) {
+            printCliError("Option '--memory-page-limit' requires a page count from 1 to 65536.");
+            exitCode = EXIT_CLI_ERROR;
+            return OptionStatus::Exit;
+        }
+        g_maxMemoryPages = static_cast<uint32_t>(pages);
+        argIndex += 2;
+        return OptionStatus::Consumed;
+    }
+
+    if (arg == "--format") {
+        std::string_view format = value ? value : "";
+        if (format == "text") {
+            g_format = OutputFormat::Text;
+        } else if (format == "json") {
+            g_format = OutputFormat::Json;
+        } else if (format == "ndjson") {
+            g_format = OutputFormat::Ndjson;
+        } else if (format == "bin") {
+            g_format = OutputFormat::Bin;
+        } else {
+            printCliError("Option '--format' requires one of text, json, ndjson, bin.");
+            exitCode = EXIT_CLI_ERROR;
+            return OptionStatus::Exit;
+        }
+        argIndex += 2;
+        return OptionStatus::Consumed;
+    }
+
+    if (arg == "--invalid") {
+        if (!value || !parseInvalidKind(value, g_generator.invalid)) {
+            printCliError("Option '--invalid' requires one of magic, truncated, section-order, "
+                          "type-mismatch, bad-local.");
+            exitCode = EXIT_CLI_ERROR;
+            return OptionStatus::Exit;
+        }
+        argIndex += 2;
+        return OptionStatus::Consumed;
+    }
+
+    if (arg == "--gas-limit") {
+        size_t limit = 0;
+        if (!value || !parseCount(value, limit) || limit == 0) {
+            printCliError("Option '--gas-limit' requires a positive integer.");
+            exitCode = EXIT_CLI_ERROR;
+            return OptionStatus::Exit;
+        }
+        g_gasLimit = limit;
+        g_measureCost = true;  // The limit is enforced by cost measuring
+        argIndex += 2;
+        return OptionStatus::Consumed;
+    }
+
+    // Repeatable options; the WASI mappings imply --wasi
+    std::vector<std::string>* list = nullptr;
+    if (arg == "--dir") {
+        list = &g_wasiDirs;
+    } else if (arg == "--env") {
+        list = &g_wasiEnvs;
+    } else if (arg == "--wasi-arg") {
+        list = &g_wasiArgs;
+    } else if (arg == "--plugin") {
+        list = &g_plugins;
+    } else if (arg == "--link") {
+        list = &g_links;
+    }
+    if (list) {
+        if (!value) {
+            printCliError(std::string("Option '") + std::string(arg) + "' requires a value.");
+            exitCode = EXIT_CLI_ERROR;
+            return OptionStatus::Exit;
+        }
+        if (arg == "--env" && std::strchr(value, '=') == nullptr) {
+            printCliError("Option '--env' requires NAME=VALUE.");
+            exitCode = EXIT_CLI_ERROR;
+            return OptionStatus::Exit;
+        }
+        if (arg == "--link" && (value[0] == '=' || std::strchr(value, '=') == nullptr)) {
+            printCliError("Option '--link' requires NAME=PATH.");
+            exitCode = EXIT_CLI_ERROR;
+            return OptionStatus::Exit;
+        }
+        list->push_back(value);
+        g_wasi = g_wasi || (list != &g_plugins && list != &g_links);
+        argIndex += 2;
+        return OptionStatus::Consumed;
+    }
+
+    // Options taking a path
+    std::string* path = nullptr;
+    if (arg == "--cache-dir") {
+        path = &g_cacheDir;
+    } else if (arg == "-o" || arg == "--output") {
+        path = &g_compileOutput;
+    } else if (arg == "--sample-profile") {
+        path = &g_sampleProfile;
+    } else if (arg == "--snapshot") {
+        path = &g_snapshotOut;
+    } else if (arg == "--from-snapshot") {
+        path = &g_fromSnapshot;
+    } else if (arg == "--profile-out") {
+        path = &g_profileOut;
+        g_profile = true;
+    } else if (arg == "--cost-table") {
+        path = &g_costTablePath;
+        g_measureCost = true;
+    }
+    if (path) {
+        if (!value) {
+            printCliError(std::string("Option '") + std::string(arg) + "' requires a path.");
+            exitCode = EXIT_CLI_ERROR;
+            return OptionStatus::Exit;
+        }
+        *path = value;
+        argIndex += 2;
+        return OptionStatus::Consumed;
+    }
+
+    return OptionStatus::NotOption;
 }
 
 // ============================================================================
@@ -415,29 +11386,17 @@ int main(int argc, char* argv[]) {
 
     // Parse arguments - support options before command
     int argIndex = 1;
+    int exitCode = EXIT_OK;
     
     // Process options first
     while (argIndex < argc) {
-        std::string_view arg = argv[argIndex];
-        
-        if (arg == "-h" || arg == "--help") {
-            printUsage();
-            return EXIT_OK;
-        }
-        
-        if (arg == "-v" || arg == "--version") {
-            printVersion();
-            return EXIT_OK;
+        OptionStatus status = parseOption(argc, argv, argIndex, exitCode);
+        if (status == OptionStatus::Exit) {
+            return exitCode;
         }
-        
-        if (arg == "--verbose") {
-            g_verbose = true;
-            argIndex++;
-            continue;
+        if (status == OptionStatus::NotOption) {
+            break;  // Not an option, must be command
         }
-        
-        // Not an option, must be command
-        break;
     }
     
     // Check if we have a command
@@ -450,8 +11409,23 @@ int main(int argc, char* argv[]) {
     std::string_view command = argv[argIndex];
     argIndex++;
 
-    // Validate known commands
-    if (command != "parse" && command != "validate" && command != "instantiate") {
+    // Options may also follow the command, up to its first positional argument
+    while (argIndex < argc) {
+        OptionStatus status = parseOption(argc, argv, argIndex, exitCode);
+        if (status == OptionStatus::Exit) {
+            return exitCode;
+        }
+        if (status == OptionStatus::NotOption) {
+            break;
+        }
+    }
+
+    // Resolve the per-module handler for known commands
+    ModuleHandler handler = nullptr;
+    std::string_view commandLabel;
+    if (!resolveModuleCommand(command, handler, commandLabel)
+        && command != "run" && command != "serve" && command != "generate" && command != "watch"
+        && command != "compare" && command != "report") {
         printCliError(std::string("Unknown command '") + std::string(command) + "'.");
         printUsage();
         return EXIT_CLI_ERROR;
@@ -459,29 +11433,161 @@ int main(int argc, char* argv[]) {
 
     // Check for file argument
     if (argIndex >= argc) {
-        printCliError(std::string("Missing file argument for '") + std::string(command) + "' command.");
+        printCliError(std::string(command == "serve" ? "Missing socket path for '"
+                                                     : "Missing file argument for '")
+                      + std::string(command) + "' command.");
         printUsage();
         return EXIT_CLI_ERROR;
     }
 
-    std::string filename = argv[argIndex];
-    
-    // Validate file before processing
-    if (!validateFile(filename)) {
+    std::vector<std::string> args(argv + argIndex, argv + argc);
+
+    if (!g_costTablePath.empty()) {
+        std::string error;
+        if (!loadCostTable(g_costTablePath, g_costTable, error)) {
+            printCliError(error);
+            return EXIT_CLI_ERROR;
+        }
+    }
+    loadPlugins();
+    std::string linkError;
+    if (!loadLinkedLibraries(linkError)) {
+        printCliError(linkError);
         return EXIT_CLI_ERROR;
     }
-    
-    printVerbose("File validation passed.");
 
-    // Route to the appropriate sub-command handler
-    if (command == "parse") {
-        return cmdParse(filename);
-    } else if (command == "validate") {
-        return cmdValidate(filename);
-    } else if (command == "instantiate") {
-        return cmdInstantiate(filename);
+    if (!g_compileOutput.empty() && (command != "compile" || args.size() != 1)) {
+        printCliError("Option '--output' requires the 'compile' command and a single module.");
+        return EXIT_CLI_ERROR;
+    }
+    if (!g_snapshotOut.empty() && (command != "instantiate" || args.size() != 1)) {
+        printCliError("Option '--snapshot' requires the 'instantiate' command "
+                      "and a single module.");
+        return EXIT_CLI_ERROR;
+    }
+    if (!g_fromSnapshot.empty() && command != "instantiate" && command != "run") {
+        printCliError("Option '--from-snapshot' requires the 'instantiate' or 'run' command.");
+        return EXIT_CLI_ERROR;
+    }
+    if (!g_sampleProfile.empty()
+        && (command != "run" || g_instances > 0 || !g_fromSnapshot.empty())) {
+        printCliError("Option '--sample-profile' requires the 'run' command without '--instances' "
+                      "or '--from-snapshot'.");
+        return EXIT_CLI_ERROR;
+    }
+    if (g_sampleRate == 0) {
+        printCliError("Option '--sample-rate' must be at least 1.");
+        return EXIT_CLI_ERROR;
+    }
+    if (g_lazy && command != "validate" && command != "watch") {
+        printCliError("Option '--lazy' requires the 'validate' command.");
+        return EXIT_CLI_ERROR;
+    }
+    if (!g_snapshotOut.empty() && !g_fromSnapshot.empty()) {
+        printCliError("Options '--snapshot' and '--from-snapshot' cannot be combined.");
+        return EXIT_CLI_ERROR;
+    }
+    std::string snapshotError;
+    if (!loadSnapshot(snapshotError)) {
+        printCliError(snapshotError);
+        return EXIT_CLI_ERROR;
     }
 
-    // Should not reach here (defensive)
-    return EXIT_CLI_ERROR;
+    // serve takes a socket path; responses are always NDJSON
+    if (command == "serve") {
+        if (args.size() != 1) {
+            printCliError("The 'serve' command takes exactly one socket path.");
+            return EXIT_CLI_ERROR;
+        }
+        return cmdServe(args[0]);
+    }
+
+    // compare reads two result sets; no module is loaded
+    if (command == "compare") {
+        if (args.size() != 2 || g_format != OutputFormat::Text) {
+            printCliError(args.size() != 2
+                              ? "The 'compare' command takes a baseline and a candidate."
+                              : "Option '--format' is not supported by the 'compare' command.");
+            return EXIT_CLI_ERROR;
+        }
+        return cmdCompare(args[0], args[1]);
+    }
+
+    // report aggregates --format bin result logs; no module is loaded
+    if (command == "report") {
+        if (g_format != OutputFormat::Text) {
+            printCliError("Option '--format' is not supported by the 'report' command.");
+            return EXIT_CLI_ERROR;
+        }
+        return cmdReport(args);
+    }
+
+    // generate writes one module to a path (or '-' for stdout)
+    if (command == "generate") {
+        if (args.size() != 1 || g_format != OutputFormat::Text) {
+            printCliError(args.size() != 1
+                              ? "The 'generate' command takes exactly one output path."
+                              : "Option '--format' is not supported by the 'generate' command.");
+            return EXIT_CLI_ERROR;
+        }
+        return cmdGenerate(args[0]);
+    }
+
+    // watch takes an optional module command (default: validate), then inputs
+    if (command == "watch") {
+        if (g_format == OutputFormat::Json || g_format == OutputFormat::Bin) {
+            printCliError("The 'watch' command streams records; "
+                          "use '--format text' or '--format ndjson'.");
+            return EXIT_CLI_ERROR;
+        }
+        if (!resolveModuleCommand(args[0], handler, commandLabel)) {
+            resolveModuleCommand("validate", handler, commandLabel);
+        } else {
+            args.erase(args.begin());
+        }
+        if (args.empty()) {
+            printCliError("Missing file argument for 'watch' command.");
+            printUsage();
+            return EXIT_CLI_ERROR;
+        }
+        return cmdWatch(commandLabel, handler, args);
+    }
+
+    // run takes <file> <export> [args...] rather than module inputs
+    if (command == "run") {
+        if (g_format != OutputFormat::Text) {
+            printCliError("Option '--format' is not supported by the 'run' command.");
+            return EXIT_CLI_ERROR;
+        }
+        if (args.size() < 2) {
+            printCliError("Missing export name for 'run' command.");
+            printUsage();
+            return EXIT_CLI_ERROR;
+        }
+        if (g_instances == 0 ? g_runThreads != 1 : g_runThreads > g_instances) {
+            printCliError(g_instances == 0 ? "Option '--threads' requires '--instances'."
+                                           : "Option '--threads' cannot exceed '--instances'.");
+            return EXIT_CLI_ERROR;
+        }
+        return cmdRun(args[0], args[1], std::vector<std::string>(args.begin() + 2, args.end()));
+    }
+
+    // A single plain file keeps the original single-module behavior
+    std::error_code ec;
+    if (args.size() == 1 && args[0][0] != '@' && !fs::is_directory(args[0], ec)) {
+        g_bodyThreads = resolveJobs(SIZE_MAX);  // -j has no modules to spread over
+        return runSingle(commandLabel, handler, args[0]);
+    }
+
+    // Everything else (many paths, directories, @list files) is a batch run
+    std::vector<std::string> inputs;
+    if (!collectInputs(args, inputs)) {
+        return EXIT_CLI_ERROR;
+    }
+    if (inputs.empty()) {
+        printCliError("No .wasm modules found in the given inputs.");
+        return EXIT_CLI_ERROR;
+    }
+
+    return runBatch(commandLabel, handler, inputs);
 }